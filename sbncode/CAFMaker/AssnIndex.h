@@ -0,0 +1,103 @@
+//////////////////////////////////////////////////////////////////////
+// \file    AssnIndex.h
+// \brief   Per-event index over an art::Assns, for repeated FindManyP
+//          style lookups without rescanning the association
+//////////////////////////////////////////////////////////////////////
+
+#ifndef CAF_ASSNINDEX_H
+#define CAF_ASSNINDEX_H
+
+#include "canvas/Persistency/Common/Assns.h"
+#include "canvas/Persistency/Common/Ptr.h"
+#include "canvas/Persistency/Provenance/ProductID.h"
+
+#include <map>
+#include <vector>
+
+namespace caf
+{
+  /// Index over an art::Assns<L, R>, built with one pass over the
+  /// association. The right-hand Ptrs are stored grouped by the key of the
+  /// left-hand Ptr, with CSR-style offsets, in their order in the Assns.
+  /// A lookup is then O(1) plus the number of associated objects.
+  template<class L, class R>
+  class AssnIndex
+  {
+  public:
+    explicit AssnIndex(const art::Assns<L, R>& assns)
+    {
+      // count the associations of each left key
+      for(const auto& pair: assns){
+        Table& t = fTables[pair.first.id()];
+        const size_t key = pair.first.key();
+        if(t.offsets.size() < key+2) t.offsets.resize(key+2, 0);
+        ++t.offsets[key+1];
+      }
+
+      // turn the counts into offsets and fill in order
+      std::map<art::ProductID, std::vector<size_t>> cursors;
+      for(auto& it: fTables){
+        Table& t = it.second;
+        for(size_t i = 1; i < t.offsets.size(); ++i) t.offsets[i] += t.offsets[i-1];
+        t.rights.resize(t.offsets.back());
+        cursors[it.first].assign(t.offsets.begin(), t.offsets.end()-1);
+      }
+      for(const auto& pair: assns){
+        Table& t = fTables[pair.first.id()];
+        t.rights[cursors[pair.first.id()][pair.first.key()]++] = pair.second;
+      }
+    }
+
+    /// Fills \a ret with the objects associated to \a left
+    void Find(const art::Ptr<L>& left, std::vector<art::Ptr<R>>& ret) const
+    {
+      ret.clear();
+      if(left.isNull()) return;
+      const auto it = fTables.find(left.id());
+      if(it == fTables.end()) return;
+      const Table& t = it->second;
+      const size_t key = left.key();
+      if(key+1 >= t.offsets.size()) return;
+      ret.assign(t.rights.begin() + t.offsets[key],
+                 t.rights.begin() + t.offsets[key+1]);
+    }
+
+  protected:
+    struct Table
+    {
+      std::vector<size_t> offsets;       ///< rights[offsets[k], offsets[k+1]) belong to key k
+      std::vector<art::Ptr<R>> rights;
+    };
+
+    std::map<art::ProductID, Table> fTables; ///< one table per left-hand product
+  };
+
+  /// Drop-in for art::FindManyP<T> filled from an AssnIndex: same
+  /// isValid(), size() and at() interface for the list of Ptrs it was
+  /// made from
+  template<class T>
+  class IndexedFindManyP
+  {
+  public:
+    /// Invalid, as a FindManyP whose Assns was not found
+    IndexedFindManyP() : fValid(false) {}
+
+    template<class U>
+    IndexedFindManyP(const AssnIndex<U, T>& index,
+                     const std::vector<art::Ptr<U>>& from)
+      : fValid(true), fResults(from.size())
+    {
+      for(size_t i = 0; i < from.size(); ++i) index.Find(from[i], fResults[i]);
+    }
+
+    bool isValid() const {return fValid;}
+    size_t size() const {return fResults.size();}
+    const std::vector<art::Ptr<T>>& at(size_t i) const {return fResults.at(i);}
+
+  protected:
+    bool fValid;
+    std::vector<std::vector<art::Ptr<T>>> fResults;
+  };
+}
+
+#endif
@@ -0,0 +1,104 @@
+//////////////////////////////////////////////////////////////////////
+// \file    AsyncRecordWriter.cxx
+// \brief   Writes StandardRecords from a background thread
+//////////////////////////////////////////////////////////////////////
+
+#include "sbncode/CAFMaker/AsyncRecordWriter.h"
+
+#include <chrono>
+
+namespace caf
+{
+  //......................................................................
+  AsyncRecordWriter::AsyncRecordWriter(WriteFunc write, size_t max_queue)
+    : fWrite(write), fMaxQueue(max_queue > 0 ? max_queue : 1),
+      fStop(false), fBusy(false), fWaitSeconds(0)
+  {
+    fThread = std::thread(&AsyncRecordWriter::Run, this);
+  }
+
+  //......................................................................
+  AsyncRecordWriter::~AsyncRecordWriter()
+  {
+    try{
+      Flush();
+    }
+    catch(...){
+      // already reported to whoever called Push() or Flush()
+    }
+  }
+
+  //......................................................................
+  void AsyncRecordWriter::Push(std::unique_ptr<StandardRecord> rec)
+  {
+    std::unique_lock<std::mutex> lock(fMutex);
+
+    if(fQueue.size() >= fMaxQueue && !fError){
+      const auto start = std::chrono::steady_clock::now();
+      fNotFull.wait(lock, [this]{return fQueue.size() < fMaxQueue || fError;});
+      fWaitSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+    if(fError) std::rethrow_exception(fError);
+
+    fQueue.push_back(std::move(rec));
+    fNotEmpty.notify_one();
+  }
+
+  //......................................................................
+  void AsyncRecordWriter::Drain()
+  {
+    std::unique_lock<std::mutex> lock(fMutex);
+    fIdle.wait(lock, [this]{return (fQueue.empty() && !fBusy) || fError;});
+    if(fError) std::rethrow_exception(fError);
+  }
+
+  //......................................................................
+  void AsyncRecordWriter::Flush()
+  {
+    {
+      std::lock_guard<std::mutex> lock(fMutex);
+      fStop = true;
+    }
+    fNotEmpty.notify_one();
+    if(fThread.joinable()){
+      fThread.join();
+      if(fError) std::rethrow_exception(fError);
+    }
+  }
+
+  //......................................................................
+  void AsyncRecordWriter::Run()
+  {
+    while(true){
+      std::unique_ptr<StandardRecord> rec;
+      {
+        std::unique_lock<std::mutex> lock(fMutex);
+        fNotEmpty.wait(lock, [this]{return !fQueue.empty() || fStop;});
+        if(fQueue.empty()) return; // stopped and drained
+        rec = std::move(fQueue.front());
+        fQueue.pop_front();
+        fBusy = true;
+      }
+      fNotFull.notify_one();
+
+      try{
+        fWrite(*rec);
+      }
+      catch(...){
+        std::lock_guard<std::mutex> lock(fMutex);
+        fError = std::current_exception();
+        fQueue.clear();
+        fBusy = false;
+        fNotFull.notify_all();
+        fIdle.notify_all();
+        return;
+      }
+
+      {
+        std::lock_guard<std::mutex> lock(fMutex);
+        fBusy = false;
+        if(fQueue.empty()) fIdle.notify_all();
+      }
+    }
+  }
+}
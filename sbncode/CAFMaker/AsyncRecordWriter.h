@@ -0,0 +1,72 @@
+//////////////////////////////////////////////////////////////////////
+// \file    AsyncRecordWriter.h
+// \brief   Writes StandardRecords from a background thread, so that
+//          serialization and compression overlap with the next event
+//////////////////////////////////////////////////////////////////////
+
+#ifndef CAF_ASYNCRECORDWRITER_H
+#define CAF_ASYNCRECORDWRITER_H
+
+#include "sbnanaobj/StandardRecord/StandardRecord.h"
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace caf
+{
+  /// Bounded first-in first-out queue of completed records, drained by one
+  /// dedicated thread that calls the write function on each of them in
+  /// order. The write function is only ever called from that thread.
+  class AsyncRecordWriter
+  {
+  public:
+    using WriteFunc = std::function<void(StandardRecord&)>;
+
+    AsyncRecordWriter(WriteFunc write, size_t max_queue);
+    /// Flushes
+    ~AsyncRecordWriter();
+
+    /// Queues a record, blocking while the queue is full. Rethrows an
+    /// exception raised by the write function of an earlier record.
+    void Push(std::unique_ptr<StandardRecord> rec);
+
+    /// Waits until every queued record has been written, leaving the thread
+    /// running, so that the caller can use the output files in the
+    /// meantime. Rethrows an exception raised by the write function.
+    void Drain();
+
+    /// Waits until every queued record has been written and stops the
+    /// thread. Records can not be pushed afterwards. Rethrows an exception
+    /// raised by the write function.
+    void Flush();
+
+    /// Time Push() spent blocked on a full queue
+    double WaitSeconds() const {return fWaitSeconds;}
+
+  protected:
+    void Run();
+
+    WriteFunc fWrite;
+    size_t fMaxQueue;
+
+    std::mutex fMutex;
+    std::condition_variable fNotEmpty;
+    std::condition_variable fNotFull;
+    std::condition_variable fIdle;
+    std::deque<std::unique_ptr<StandardRecord>> fQueue;
+    bool fStop;
+    bool fBusy; ///< fWrite is running on a record taken off the queue
+    std::exception_ptr fError;
+
+    double fWaitSeconds;
+
+    std::thread fThread;
+  };
+}
+
+#endif
@@ -0,0 +1,124 @@
+//////////////////////////////////////////////////////////////////////
+// \file    CAFEventIndex.h
+// \brief   Sorted (run, subrun, event) -> recTree entry index, written
+//          to CAF files as the eventIndex tree
+//////////////////////////////////////////////////////////////////////
+
+#ifndef CAF_CAFEVENTINDEX_H
+#define CAF_CAFEVENTINDEX_H
+
+#include "TDirectory.h"
+#include "TTree.h"
+
+#include <algorithm>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace caf
+{
+  /// Lets a reader find the recTree entries of given events with a binary
+  /// search instead of a scan over the whole file.
+  ///
+  /// The eventIndex tree holds one entry per record, with branches run,
+  /// subrun, evt and entry, sorted by (run, subrun, evt). A repeated
+  /// event, e.g. from overlapping inputs, keeps all its entries, in
+  /// recTree order.
+  class CAFEventIndex
+  {
+  public:
+    struct Entry
+    {
+      unsigned run;
+      unsigned subrun;
+      unsigned evt;
+      Long64_t entry; ///< in recTree
+
+      bool operator<(const Entry& e) const
+      {
+        return std::tie(run, subrun, evt) < std::tie(e.run, e.subrun, e.evt);
+      }
+    };
+
+    /// Records that recTree entry \a entry holds this event
+    void Add(unsigned run, unsigned subrun, unsigned evt, Long64_t entry)
+    {
+      fEntries.push_back(Entry{run, subrun, evt, entry});
+      fSorted = fSorted && (fEntries.size() < 2 || !(fEntries.back() < fEntries[fEntries.size()-2]));
+    }
+
+    size_t size() const {return fEntries.size();}
+    bool empty() const {return fEntries.empty();}
+
+    /// Writes the sorted index as a tree named \a name in \a dir
+    void Write(TDirectory* dir, const char* name = "eventIndex")
+    {
+      Sort();
+
+      TDirectory::TContext ctx(dir);
+      TTree tr(name, "(run, subrun, evt) -> recTree entry, sorted");
+      Entry e;
+      tr.Branch("run", &e.run);
+      tr.Branch("subrun", &e.subrun);
+      tr.Branch("evt", &e.evt);
+      tr.Branch("entry", &e.entry);
+      for(const Entry& x: fEntries){
+        e = x;
+        tr.Fill();
+      }
+      tr.Write();
+    }
+
+    /// Loads the index written by Write(), false if \a dir has none
+    bool Read(TDirectory* dir, const char* name = "eventIndex")
+    {
+      fEntries.clear();
+      fSorted = true;
+
+      TTree* tr = dir ? (TTree*)dir->Get(name) : nullptr;
+      if(!tr) return false;
+
+      Entry e;
+      tr->SetBranchAddress("run", &e.run);
+      tr->SetBranchAddress("subrun", &e.subrun);
+      tr->SetBranchAddress("evt", &e.evt);
+      tr->SetBranchAddress("entry", &e.entry);
+      fEntries.reserve(tr->GetEntries());
+      for(Long64_t i = 0; i < tr->GetEntries(); ++i){
+        tr->GetEntry(i);
+        fEntries.push_back(e);
+      }
+      delete tr;
+
+      // written sorted, but don't rely on it
+      fSorted = std::is_sorted(fEntries.begin(), fEntries.end());
+      Sort();
+      return true;
+    }
+
+    /// recTree entries holding this event, in recTree order. Empty if it
+    /// is not in the file.
+    std::vector<Long64_t> Find(unsigned run, unsigned subrun, unsigned evt)
+    {
+      Sort();
+      const auto range = std::equal_range(fEntries.begin(), fEntries.end(),
+                                          Entry{run, subrun, evt, 0});
+      std::vector<Long64_t> ret;
+      for(auto it = range.first; it != range.second; ++it) ret.push_back(it->entry);
+      return ret;
+    }
+
+  protected:
+    void Sort()
+    {
+      // stable, so that repeated events stay in recTree order
+      if(!fSorted) std::stable_sort(fEntries.begin(), fEntries.end());
+      fSorted = true;
+    }
+
+    std::vector<Entry> fEntries;
+    bool fSorted = true;
+  };
+}
+
+#endif
@@ -49,6 +49,49 @@ namespace caf
       false
     };
 
+    Atom<bool> DeduplicateReco {
+      Name("DeduplicateReco"),
+      Comment("Store each track, shower and stub only in its slice. The event-level"
+              " rec.reco lists are left empty, with their counts still filled;"
+              " use the accessors in sbncode/CAFMaker/RecoAccess.h to read them."),
+      false
+    };
+
+    Atom<bool> CreateFlatCAF {
+      Name("CreateFlatCAF"),
+      Comment("Also write a flat CAF, one branch per StandardRecord field, to"
+              " the CAF filename with '.flat' inserted before its extension."),
+      false
+    };
+
+    Atom<bool> AsyncWrite {
+      Name("AsyncWrite"),
+      Comment("Serialize and compress the records in a background thread, overlapping"
+              " with the processing of the next events. Output order is preserved."),
+      false
+    };
+
+    Atom<unsigned> AsyncWriteQueueSize {
+      Name("AsyncWriteQueueSize"),
+      Comment("Maximum number of records waiting for the background writer"),
+      4
+    };
+
+    Atom<bool> ParallelSlices {
+      Name("ParallelSlices"),
+      Comment("Fill the slices of each event concurrently, using the art thread pool."
+              " The hits are backtracked up front for the truth matching. The output"
+              " is the same as with the serial filling."),
+      false
+    };
+
+    Atom<bool> TimingTree {
+      Name("TimingTree"),
+      Comment("Write a timingTree to the CAF file with the time spent in each stage of"
+              " the event processing, per event. A per-job summary is always printed."),
+      false
+    };
+
     Atom<bool> SelectOneSlice {
       Name("SelectOneSlice"),
       Comment("Only select one slice per spill (ranked by nu_score) [TODO: implement]."),
@@ -229,6 +272,15 @@ namespace caf
       true
     };
 
+    Atom<bool> FillTruthMatchParticle {
+      Name("FillTruthMatchParticle"),
+      Comment("Copy the best-matched true particle into the truth of each track, shower"
+              " and stub (truth.p). If false, truth.p is left empty and the particle is"
+              " found in rec.true_particles by truth.bestmatch.G4ID, see caf::GetTrueParticle"
+              " in sbncode/CAFMaker/RecoAccess.h. Requires FillTrueParticles."),
+      true
+    };
+
     Sequence<std::string> SystWeightLabels {
       Name("SystWeightLabels"),
       Comment("Labels for EventWeightMap objects for mc.nu.wgt")
@@ -16,7 +16,10 @@
 #include "sbncode/CAFMaker/CAFMakerParams.h"
 #include "sbncode/CAFMaker/FillFlashMatch.h"
 #include "sbncode/CAFMaker/FillTrue.h"
+#include "sbncode/CAFMaker/AsyncRecordWriter.h"
+#include "sbncode/CAFMaker/CAFEventIndex.h"
 #include "sbncode/CAFMaker/FillReco.h"
+#include "sbncode/CAFMaker/FlatRecordWriter.h"
 #include "sbncode/CAFMaker/Utils.h"
 
 // C/C++ includes
@@ -32,6 +35,9 @@
 #include <string>
 #include <vector>
 #include <array>
+#include <chrono>
+#include <memory>
+#include <mutex>
 
 #ifdef DARWINBUILD
 #include <libgen.h>
@@ -39,6 +45,8 @@
 
 #include <IFDH_service.h>
 
+#include "tbb/parallel_for.h"
+
 // ROOT includes
 #include "TFile.h"
 #include "TH1D.h"
@@ -46,6 +54,7 @@
 #include "TTimeStamp.h"
 #include "TRandomGen.h"
 #include "TObjString.h"
+#include "TROOT.h"
 
 // Framework includes
 #include "art/Framework/Core/EDProducer.h"
@@ -101,6 +110,7 @@
 #include "sbnobj/Common/Reco/StoppingChi2Fit.h"
 
 #include "canvas/Persistency/Provenance/ProcessConfiguration.h"
+#include "canvas/Utilities/Exception.h"
 #include "larcoreobj/SummaryData/POTSummary.h"
 
 // StandardRecord
@@ -110,6 +120,8 @@
 
 // // CAFMaker
 #include "sbncode/CAFMaker/AssociationUtil.h"
+#include "sbncode/CAFMaker/AssnIndex.h"
+#include "sbncode/CAFMaker/StageTimes.h"
 // #include "sbncode/CAFMaker/Blinding.h"
 
 // Metadata
@@ -133,6 +145,15 @@ namespace sbn{
 
 namespace caf {
 
+namespace {
+  /// Names of the CAFMaker::Stage's, in the same order
+  const std::vector<std::string> kStageNames {
+    "products", "truth_prep", "true_particles", "true_interactions", "detector",
+    "slice_assns", "slice", "slice_truth", "stubs", "tracks", "track_truth",
+    "showers", "shower_truth", "record", "output"
+  };
+}
+
 /// Module to create Common Analysis Files from ART files
 class CAFMaker : public art::EDProducer {
  public:
@@ -142,7 +163,7 @@ class CAFMaker : public art::EDProducer {
   explicit CAFMaker(const Parameters& params);
   virtual ~CAFMaker();
 
-  void produce(art::Event& evt) noexcept;
+  void produce(art::Event& evt);
 
   void respondToOpenInputFile(const art::FileBlock& fb);
 
@@ -173,6 +194,43 @@ class CAFMaker : public art::EDProducer {
   TFile* fFile;
   TTree* fRecTree;
 
+  TFile* fFlatFile; ///< Flat CAF output, when CreateFlatCAF is set
+  TTree* fFlatTree;
+  std::unique_ptr<FlatRecordWriter> fFlatRecord;
+
+  std::unique_ptr<AsyncRecordWriter> fAsyncWriter; ///< when AsyncWrite is set
+  double fFillSeconds; ///< Time spent in fRecTree->Fill()
+
+  CAFEventIndex fEventIndex; ///< recTree entry of each event, written at endJob
+
+  /// Disjoint parts of produce() timed in fStageTimes
+  enum Stage {
+    kStageProducts,         ///< product and service lookups
+    kStageTruthPrep,        ///< IDE and hit backtracking maps
+    kStageTrueParticles,
+    kStageTrueInteractions, ///< neutrinos, weights, fake reco, MeV portals
+    kStageDetector,         ///< CRT and trigger
+    kStageSliceAssns,       ///< per-slice association lookups
+    kStageSlice,
+    kStageSliceTruth,
+    kStageStubs,
+    kStageTracks,
+    kStageTrackTruth,
+    kStageShowers,
+    kStageShowerTruth,
+    kStageRecord,           ///< event-level StandardRecord assembly
+    kStageOutput            ///< art product and recTree fill, or queueing with AsyncWrite
+  };
+  StageTimes fStageTimes;
+  TTree* fTimingTree;                ///< when TimingTree is set
+  std::vector<double> fTimingRow;    ///< branch buffers, one per stage
+  std::array<unsigned, 3> fTimingID; ///< run, subrun, event
+
+  /// AssnIndex's built in the current event, keyed by Assns type and
+  /// label. A null entry records an Assns that was not found.
+  mutable std::map<std::pair<std::string, std::string>, std::shared_ptr<void>> fAssnIndexCache;
+  mutable std::mutex fAssnIndexMutex; ///< guards fAssnIndexCache with ParallelSlices
+
   TH1D* hPOT;
   TH1D* hSinglePOT;
   TH1D* hEvents;
@@ -192,10 +250,47 @@ class CAFMaker : public art::EDProducer {
   std::map<std::string, std::vector<sbn::evwgh::EventWeightParameterSet>> fPrevWeightPSet;
 
   void AddEnvToFile();
-  void AddMetadataToFile(const std::map<std::string, std::string>& metadata);
+  void AddMetadataToFile(TFile* f, const std::map<std::string, std::string>& metadata);
 
   void InitializeOutfile();
 
+  /// Fills the output trees with one record. Called from the background
+  /// writer thread when AsyncWrite is set.
+  void WriteRecord(StandardRecord& rec);
+
+  /// Calls \a f on fAsyncWriter, turning an exception raised by the writer
+  /// thread into an art::Exception of this module
+  template <class F>
+  void CallAsyncWriter(const char* what, F f);
+
+  /// Event products shared by all the slices of an event
+  struct SliceInputs {
+    const art::Event& evt;
+    const std::vector<art::Ptr<recob::Slice>>& slices;
+    const std::vector<std::string>& slice_tag_suffixes;
+    const std::vector<unsigned>& slice_tag_indices;
+    const std::vector<art::Ptr<simb::MCTruth>>& mctruths;
+    const std::vector<caf::SRTrueInteraction>& srneutrinos;
+    const TrueParticleIndex& true_particles;
+    const TruthCache& truth;
+    const detinfo::DetectorPropertiesData& dprop;
+    const geo::GeometryCore* geometry;
+  };
+
+  /// One slice, as filled by FillSlice
+  struct SliceOutput {
+    bool selected = false; ///< false if the slice was cut, and not filled
+    SRSlice slc;
+    std::vector<art::Ptr<recob::Hit>> hits; ///< for the fake reco
+    SRTruthMatch tmatch; ///< truth match, also of unmatched slices
+  };
+
+  /// Fills slice \a sliceID with its reco objects and their truth
+  /// matching. Only reads the module and \a in, so it can be called for
+  /// several slices concurrently.
+  void FillSlice(const SliceInputs& in, unsigned sliceID, SliceOutput& out,
+                 StageTimes& times) const;
+
   void InitVolumes(); ///< Initialize volumes from Gemotry service
 
   /// Equivalent of FindManyP except a return that is !isValid() prints a
@@ -209,6 +304,14 @@ class CAFMaker : public art::EDProducer {
                                         const art::Event& evt,
                                         const art::InputTag& tag) const;
 
+  /// Equivalent of FindManyPStrict, but looked up in an index of the
+  /// whole Assns that is built the first time it is needed in the event
+  /// and reused by all the following calls with the same types and label.
+  template <class T, class U>
+  IndexedFindManyP<T> IndexedFindManyPStrict(const std::vector<art::Ptr<U>>& from,
+                                             const art::Event& evt,
+                                             const art::InputTag& tag) const;
+
   /// \brief Retrieve an object from an association, with error handling
   ///
   /// This can go wrong in two ways: either the FindManyP itself is
@@ -260,10 +363,16 @@ class CAFMaker : public art::EDProducer {
 //.......................................................................
   CAFMaker::CAFMaker(const Parameters& params)
   : art::EDProducer{params},
-    fParams(params()), fIsRealData(false), fFile(0)
+    fParams(params()), fIsRealData(false), fFile(0),
+    fFlatFile(0), fFlatTree(0), fStageTimes(kStageNames), fTimingTree(0)
   {
   fCafFilename = fParams.CAFFilename();
 
+  if (!fParams.FillTruthMatchParticle() && !fParams.FillTrueParticles()) {
+    throw cet::exception("CAFMaker") << "FillTruthMatchParticle: false references the matched"
+                                     << " particles in rec.true_particles, which needs FillTrueParticles: true";
+  }
+
   // Normally CAFMaker is run wit no output ART stream, so these go
   // nowhere, but can be occasionally useful for filtering in ART
 
@@ -338,6 +447,19 @@ void CAFMaker::beginJob() {
   if (!fCafFilename.empty()) InitializeOutfile();
 }
 
+//......................................................................
+template <class F>
+void CAFMaker::CallAsyncWriter(const char* what, F f) {
+  try {
+    f();
+  }
+  catch (const std::exception& e) {
+    throw art::Exception(art::errors::FatalRootError)
+      << "CAFMaker: the asynchronous writer failed while " << what
+      << ": " << e.what() << "\n";
+  }
+}
+
 //......................................................................
 void CAFMaker::beginRun(art::Run& run) {
   fDet = kUNKNOWN;
@@ -430,6 +552,9 @@ void CAFMaker::beginRun(art::Run& run) {
     } // end for pset
   } // end for label
 
+  // The writer thread may be filling the trees of fFile
+  if (fAsyncWriter) CallAsyncWriter("writing the records before globalTree", [this] { fAsyncWriter->Drain(); });
+
   fFile->cd();
   TTree* globalTree = new TTree("globalTree", "globalTree");
   SRGlobal* pglobal = &global;
@@ -519,11 +644,11 @@ void CAFMaker::AddEnvToFile()
 }
 
 //......................................................................
-void CAFMaker::AddMetadataToFile(const std::map<std::string, std::string>& metadata)
+void CAFMaker::AddMetadataToFile(TFile* f, const std::map<std::string, std::string>& metadata)
 {
-  assert(fFile && "CAFMaker: Trying to add metadata to an uninitialized file");
+  assert(f && "CAFMaker: Trying to add metadata to an uninitialized file");
 
-  fFile->mkdir("metadata")->cd();
+  f->mkdir("metadata")->cd();
 
   TTree* trmeta = new TTree("metatree", "metatree");
   std::string key, value;
@@ -557,11 +682,58 @@ void CAFMaker::InitializeOutfile() {
   StandardRecord* rec = 0;
   fRecTree->Branch("rec", "caf::StandardRecord", &rec);
 
+  if (fParams.CreateFlatCAF()) {
+    // "dir/x.caf.root" -> "dir/x.flat.caf.root", "dir/x.root" ->
+    // "dir/x.flat.root", looking only at the file name since directories
+    // may have dots in them too
+    std::string flatname = fCafFilename;
+    const size_t slashpos = flatname.rfind('/');
+    const size_t basepos = (slashpos == std::string::npos) ? 0 : slashpos + 1;
+    size_t dotpos = flatname.rfind(".root");
+    if (dotpos == std::string::npos || dotpos < basepos || dotpos + 5 != flatname.size()) {
+      flatname += ".flat.root";
+    }
+    else {
+      if (dotpos >= basepos + 4 && flatname.compare(dotpos - 4, 4, ".caf") == 0) dotpos -= 4;
+      flatname.insert(dotpos, ".flat");
+    }
+    mf::LogInfo("CAFMaker") << "Flat output filename is " << flatname;
+
+    fFlatFile = new TFile(flatname.c_str(), "RECREATE");
+    fFlatTree = new TTree("recTree", "records");
+    fFlatRecord = std::make_unique<FlatRecordWriter>(fFlatTree, "caf::StandardRecord", "rec");
+    mf::LogInfo("CAFMaker") << "Flat CAF has " << fFlatRecord->NBranches() << " branches";
+    fFile->cd();
+  }
+
+  if (fParams.TimingTree()) {
+    // Held in memory and only attached to the file at endJob, since with
+    // AsyncWrite the file is written from the writer thread
+    fTimingTree = new TTree("timingTree", "CAFMaker::produce time per stage [s]");
+    fTimingTree->SetDirectory(0);
+    fTimingTree->Branch("run", &fTimingID[0]);
+    fTimingTree->Branch("subrun", &fTimingID[1]);
+    fTimingTree->Branch("evt", &fTimingID[2]);
+    fTimingRow.assign(fStageTimes.NStages(), 0);
+    for (size_t i = 0; i < fStageTimes.NStages(); i++) {
+      fTimingTree->Branch(fStageTimes.Name(i).c_str(), &fTimingRow[i]);
+    }
+  }
+
+  if (fParams.AsyncWrite()) {
+    // the trees are filled from the writer thread from now on
+    ROOT::EnableThreadSafety();
+    fAsyncWriter = std::make_unique<AsyncRecordWriter>(
+      [this](StandardRecord& rec) { WriteRecord(rec); },
+      fParams.AsyncWriteQueueSize());
+  }
+
   fFileNumber = -1;
   fTotalPOT = 0;
   fSubRunPOT = 0;
   fTotalSinglePOT = 0;
   fTotalEvents = 0;
+  fFillSeconds = 0;
   fFirstInFile = false;
   fFirstInSubRun = false;
   // fCycle = -5;
@@ -608,6 +780,41 @@ art::FindManyP<T, D> CAFMaker::FindManyPDStrict(const U& from,
   return ret;
 }
 
+//......................................................................
+template <class T, class U>
+IndexedFindManyP<T> CAFMaker::IndexedFindManyPStrict(const std::vector<art::Ptr<U>>& from,
+                                                     const art::Event& evt,
+                                                     const art::InputTag& tag) const {
+  const auto key = std::make_pair(std::string(typeid(art::Assns<U, T>).name()), tag.encode());
+  std::shared_ptr<void> cached;
+  {
+    // The first slice to need an index builds it, the others wait for it
+    std::lock_guard<std::mutex> lock(fAssnIndexMutex);
+    auto it = fAssnIndexCache.find(key);
+    if (it == fAssnIndexCache.end()) {
+      std::shared_ptr<void> index;
+      art::Handle<art::Assns<U, T>> assns;
+      if (!tag.label().empty()) evt.getByLabel(tag, assns);
+      if (assns.isValid()) {
+        index = std::make_shared<AssnIndex<U, T>>(*assns);
+      }
+      else if (!tag.label().empty() && fParams.StrictMode()) {
+        std::cout << "CAFMaker: No Assn from '"
+                  << cet::demangle_symbol(typeid(from).name()) << "' to '"
+                  << cet::demangle_symbol(typeid(T).name())
+                  << "' found under label '" << tag << "'. "
+                  << "Set 'StrictMode: false' to continue anyway." << std::endl;
+        abort();
+      }
+      it = fAssnIndexCache.emplace(key, index).first;
+    }
+    cached = it->second;
+  }
+
+  if (!cached) return IndexedFindManyP<T>();
+  return IndexedFindManyP<T>(*std::static_pointer_cast<AssnIndex<U, T>>(cached), from);
+}
+
 //......................................................................
 template <class T>
 bool CAFMaker::GetAssociatedProduct(const art::FindManyP<T>& fm, int idx,
@@ -667,7 +874,7 @@ bool CAFMaker::GetPsetParameter(const fhicl::ParameterSet& pset,
 }
 
 //......................................................................
-void CAFMaker::produce(art::Event& evt) noexcept {
+void CAFMaker::produce(art::Event& evt) {
 
   std::unique_ptr<std::vector<caf::StandardRecord>> srcol(
       new std::vector<caf::StandardRecord>);
@@ -677,6 +884,9 @@ void CAFMaker::produce(art::Event& evt) noexcept {
 
   fTotalEvents += 1;
 
+  fStageTimes.NewEvent();
+  StageTimes::Scope products_time(fStageTimes, kStageProducts);
+
   // get all the truth's
   art::Handle<std::vector<simb::MCTruth>> mctruth_handle;
   GetByLabelStrict(evt, fParams.GenLabel(), mctruth_handle);
@@ -773,9 +983,17 @@ void CAFMaker::produce(art::Event& evt) noexcept {
     }
   }
 
+  products_time.Stop();
+
   // Prep truth-to-reco-matching info
-  std::map<int, std::vector<std::pair<geo::WireID, const sim::IDE*>>> id_to_ide_map = PrepSimChannels(simchannels, *geometry);
-  std::map<int, std::vector<art::Ptr<recob::Hit>>> id_to_truehit_map = PrepTrueHits(hits, clock_data, *bt_serv.get());
+  StageTimes::Scope truth_prep_time(fStageTimes, kStageTruthPrep);
+  const IDEIndex id_to_ide_map = PrepSimChannels(simchannels, *geometry);
+  const TrueHitIndex id_to_truehit_map = PrepTrueHits(hits, clock_data, *bt_serv.get());
+  // Truth matching of the reco objects. The slices are filled
+  // concurrently only out of backtracked hits, see TruthCache.
+  TruthCache truth_cache(clock_data, *bt_serv.get(), *pi_serv.get());
+  if (fParams.ParallelSlices()) truth_cache.Prepare(hits);
+  truth_prep_time.Stop();
 
   //#######################################################
   // Fill truths & fake reco
@@ -784,6 +1002,7 @@ void CAFMaker::produce(art::Event& evt) noexcept {
   caf::SRTruthBranch                  srtruthbranch;
   std::vector<caf::SRTrueInteraction> srneutrinos;
 
+  StageTimes::Scope true_particles_time(fStageTimes, kStageTrueParticles);
   if (mc_particles.isValid()) {
     for (const simb::MCParticle part: *mc_particles) {
       true_particles.emplace_back();
@@ -800,6 +1019,12 @@ void CAFMaker::produce(art::Event& evt) noexcept {
     }
   }
 
+  // G4ID lookup shared by all the truth matching below
+  const TrueParticleIndex true_particle_index(true_particles);
+  true_particles_time.Stop();
+
+  StageTimes::Scope true_interactions_time(fStageTimes, kStageTrueInteractions);
+
   std::vector<art::FindManyP<sbn::evwgh::EventWeightMap>> fmpewm;
 
   // holder for invalid MCFlux
@@ -869,10 +1094,12 @@ void CAFMaker::produce(art::Event& evt) noexcept {
     FillMeVPrtlTruth(*mevprtl_truths[i_prtl], srtruthbranch.prtl.back());
     srtruthbranch.nprtl = srtruthbranch.prtl.size();
   } 
+  true_interactions_time.Stop();
 
   //#######################################################
   // Fill detector & reco
   //#######################################################
+  StageTimes::Scope detector_time(fStageTimes, kStageDetector);
 
   // try to find the result of the Flash trigger if it was run
   bool pass_flash_trig = false;
@@ -913,6 +1140,13 @@ void CAFMaker::produce(art::Event& evt) noexcept {
     }
   }
 
+  detector_time.Stop();
+
+  // associations are indexed the first time a slice needs them
+  fAssnIndexCache.clear();
+
+  StageTimes::Scope slices_time(fStageTimes, kStageProducts);
+
   // collect the TPC slices
   std::vector<art::Ptr<recob::Slice>> slices;
   std::vector<std::string> slice_tag_suffixes;
@@ -931,6 +1165,8 @@ void CAFMaker::produce(art::Event& evt) noexcept {
     }
   }
 
+  slices_time.Stop();
+
   // The Standard Record
   // Branch entry definition -- contains list of slices, CRT information, and truth information
   StandardRecord rec;
@@ -938,391 +1174,60 @@ void CAFMaker::produce(art::Event& evt) noexcept {
   //#######################################################
   // Loop over slices
   //#######################################################
-  for (unsigned sliceID = 0; sliceID < slices.size(); sliceID++) {
-    // Holder for information on this slice
-    caf::SRSlice recslc;
-    recslc.truth.det = fDet;
-
-    art::Ptr<recob::Slice> slice = slices[sliceID];
-    const std::string &slice_tag_suff = slice_tag_suffixes[sliceID];
-    unsigned producer = slice_tag_indices[sliceID];
-
-    // Get tracks & showers here
-    std::vector<art::Ptr<recob::Slice>> sliceList {slice};
-    art::FindManyP<recob::PFParticle> findManyPFParts =
-       FindManyPStrict<recob::PFParticle>(sliceList, evt,  fParams.PFParticleLabel() + slice_tag_suff);
-
-    std::vector<art::Ptr<recob::PFParticle>> fmPFPart;
-    if (findManyPFParts.isValid()) {
-      fmPFPart = findManyPFParts.at(0);
-    }
-
-    art::FindManyP<recob::Hit> fmSlcHits =
-      FindManyPStrict<recob::Hit>(sliceList, evt,
-          fParams.PFParticleLabel() + slice_tag_suff);
-    std::vector<art::Ptr<recob::Hit>> slcHits;
-    if (fmSlcHits.isValid()) {
-      slcHits = fmSlcHits.at(0);
-    }
-
-    art::FindManyP<sbn::SimpleFlashMatch> fm_sFM =
-      FindManyPStrict<sbn::SimpleFlashMatch>(fmPFPart, evt,
-                                             fParams.FlashMatchLabel() + slice_tag_suff);
-
-    art::FindManyP<larpandoraobj::PFParticleMetadata> fmPFPMeta =
-      FindManyPStrict<larpandoraobj::PFParticleMetadata>(fmPFPart, evt,
-               fParams.PFParticleLabel() + slice_tag_suff);
-
-    art::FindManyP<recob::Shower> fmShower =
-      FindManyPStrict<recob::Shower>(fmPFPart, evt, fParams.RecoShowerLabel() + slice_tag_suff);
-
-    // make Ptr's to showers for shower -> other object associations
-    std::vector<art::Ptr<recob::Shower>> slcShowers;
-    if (fmShower.isValid()) {
-      for (unsigned i = 0; i < fmShower.size(); i++) {
-        const std::vector<art::Ptr<recob::Shower>> &thisShowers = fmShower.at(i);
-        if (thisShowers.size() == 0) {
-          slcShowers.emplace_back(); // nullptr
-        }
-        else if (thisShowers.size() == 1) {
-          slcShowers.push_back(fmShower.at(i).at(0));
-        }
-        else assert(false); // bad
-      }
-    }
-
-    art::FindManyP<float> fmShowerCosmicDist =
-      FindManyPStrict<float>(slcShowers, evt, fParams.ShowerCosmicDistLabel() + slice_tag_suff);
-
-    art::FindManyP<float> fmShowerResiduals =
-      FindManyPStrict<float>(slcShowers, evt, fParams.RecoShowerSelectionLabel() + slice_tag_suff);
-
-    art::FindManyP<sbn::ShowerTrackFit> fmShowerTrackFit =
-      FindManyPStrict<sbn::ShowerTrackFit>(slcShowers, evt, fParams.RecoShowerSelectionLabel() + slice_tag_suff);
-
-    art::FindManyP<sbn::ShowerDensityFit> fmShowerDensityFit =
-      FindManyPStrict<sbn::ShowerDensityFit>(slcShowers, evt, fParams.RecoShowerSelectionLabel() + slice_tag_suff);
-
-    art::FindManyP<recob::Track> fmTrack =
-      FindManyPStrict<recob::Track>(fmPFPart, evt,
-            fParams.RecoTrackLabel() + slice_tag_suff);
-
-    // make Ptr's to tracks for track -> other object associations
-    std::vector<art::Ptr<recob::Track>> slcTracks;
-    if (fmTrack.isValid()) {
-      for (unsigned i = 0; i < fmTrack.size(); i++) {
-        const std::vector<art::Ptr<recob::Track>> &thisTracks = fmTrack.at(i);
-        if (thisTracks.size() == 0) {
-          slcTracks.emplace_back(); // nullptr
-        }
-        else if (thisTracks.size() == 1) {
-          slcTracks.push_back(fmTrack.at(i).at(0));
-        }
-        else assert(false); // bad
-      }
-    }
-
-    // Get the stubs!
-    art::FindManyP<sbn::Stub> fmSlcStubs =
-      FindManyPStrict<sbn::Stub>(sliceList, evt,
-          fParams.StubLabel() + slice_tag_suff);
-
-    std::vector<art::Ptr<sbn::Stub>> fmStubs;
-    if (fmSlcStubs.isValid()) {
-      fmStubs = fmSlcStubs.at(0);
-    } 
-
-    // Lookup stubs to overlaid PFP
-    art::FindManyP<recob::PFParticle> fmStubPFPs =
-      FindManyPStrict<recob::PFParticle>(fmStubs, evt,
-          fParams.StubLabel() + slice_tag_suff);
-    // and get the stub hits for truth matching
-    art::FindManyP<recob::Hit> fmStubHits =
-      FindManyPStrict<recob::Hit>(fmStubs, evt,
-          fParams.StubLabel() + slice_tag_suff);
-
-    art::FindManyP<anab::Calorimetry> fmCalo =
-      FindManyPStrict<anab::Calorimetry>(slcTracks, evt,
-           fParams.TrackCaloLabel() + slice_tag_suff);
-
-    art::FindManyP<anab::ParticleID> fmChi2PID =
-      FindManyPStrict<anab::ParticleID>(slcTracks, evt,
-          fParams.TrackChi2PidLabel() + slice_tag_suff);
-
-    art::FindManyP<sbn::ScatterClosestApproach> fmScatterClosestApproach =
-      FindManyPStrict<sbn::ScatterClosestApproach>(slcTracks, evt,
-          fParams.TrackScatterClosestApproachLabel() + slice_tag_suff);
-
-    art::FindManyP<sbn::StoppingChi2Fit> fmStoppingChi2Fit =
-      FindManyPStrict<sbn::StoppingChi2Fit>(slcTracks, evt,
-          fParams.TrackStoppingChi2FitLabel() + slice_tag_suff);
-
-    art::FindManyP<sbn::MVAPID> fmTrackDazzle =
-      FindManyPStrict<sbn::MVAPID>(slcTracks, evt,
-          fParams.TrackDazzleLabel() + slice_tag_suff);
-
-    art::FindManyP<sbn::MVAPID> fmShowerRazzle =
-      FindManyPStrict<sbn::MVAPID>(slcShowers, evt,
-          fParams.ShowerRazzleLabel() + slice_tag_suff);
-
-    art::FindManyP<recob::Vertex> fmVertex =
-      FindManyPStrict<recob::Vertex>(fmPFPart, evt,
-             fParams.PFParticleLabel() + slice_tag_suff);
-
-    art::FindManyP<recob::Hit> fmTrackHit =
-      FindManyPStrict<recob::Hit>(slcTracks, evt,
-          fParams.RecoTrackLabel() + slice_tag_suff);
-
-    art::FindManyP<recob::Hit> fmShowerHit =
-      FindManyPStrict<recob::Hit>(slcShowers, evt,
-          fParams.RecoShowerLabel() + slice_tag_suff);
-
-    // TODO: also save the sbn::crt::CRTHit in the matching so that CAFMaker has access to it
-    art::FindManyP<anab::T0> fmCRTHitMatch =
-      FindManyPStrict<anab::T0>(slcTracks, evt,
-               fParams.CRTHitMatchLabel() + slice_tag_suff);
-
-    // TODO: also save the sbn::crt::CRTTrack in the matching so that CAFMaker has access to it
-    art::FindManyP<anab::T0> fmCRTTrackMatch =
-      FindManyPStrict<anab::T0>(slcTracks, evt,
-               fParams.CRTTrackMatchLabel() + slice_tag_suff);
-
-    std::vector<art::FindManyP<recob::MCSFitResult>> fmMCSs;
-    static const std::vector<std::string> PIDnames {"muon", "pion", "kaon", "proton"};
-    for (std::string pid: PIDnames) {
-      art::InputTag tag(fParams.TrackMCSLabel() + slice_tag_suff, pid);
-      fmMCSs.push_back(FindManyPStrict<recob::MCSFitResult>(slcTracks, evt, tag));
+  const SliceInputs slice_inputs {evt, slices, slice_tag_suffixes, slice_tag_indices,
+                                  mctruths, srneutrinos, true_particle_index,
+                                  truth_cache, dprop, geometry};
+  std::vector<SliceOutput> slice_outputs(slices.size());
+  if (fParams.ParallelSlices()) {
+    std::vector<StageTimes> slice_times(slices.size(), StageTimes(kStageNames));
+    tbb::parallel_for(size_t(0), slices.size(), [&](size_t sliceID) {
+      FillSlice(slice_inputs, sliceID, slice_outputs[sliceID], slice_times[sliceID]);
+    });
+    for (const StageTimes &t: slice_times) fStageTimes.AddEvent(t);
+  }
+  else {
+    for (unsigned sliceID = 0; sliceID < slices.size(); sliceID++) {
+      FillSlice(slice_inputs, sliceID, slice_outputs[sliceID], fStageTimes);
     }
+  }
 
-    std::vector<art::FindManyP<sbn::RangeP>> fmRanges;
-    static const std::vector<std::string> rangePIDnames {"muon", "pion", "proton"};
-    for (std::string pid: rangePIDnames) {
-      art::InputTag tag(fParams.TrackRangeLabel() + slice_tag_suff, pid);
-      fmRanges.push_back(FindManyPStrict<sbn::RangeP>(slcTracks, evt, tag));
-    }
+  // Merge the selected slices in order, so that the record does not depend
+  // on how they were filled
+  for (SliceOutput &out: slice_outputs) {
+    if (!out.selected) continue;
+    caf::SRSlice &recslc = out.slc;
 
-    //    if (slice.IsNoise() || slice.NCell() == 0) continue;
-    // Because we don't care about the noise slice and slices with no hits.
+    // Printed here rather than in FillSlice, which may run concurrently
+    std::cout << "Slice matched to index: " << out.tmatch.index
+        << " with match frac: " << out.tmatch.pur << std::endl;
 
-    // get the primary particle
-    size_t iPart;
-    for (iPart = 0; iPart < fmPFPart.size(); ++iPart ) {
-      const recob::PFParticle &thisParticle = *fmPFPart[iPart];
-      if (thisParticle.IsPrimary()) break;
-    }
-    // primary particle and meta-data
-    const recob::PFParticle *primary = (iPart == fmPFPart.size()) ? NULL : fmPFPart[iPart].get();
-    const larpandoraobj::PFParticleMetadata *primary_meta = (iPart == fmPFPart.size()) ? NULL : fmPFPMeta.at(iPart).at(0).get();
-    // get the flash match
-    const sbn::SimpleFlashMatch* fmatch = nullptr;
-    if (fm_sFM.isValid() && primary != NULL) {
-      std::vector<art::Ptr<sbn::SimpleFlashMatch>> fmatches = fm_sFM.at(iPart);
-      if (fmatches.size() != 0) {
-        assert(fmatches.size() == 1);
-        fmatch = fmatches[0].get();
-      }
-    }
-    // get the primary vertex
-    const recob::Vertex *vertex = (iPart == fmPFPart.size() || !fmVertex.at(iPart).size()) ? NULL : fmVertex.at(iPart).at(0).get();
-
-    //#######################################################
-    // Add slice info.
-    //#######################################################
-    FillSliceVars(*slice, primary, producer, recslc);
-    FillSliceMetadata(primary_meta, recslc);
-    FillSliceFlashMatch(fmatch, recslc);
-    FillSliceFlashMatchA(fmatch, recslc);
-    FillSliceVertex(vertex, recslc);
-
-    // select slice
-    if (!SelectSlice(recslc, fParams.CutClearCosmic())) continue;
-
-    // Whether Pandora thinks this slice is a neutrino
-    //
-    // This requirement is used to determine whether to save additional
-    // per-hit information about the slice.
-    bool NeutrinoSlice = !recslc.is_clear_cosmic;
-
-    // Fill truth info after decision on selection is made
-    FillSliceTruth(slcHits, mctruths, srneutrinos,
-       *pi_serv.get(), clock_data, recslc, rec.mc);
-
-    FillSliceFakeReco(slcHits, mctruths, srneutrinos,
-       *pi_serv.get(), clock_data, recslc, rec.mc, mctracks, fActiveVolumes,
+    StageTimes::Scope slice_truth_time(fStageTimes, kStageSliceTruth);
+    FillSliceFakeReco(out.hits, mctruths, srneutrinos, true_particle_index,
+       truth_cache, recslc, rec.mc, mctracks, fActiveVolumes,
        *fFakeRecoTRandom);
-
-    //#######################################################
-    // Add detector dependent slice info.
-    //#######################################################
-    // if (fDet == kSBND) {
-    //   rec.sel.contain.nplanestofront = rec.slc.firstplane - (plnfirst - 1);
-    //   rec.sel.contain.nplanestoback = (plnlast) - 1 - rec.slc.lastplane;
-    // }
-
-    //#######################################################
-    // Add stub reconstructed objects.
-    //#######################################################
-    for (size_t iStub = 0; iStub < fmStubs.size(); iStub++) {
-      const sbn::Stub &thisStub = *fmStubs[iStub];
-
-      art::Ptr<recob::PFParticle> thisStubPFP;
-      if (!fmStubPFPs.at(iStub).empty()) thisStubPFP = fmStubPFPs.at(iStub).at(0);
-
-      rec.reco.stub.emplace_back();
-      FillStubVars(thisStub, thisStubPFP, rec.reco.stub.back());
-      FillStubTruth(fmStubHits.at(iStub), true_particles, clock_data, rec.reco.stub.back());
-      rec.reco.nstub = rec.reco.stub.size();
-
-      // Duplicate stub reco info in the srslice
-      recslc.reco.stub.push_back(rec.reco.stub.back());
-      recslc.reco.nstub = recslc.reco.stub.size();
+    slice_truth_time.Stop();
+
+    rec.reco.nstub += recslc.reco.stub.size();
+    rec.reco.ntrk  += recslc.reco.trk.size();
+    rec.reco.nshw  += recslc.reco.shw.size();
+    // Duplicate the reco info of the slice in rec.reco, unless asked not to.
+    // RecoAccess.h relies on rec.reco.* being the slice lists in rec.slc order.
+    if (!fParams.DeduplicateReco()) {
+      rec.reco.stub.insert(rec.reco.stub.end(), recslc.reco.stub.begin(), recslc.reco.stub.end());
+      rec.reco.trk.insert(rec.reco.trk.end(), recslc.reco.trk.begin(), recslc.reco.trk.end());
+      rec.reco.shw.insert(rec.reco.shw.end(), recslc.reco.shw.begin(), recslc.reco.shw.end());
     }
 
-    //#######################################################
-    // Add track/shower reconstructed objects.
-    //#######################################################
-    // Reco objects have assns to the slice PFParticles
-    // This depends on the findMany object created above.
-    for ( size_t iPart = 0; iPart < fmPFPart.size(); ++iPart ) {
-      const recob::PFParticle &thisParticle = *fmPFPart[iPart];
-
-      std::vector<art::Ptr<recob::Track>> thisTrack;
-      if (fmTrack.isValid()) {
-        thisTrack = fmTrack.at(iPart);
-      }
-      std::vector<art::Ptr<recob::Shower>> thisShower;
-      if (fmShower.isValid()) {
-        thisShower = fmShower.at(iPart);
-      }
-
-      if (!thisTrack.empty())  { // it's a track!
-        assert(thisTrack.size() == 1);
-        assert(thisShower.size() == 0);
-        rec.reco.ntrk ++;
-        rec.reco.trk.push_back(SRTrack());
-
-        // collect all the stuff
-        std::array<std::vector<art::Ptr<recob::MCSFitResult>>, 4> trajectoryMCS;
-        for (unsigned index = 0; index < 4; index++) {
-          if (fmMCSs[index].isValid()) {
-            trajectoryMCS[index] = fmMCSs[index].at(iPart);
-          }
-          else {
-            trajectoryMCS[index] = std::vector<art::Ptr<recob::MCSFitResult>>();
-          }
-        }
-
-        std::array<std::vector<art::Ptr<sbn::RangeP>>, 3> rangePs;
-        for (unsigned index = 0; index < 3; index++) {
-          if (fmRanges[index].isValid()) {
-            rangePs[index] = fmRanges[index].at(iPart);
-          }
-          else {
-            rangePs[index] = std::vector<art::Ptr<sbn::RangeP>>();
-          }
-        }
-
-
-        // fill all the stuff
-        FillTrackVars(*thisTrack[0], producer, rec.reco.trk.back());
-        FillTrackMCS(*thisTrack[0], trajectoryMCS, rec.reco.trk.back());
-        FillTrackRangeP(*thisTrack[0], rangePs, rec.reco.trk.back());
-
-        const larpandoraobj::PFParticleMetadata *pfpMeta = (fmPFPMeta.at(iPart).empty()) ? NULL : fmPFPMeta.at(iPart).at(0).get();
-        FillPFPVars(thisParticle, primary, pfpMeta, rec.reco.trk.back().pfp);
-
-        if (fmChi2PID.isValid()) {
-           FillTrackChi2PID(fmChi2PID.at(iPart), lar::providerFrom<geo::Geometry>(), rec.reco.trk.back());
-        }
-        if (fmScatterClosestApproach.isValid() && fmScatterClosestApproach.at(iPart).size()==1) {
-           FillTrackScatterClosestApproach(fmScatterClosestApproach.at(iPart).front(), rec.reco.trk.back());
-        }
-        if (fmStoppingChi2Fit.isValid() && fmStoppingChi2Fit.at(iPart).size()==1) {
-           FillTrackStoppingChi2Fit(fmStoppingChi2Fit.at(iPart).front(), rec.reco.trk.back());
-        }
-        if (fmTrackDazzle.isValid() && fmTrackDazzle.at(iPart).size()==1) {
-           FillTrackDazzle(fmTrackDazzle.at(iPart).front(), rec.reco.trk.back());
-        }
-        if (fmCalo.isValid()) {
-          FillTrackCalo(fmCalo.at(iPart), fmTrackHit.at(iPart),
-              (fParams.FillHitsNeutrinoSlices() && NeutrinoSlice) || fParams.FillHitsAllSlices(), 
-              fParams.TrackHitFillRRStartCut(), fParams.TrackHitFillRREndCut(),
-              lar::providerFrom<geo::Geometry>(), dprop, rec.reco.trk.back());
-        }
-        if (fmTrackHit.isValid()) {
-          FillTrackTruth(fmTrackHit.at(iPart), true_particles, clock_data, rec.reco.trk.back());
-        }
-        // NOTE: SEE TODO's AT fmCRTHitMatch and fmCRTTrackMatch
-        if (fmCRTHitMatch.isValid()) {
-          FillTrackCRTHit(fmCRTHitMatch.at(iPart), rec.reco.trk.back());
-        }
-        if (fmCRTTrackMatch.isValid()) {
-          FillTrackCRTTrack(fmCRTTrackMatch.at(iPart), rec.reco.trk.back());
-        }
-        // Duplicate track reco info in the srslice
-        recslc.reco.trk.push_back(rec.reco.trk.back());
-        recslc.reco.ntrk = recslc.reco.trk.size();
-      } // thisTrack exists
-
-      else if (!thisShower.empty()) { // it's a shower!
-        assert(thisTrack.size() == 0);
-        assert(thisShower.size() == 1);
-        rec.reco.nshw ++;
-        rec.reco.shw.push_back(SRShower());
-        FillShowerVars(*thisShower[0], vertex, fmShowerHit.at(iPart), lar::providerFrom<geo::Geometry>(), producer, rec.reco.shw.back());
-
-        const larpandoraobj::PFParticleMetadata *pfpMeta = (iPart == fmPFPart.size()) ? NULL : fmPFPMeta.at(iPart).at(0).get();
-        FillPFPVars(thisParticle, primary, pfpMeta, rec.reco.shw.back().pfp);
-
-        // We may have many residuals per shower depending on how many showers ar in the slice
-
-        if (fmShowerRazzle.isValid() && fmShowerRazzle.at(iPart).size()==1) {
-           FillShowerRazzle(fmShowerRazzle.at(iPart).front(), rec.reco.shw.back());
-        }
-        if (fmShowerCosmicDist.isValid() && fmShowerCosmicDist.at(iPart).size() != 0) {
-          FillShowerCosmicDist(fmShowerCosmicDist.at(iPart), rec.reco.shw.back());
-        }
-        if (fmShowerResiduals.isValid() && fmShowerResiduals.at(iPart).size() != 0) {
-          FillShowerResiduals(fmShowerResiduals.at(iPart), rec.reco.shw.back());
-        }
-        if (fmShowerTrackFit.isValid() && fmShowerTrackFit.at(iPart).size()  == 1) {
-          FillShowerTrackFit(*fmShowerTrackFit.at(iPart).front(), rec.reco.shw.back());
-        }
-        if (fmShowerDensityFit.isValid() && fmShowerDensityFit.at(iPart).size() == 1) {
-          FillShowerDensityFit(*fmShowerDensityFit.at(iPart).front(), rec.reco.shw.back());
-        }
-        if (fmShowerHit.isValid()) {
-          FillShowerTruth(fmShowerHit.at(iPart), true_particles, clock_data, rec.reco.shw.back());
-        }
-        // Duplicate track reco info in the srslice
-        recslc.reco.shw.push_back(rec.reco.shw.back());
-        recslc.reco.nshw = recslc.reco.shw.size();
-
-      } // thisShower exists
-
-      else {}
-
-    }// end for pfparts
-
-
-
-    //#######################################################
-    // Fill slice in rec tree
-    //#######################################################
-
-    // // Set mc branch values to default
-    // rec.mc.setDefault();
-    // if (fParams.EnableBlindness()) BlindThisRecord(&rec);
-    //util::CreateAssn(*this, evt, *srcol, art::Ptr<recob::Slice>(slices, sliceID),
-    //                 *srAssn);
-
-    rec.slc.push_back(recslc);
-
+    rec.slc.push_back(std::move(recslc));
   }  // end loop over slices
 
+  // the indices only hold Ptr's into this event
+  fAssnIndexCache.clear();
+
   //#######################################################
   //  Fill rec Tree
   //#######################################################
+  StageTimes::Scope record_time(fStageTimes, kStageRecord);
   rec.nslc            = rec.slc.size();
   rec.mc              = srtruthbranch;
   rec.fake_reco       = srfakereco;
@@ -1369,12 +1274,431 @@ void CAFMaker::produce(art::Event& evt) noexcept {
   // calculate information that needs information from all of the slices
   // SetNuMuCCPrimary(recs, srneutrinos);
 
+  record_time.Stop();
+
   // Save the standard-record
+  StageTimes::Scope output_time(fStageTimes, kStageOutput);
+  srcol->push_back(rec);
+  evt.put(std::move(srcol));
+  if (fAsyncWriter) {
+    CallAsyncWriter("queueing a record", [this, &rec] {
+      fAsyncWriter->Push(std::make_unique<StandardRecord>(std::move(rec)));
+    });
+  }
+  else WriteRecord(rec);
+  output_time.Stop();
+
+  if (fTimingTree) {
+    fTimingID = {run, subrun, evtID};
+    for (size_t i = 0; i < fStageTimes.NStages(); i++) fTimingRow[i] = fStageTimes.Event(i);
+    fTimingTree->Fill();
+  }
+}
+
+//......................................................................
+void CAFMaker::FillSlice(const SliceInputs& in, unsigned sliceID,
+                         SliceOutput& out, StageTimes& times) const {
+  StageTimes::Scope slice_assns_time(times, kStageSliceAssns);
+
+  // Holder for information on this slice
+  caf::SRSlice &recslc = out.slc;
+  recslc.truth.det = fDet;
+
+  const art::Event &evt = in.evt;
+  art::Ptr<recob::Slice> slice = in.slices[sliceID];
+  const std::string &slice_tag_suff = in.slice_tag_suffixes[sliceID];
+  unsigned producer = in.slice_tag_indices[sliceID];
+
+  // Get tracks & showers here
+  std::vector<art::Ptr<recob::Slice>> sliceList {slice};
+  IndexedFindManyP<recob::PFParticle> findManyPFParts =
+     IndexedFindManyPStrict<recob::PFParticle>(sliceList, evt,  fParams.PFParticleLabel() + slice_tag_suff);
+
+  std::vector<art::Ptr<recob::PFParticle>> fmPFPart;
+  if (findManyPFParts.isValid()) {
+    fmPFPart = findManyPFParts.at(0);
+  }
+
+  IndexedFindManyP<recob::Hit> fmSlcHits =
+    IndexedFindManyPStrict<recob::Hit>(sliceList, evt,
+        fParams.PFParticleLabel() + slice_tag_suff);
+  std::vector<art::Ptr<recob::Hit>> slcHits;
+  if (fmSlcHits.isValid()) {
+    slcHits = fmSlcHits.at(0);
+  }
+
+  IndexedFindManyP<sbn::SimpleFlashMatch> fm_sFM =
+    IndexedFindManyPStrict<sbn::SimpleFlashMatch>(fmPFPart, evt,
+                                           fParams.FlashMatchLabel() + slice_tag_suff);
+
+  IndexedFindManyP<larpandoraobj::PFParticleMetadata> fmPFPMeta =
+    IndexedFindManyPStrict<larpandoraobj::PFParticleMetadata>(fmPFPart, evt,
+             fParams.PFParticleLabel() + slice_tag_suff);
+
+  IndexedFindManyP<recob::Shower> fmShower =
+    IndexedFindManyPStrict<recob::Shower>(fmPFPart, evt, fParams.RecoShowerLabel() + slice_tag_suff);
+
+  // make Ptr's to showers for shower -> other object associations
+  std::vector<art::Ptr<recob::Shower>> slcShowers;
+  if (fmShower.isValid()) {
+    for (unsigned i = 0; i < fmShower.size(); i++) {
+      const std::vector<art::Ptr<recob::Shower>> &thisShowers = fmShower.at(i);
+      if (thisShowers.size() == 0) {
+        slcShowers.emplace_back(); // nullptr
+      }
+      else if (thisShowers.size() == 1) {
+        slcShowers.push_back(fmShower.at(i).at(0));
+      }
+      else assert(false); // bad
+    }
+  }
+
+  IndexedFindManyP<float> fmShowerCosmicDist =
+    IndexedFindManyPStrict<float>(slcShowers, evt, fParams.ShowerCosmicDistLabel() + slice_tag_suff);
+
+  IndexedFindManyP<float> fmShowerResiduals =
+    IndexedFindManyPStrict<float>(slcShowers, evt, fParams.RecoShowerSelectionLabel() + slice_tag_suff);
+
+  IndexedFindManyP<sbn::ShowerTrackFit> fmShowerTrackFit =
+    IndexedFindManyPStrict<sbn::ShowerTrackFit>(slcShowers, evt, fParams.RecoShowerSelectionLabel() + slice_tag_suff);
+
+  IndexedFindManyP<sbn::ShowerDensityFit> fmShowerDensityFit =
+    IndexedFindManyPStrict<sbn::ShowerDensityFit>(slcShowers, evt, fParams.RecoShowerSelectionLabel() + slice_tag_suff);
+
+  IndexedFindManyP<recob::Track> fmTrack =
+    IndexedFindManyPStrict<recob::Track>(fmPFPart, evt,
+          fParams.RecoTrackLabel() + slice_tag_suff);
+
+  // make Ptr's to tracks for track -> other object associations
+  std::vector<art::Ptr<recob::Track>> slcTracks;
+  if (fmTrack.isValid()) {
+    for (unsigned i = 0; i < fmTrack.size(); i++) {
+      const std::vector<art::Ptr<recob::Track>> &thisTracks = fmTrack.at(i);
+      if (thisTracks.size() == 0) {
+        slcTracks.emplace_back(); // nullptr
+      }
+      else if (thisTracks.size() == 1) {
+        slcTracks.push_back(fmTrack.at(i).at(0));
+      }
+      else assert(false); // bad
+    }
+  }
+
+  // Get the stubs!
+  IndexedFindManyP<sbn::Stub> fmSlcStubs =
+    IndexedFindManyPStrict<sbn::Stub>(sliceList, evt,
+        fParams.StubLabel() + slice_tag_suff);
+
+  std::vector<art::Ptr<sbn::Stub>> fmStubs;
+  if (fmSlcStubs.isValid()) {
+    fmStubs = fmSlcStubs.at(0);
+  } 
+
+  // Lookup stubs to overlaid PFP
+  IndexedFindManyP<recob::PFParticle> fmStubPFPs =
+    IndexedFindManyPStrict<recob::PFParticle>(fmStubs, evt,
+        fParams.StubLabel() + slice_tag_suff);
+  // and get the stub hits for truth matching
+  IndexedFindManyP<recob::Hit> fmStubHits =
+    IndexedFindManyPStrict<recob::Hit>(fmStubs, evt,
+        fParams.StubLabel() + slice_tag_suff);
+
+  IndexedFindManyP<anab::Calorimetry> fmCalo =
+    IndexedFindManyPStrict<anab::Calorimetry>(slcTracks, evt,
+         fParams.TrackCaloLabel() + slice_tag_suff);
+
+  IndexedFindManyP<anab::ParticleID> fmChi2PID =
+    IndexedFindManyPStrict<anab::ParticleID>(slcTracks, evt,
+        fParams.TrackChi2PidLabel() + slice_tag_suff);
+
+  IndexedFindManyP<sbn::ScatterClosestApproach> fmScatterClosestApproach =
+    IndexedFindManyPStrict<sbn::ScatterClosestApproach>(slcTracks, evt,
+        fParams.TrackScatterClosestApproachLabel() + slice_tag_suff);
+
+  IndexedFindManyP<sbn::StoppingChi2Fit> fmStoppingChi2Fit =
+    IndexedFindManyPStrict<sbn::StoppingChi2Fit>(slcTracks, evt,
+        fParams.TrackStoppingChi2FitLabel() + slice_tag_suff);
+
+  IndexedFindManyP<sbn::MVAPID> fmTrackDazzle =
+    IndexedFindManyPStrict<sbn::MVAPID>(slcTracks, evt,
+        fParams.TrackDazzleLabel() + slice_tag_suff);
+
+  IndexedFindManyP<sbn::MVAPID> fmShowerRazzle =
+    IndexedFindManyPStrict<sbn::MVAPID>(slcShowers, evt,
+        fParams.ShowerRazzleLabel() + slice_tag_suff);
+
+  IndexedFindManyP<recob::Vertex> fmVertex =
+    IndexedFindManyPStrict<recob::Vertex>(fmPFPart, evt,
+           fParams.PFParticleLabel() + slice_tag_suff);
+
+  IndexedFindManyP<recob::Hit> fmTrackHit =
+    IndexedFindManyPStrict<recob::Hit>(slcTracks, evt,
+        fParams.RecoTrackLabel() + slice_tag_suff);
+
+  IndexedFindManyP<recob::Hit> fmShowerHit =
+    IndexedFindManyPStrict<recob::Hit>(slcShowers, evt,
+        fParams.RecoShowerLabel() + slice_tag_suff);
+
+  // TODO: also save the sbn::crt::CRTHit in the matching so that CAFMaker has access to it
+  IndexedFindManyP<anab::T0> fmCRTHitMatch =
+    IndexedFindManyPStrict<anab::T0>(slcTracks, evt,
+             fParams.CRTHitMatchLabel() + slice_tag_suff);
+
+  // TODO: also save the sbn::crt::CRTTrack in the matching so that CAFMaker has access to it
+  IndexedFindManyP<anab::T0> fmCRTTrackMatch =
+    IndexedFindManyPStrict<anab::T0>(slcTracks, evt,
+             fParams.CRTTrackMatchLabel() + slice_tag_suff);
+
+  std::vector<IndexedFindManyP<recob::MCSFitResult>> fmMCSs;
+  static const std::vector<std::string> PIDnames {"muon", "pion", "kaon", "proton"};
+  for (std::string pid: PIDnames) {
+    art::InputTag tag(fParams.TrackMCSLabel() + slice_tag_suff, pid);
+    fmMCSs.push_back(IndexedFindManyPStrict<recob::MCSFitResult>(slcTracks, evt, tag));
+  }
+
+  std::vector<IndexedFindManyP<sbn::RangeP>> fmRanges;
+  static const std::vector<std::string> rangePIDnames {"muon", "pion", "proton"};
+  for (std::string pid: rangePIDnames) {
+    art::InputTag tag(fParams.TrackRangeLabel() + slice_tag_suff, pid);
+    fmRanges.push_back(IndexedFindManyPStrict<sbn::RangeP>(slcTracks, evt, tag));
+  }
+
+  //    if (slice.IsNoise() || slice.NCell() == 0) continue;
+  // Because we don't care about the noise slice and slices with no hits.
+
+  slice_assns_time.Stop();
+
+  StageTimes::Scope slice_time(times, kStageSlice);
+
+  // get the primary particle
+  size_t iPart;
+  for (iPart = 0; iPart < fmPFPart.size(); ++iPart ) {
+    const recob::PFParticle &thisParticle = *fmPFPart[iPart];
+    if (thisParticle.IsPrimary()) break;
+  }
+  // primary particle and meta-data
+  const recob::PFParticle *primary = (iPart == fmPFPart.size()) ? NULL : fmPFPart[iPart].get();
+  const larpandoraobj::PFParticleMetadata *primary_meta = (iPart == fmPFPart.size()) ? NULL : fmPFPMeta.at(iPart).at(0).get();
+  // get the flash match
+  const sbn::SimpleFlashMatch* fmatch = nullptr;
+  if (fm_sFM.isValid() && primary != NULL) {
+    std::vector<art::Ptr<sbn::SimpleFlashMatch>> fmatches = fm_sFM.at(iPart);
+    if (fmatches.size() != 0) {
+      assert(fmatches.size() == 1);
+      fmatch = fmatches[0].get();
+    }
+  }
+  // get the primary vertex
+  const recob::Vertex *vertex = (iPart == fmPFPart.size() || !fmVertex.at(iPart).size()) ? NULL : fmVertex.at(iPart).at(0).get();
+
+  //#######################################################
+  // Add slice info.
+  //#######################################################
+  FillSliceVars(*slice, primary, producer, recslc);
+  FillSliceMetadata(primary_meta, recslc);
+  FillSliceFlashMatch(fmatch, recslc);
+  FillSliceFlashMatchA(fmatch, recslc);
+  FillSliceVertex(vertex, recslc);
+
+  // select slice
+  if (!SelectSlice(recslc, fParams.CutClearCosmic())) return;
+  slice_time.Stop();
+
+  // Whether Pandora thinks this slice is a neutrino
+  //
+  // This requirement is used to determine whether to save additional
+  // per-hit information about the slice.
+  bool NeutrinoSlice = !recslc.is_clear_cosmic;
+
+  // Fill truth info after decision on selection is made. The fake reco
+  // draws random numbers, so it is filled when the slices are merged, in
+  // slice order.
+  StageTimes::Scope slice_truth_time(times, kStageSliceTruth);
+  caf::SRTruthBranch srmc; // not filled by FillSliceTruth
+  out.tmatch = FillSliceTruth(slcHits, in.mctruths, in.srneutrinos,
+     in.true_particles, in.truth, recslc, srmc);
+  slice_truth_time.Stop();
+
+  //#######################################################
+  // Add detector dependent slice info.
+  //#######################################################
+  // if (fDet == kSBND) {
+  //   rec.sel.contain.nplanestofront = rec.slc.firstplane - (plnfirst - 1);
+  //   rec.sel.contain.nplanestoback = (plnlast) - 1 - rec.slc.lastplane;
+  // }
+
+  //#######################################################
+  // Add stub reconstructed objects.
+  //#######################################################
+  for (size_t iStub = 0; iStub < fmStubs.size(); iStub++) {
+    StageTimes::Scope stub_time(times, kStageStubs);
+    const sbn::Stub &thisStub = *fmStubs[iStub];
+
+    art::Ptr<recob::PFParticle> thisStubPFP;
+    if (!fmStubPFPs.at(iStub).empty()) thisStubPFP = fmStubPFPs.at(iStub).at(0);
+
+    recslc.reco.stub.emplace_back();
+    FillStubVars(thisStub, thisStubPFP, recslc.reco.stub.back());
+    FillStubTruth(fmStubHits.at(iStub), in.true_particles, in.truth, recslc.reco.stub.back(),
+                  false, fParams.FillTruthMatchParticle());
+    recslc.reco.nstub = recslc.reco.stub.size();
+  }
+
+  //#######################################################
+  // Add track/shower reconstructed objects.
+  //#######################################################
+  // Reco objects have assns to the slice PFParticles
+  // This depends on the findMany object created above.
+  for ( size_t iPart = 0; iPart < fmPFPart.size(); ++iPart ) {
+    const recob::PFParticle &thisParticle = *fmPFPart[iPart];
+
+    std::vector<art::Ptr<recob::Track>> thisTrack;
+    if (fmTrack.isValid()) {
+      thisTrack = fmTrack.at(iPart);
+    }
+    std::vector<art::Ptr<recob::Shower>> thisShower;
+    if (fmShower.isValid()) {
+      thisShower = fmShower.at(iPart);
+    }
+
+    if (!thisTrack.empty())  { // it's a track!
+      StageTimes::Scope track_time(times, kStageTracks);
+      assert(thisTrack.size() == 1);
+      assert(thisShower.size() == 0);
+      recslc.reco.trk.push_back(SRTrack());
+      SRTrack &srtrack = recslc.reco.trk.back();
+
+      // collect all the stuff
+      std::array<std::vector<art::Ptr<recob::MCSFitResult>>, 4> trajectoryMCS;
+      for (unsigned index = 0; index < 4; index++) {
+        if (fmMCSs[index].isValid()) {
+          trajectoryMCS[index] = fmMCSs[index].at(iPart);
+        }
+        else {
+          trajectoryMCS[index] = std::vector<art::Ptr<recob::MCSFitResult>>();
+        }
+      }
+
+      std::array<std::vector<art::Ptr<sbn::RangeP>>, 3> rangePs;
+      for (unsigned index = 0; index < 3; index++) {
+        if (fmRanges[index].isValid()) {
+          rangePs[index] = fmRanges[index].at(iPart);
+        }
+        else {
+          rangePs[index] = std::vector<art::Ptr<sbn::RangeP>>();
+        }
+      }
+
+
+      // fill all the stuff
+      FillTrackVars(*thisTrack[0], producer, srtrack);
+      FillTrackMCS(*thisTrack[0], trajectoryMCS, srtrack);
+      FillTrackRangeP(*thisTrack[0], rangePs, srtrack);
+
+      const larpandoraobj::PFParticleMetadata *pfpMeta = (fmPFPMeta.at(iPart).empty()) ? NULL : fmPFPMeta.at(iPart).at(0).get();
+      FillPFPVars(thisParticle, primary, pfpMeta, srtrack.pfp);
+
+      if (fmChi2PID.isValid()) {
+         FillTrackChi2PID(fmChi2PID.at(iPart), in.geometry, srtrack);
+      }
+      if (fmScatterClosestApproach.isValid() && fmScatterClosestApproach.at(iPart).size()==1) {
+         FillTrackScatterClosestApproach(fmScatterClosestApproach.at(iPart).front(), srtrack);
+      }
+      if (fmStoppingChi2Fit.isValid() && fmStoppingChi2Fit.at(iPart).size()==1) {
+         FillTrackStoppingChi2Fit(fmStoppingChi2Fit.at(iPart).front(), srtrack);
+      }
+      if (fmTrackDazzle.isValid() && fmTrackDazzle.at(iPart).size()==1) {
+         FillTrackDazzle(fmTrackDazzle.at(iPart).front(), srtrack);
+      }
+      if (fmCalo.isValid()) {
+        FillTrackCalo(fmCalo.at(iPart), fmTrackHit.at(iPart),
+            (fParams.FillHitsNeutrinoSlices() && NeutrinoSlice) || fParams.FillHitsAllSlices(), 
+            fParams.TrackHitFillRRStartCut(), fParams.TrackHitFillRREndCut(),
+            in.geometry, in.dprop, srtrack);
+      }
+      track_time.Stop();
+      if (fmTrackHit.isValid()) {
+        StageTimes::Scope track_truth_time(times, kStageTrackTruth);
+        FillTrackTruth(fmTrackHit.at(iPart), in.true_particles, in.truth, srtrack,
+                       false, fParams.FillTruthMatchParticle());
+      }
+      StageTimes::Scope track_crt_time(times, kStageTracks);
+      // NOTE: SEE TODO's AT fmCRTHitMatch and fmCRTTrackMatch
+      if (fmCRTHitMatch.isValid()) {
+        FillTrackCRTHit(fmCRTHitMatch.at(iPart), srtrack);
+      }
+      if (fmCRTTrackMatch.isValid()) {
+        FillTrackCRTTrack(fmCRTTrackMatch.at(iPart), srtrack);
+      }
+      recslc.reco.ntrk = recslc.reco.trk.size();
+    } // thisTrack exists
+
+    else if (!thisShower.empty()) { // it's a shower!
+      StageTimes::Scope shower_time(times, kStageShowers);
+      assert(thisTrack.size() == 0);
+      assert(thisShower.size() == 1);
+      recslc.reco.shw.push_back(SRShower());
+      SRShower &srshower = recslc.reco.shw.back();
+      FillShowerVars(*thisShower[0], vertex, fmShowerHit.at(iPart), in.geometry, producer, srshower);
+
+      const larpandoraobj::PFParticleMetadata *pfpMeta = (iPart == fmPFPart.size()) ? NULL : fmPFPMeta.at(iPart).at(0).get();
+      FillPFPVars(thisParticle, primary, pfpMeta, srshower.pfp);
+
+      // We may have many residuals per shower depending on how many showers ar in the slice
+
+      if (fmShowerRazzle.isValid() && fmShowerRazzle.at(iPart).size()==1) {
+         FillShowerRazzle(fmShowerRazzle.at(iPart).front(), srshower);
+      }
+      if (fmShowerCosmicDist.isValid() && fmShowerCosmicDist.at(iPart).size() != 0) {
+        FillShowerCosmicDist(fmShowerCosmicDist.at(iPart), srshower);
+      }
+      if (fmShowerResiduals.isValid() && fmShowerResiduals.at(iPart).size() != 0) {
+        FillShowerResiduals(fmShowerResiduals.at(iPart), srshower);
+      }
+      if (fmShowerTrackFit.isValid() && fmShowerTrackFit.at(iPart).size()  == 1) {
+        FillShowerTrackFit(*fmShowerTrackFit.at(iPart).front(), srshower);
+      }
+      if (fmShowerDensityFit.isValid() && fmShowerDensityFit.at(iPart).size() == 1) {
+        FillShowerDensityFit(*fmShowerDensityFit.at(iPart).front(), srshower);
+      }
+      shower_time.Stop();
+      if (fmShowerHit.isValid()) {
+        StageTimes::Scope shower_truth_time(times, kStageShowerTruth);
+        FillShowerTruth(fmShowerHit.at(iPart), in.true_particles, in.truth, srshower,
+                        false, fParams.FillTruthMatchParticle());
+      }
+      recslc.reco.nshw = recslc.reco.shw.size();
+
+    } // thisShower exists
+
+    else {}
+
+  }// end for pfparts
+
+
+
+  // // Set mc branch values to default
+  // rec.mc.setDefault();
+  // if (fParams.EnableBlindness()) BlindThisRecord(&rec);
+  //util::CreateAssn(*this, evt, *srcol, art::Ptr<recob::Slice>(slices, sliceID),
+  //                 *srAssn);
+
+  out.hits = std::move(slcHits);
+  out.selected = true;
+}
+
+//......................................................................
+void CAFMaker::WriteRecord(StandardRecord& rec) {
   StandardRecord* prec = &rec;
   fRecTree->SetBranchAddress("rec", &prec);
+  const auto fill_start = std::chrono::steady_clock::now();
   fRecTree->Fill();
-  srcol->push_back(rec);
-  evt.put(std::move(srcol));
+  fFillSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - fill_start).count();
+  fEventIndex.Add(rec.hdr.run, rec.hdr.subrun, rec.hdr.evt, fRecTree->GetEntries()-1);
+  if (fFlatRecord) {
+    fFlatRecord->Fill(&rec);
+    fFlatTree->Fill();
+  }
 }
 
 void CAFMaker::endSubRun(art::SubRun& sr) {
@@ -1393,6 +1717,15 @@ void CAFMaker::endJob() {
     return;
   }
 
+  // Wait for the queued records to be written
+  if (fAsyncWriter) {
+    CallAsyncWriter("writing the last records", [this] { fAsyncWriter->Flush(); });
+    std::cout << "CAFMaker: waited " << fAsyncWriter->WaitSeconds()
+              << " s on the asynchronous writer queue" << std::endl;
+  }
+
+  if (fTimingTree) fTimingTree->SetDirectory(fFile);
+
   // Make sure the recTree is in the file before filling other items
   // for debugging.
   fFile->Write();
@@ -1403,8 +1736,29 @@ void CAFMaker::endJob() {
 
   hPOT->Write();
   hEvents->Write();
+  fEventIndex.Write(fFile);
   fFile->Write();
 
+  if (fFlatFile) {
+    fFlatFile->cd();
+    fFlatTree->Write();
+    hPOT->Write();
+    hEvents->Write();
+    // the flat recTree has the same entries
+    fEventIndex.Write(fFlatFile);
+    fFile->cd();
+  }
+
+  mf::LogInfo("CAFMaker") << "recTree " << fRecTree->GetEntries() << " entries, "
+                          << fRecTree->GetZipBytes() << " bytes compressed, "
+                          << fRecTree->GetTotBytes() << " bytes uncompressed, "
+                          << fFillSeconds << " s in Fill()"
+                          << (fParams.DeduplicateReco() ? " (DeduplicateReco)" : "");
+
+  std::cout << "CAFMaker: time per stage of produce() over "
+            << fStageTimes.NEvents() << " events" << std::endl;
+  fStageTimes.Print(std::cout);
+
   std::map<std::string, std::string> metamap;
 
   try{
@@ -1426,7 +1780,8 @@ void CAFMaker::endJob() {
     std::cout << "\n\nCAFMaker: TFileMetadataSBN service not configured -- this CAF will not have any metadata saved.\n" << std::endl;
   }
 
-  AddMetadataToFile(metamap);
+  AddMetadataToFile(fFile, metamap);
+  if (fFlatFile) AddMetadataToFile(fFlatFile, metamap);
 }
 
 
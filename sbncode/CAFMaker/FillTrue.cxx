@@ -1,20 +1,19 @@
 #include "FillTrue.h"
 
 #include "larcorealg/GeoAlgo/GeoAlgo.h"
-#include "RecoUtils/RecoUtils.h"
 
 #include <functional>
 #include <algorithm>
 
 // helper function declarations
 
-caf::SRTrackTruth MatchTrack2Truth(const detinfo::DetectorClocksData &clockData, const std::vector<caf::SRTrueParticle> &particles, const std::vector<art::Ptr<recob::Hit>> &hits);
+caf::SRTrackTruth MatchTrack2Truth(const caf::TruthCache &truth, const caf::TrueParticleIndex &particles, const std::vector<art::Ptr<recob::Hit>> &hits, bool fillParticle);
 
 caf::SRTruthMatch MatchSlice2Truth(const std::vector<art::Ptr<recob::Hit>> &hits,
            const std::vector<art::Ptr<simb::MCTruth>> &neutrinos,
                                    const std::vector<caf::SRTrueInteraction> &srneutrinos,
-           const cheat::ParticleInventoryService &inventory_service,
-                                   const detinfo::DetectorClocksData &clockData);
+                                   const caf::TrueParticleIndex &particles,
+                                   const caf::TruthCache &truth);
 
 float ContainedLength(const TVector3 &v0, const TVector3 &v1,
                       const std::vector<geoalgo::AABox> &boxes);
@@ -93,13 +92,14 @@ namespace caf {
   //------------------------------------------------
 
   void FillTrackTruth(const std::vector<art::Ptr<recob::Hit>> &hits,
-                      const std::vector<caf::SRTrueParticle> &particles,
-                      const detinfo::DetectorClocksData &clockData,
+                      const caf::TrueParticleIndex &particles,
+                      const caf::TruthCache &truth,
           caf::SRTrack& srtrack,
-          bool allowEmpty)
+          bool allowEmpty,
+          bool fillParticle)
   {
     // Truth matching
-    srtrack.truth = MatchTrack2Truth(clockData, particles, hits);
+    srtrack.truth = MatchTrack2Truth(truth, particles, hits, fillParticle);
 
   }//FillTrackTruth
 
@@ -108,47 +108,47 @@ namespace caf {
   // TODO: write trith matching for shower. Currently uses track truth matching
   // N.B. this will only work if showers are rolled up
   void FillShowerTruth(const std::vector<art::Ptr<recob::Hit>> &hits,
-                      const std::vector<caf::SRTrueParticle> &particles,
-                      const detinfo::DetectorClocksData &clockData,
+                      const caf::TrueParticleIndex &particles,
+                      const caf::TruthCache &truth,
           caf::SRShower& srshower,
-          bool allowEmpty)
+          bool allowEmpty,
+          bool fillParticle)
   {
     // Truth matching
-    srshower.truth = MatchTrack2Truth(clockData, particles, hits);
+    srshower.truth = MatchTrack2Truth(truth, particles, hits, fillParticle);
 
   }//FillShowerTruth
 
 
   void FillStubTruth(const std::vector<art::Ptr<recob::Hit>> &hits,
-                     const std::vector<caf::SRTrueParticle> &particles,
-                     const detinfo::DetectorClocksData &clockData,
+                     const caf::TrueParticleIndex &particles,
+                     const caf::TruthCache &truth,
                      caf::SRStub& srstub,
-                     bool allowEmpty) {
-    srstub.truth = MatchTrack2Truth(clockData, particles, hits);
+                     bool allowEmpty,
+                     bool fillParticle) {
+    srstub.truth = MatchTrack2Truth(truth, particles, hits, fillParticle);
   }
 
 
   //------------------------------------------------
 
-  void FillSliceTruth(const std::vector<art::Ptr<recob::Hit>> &hits,
+  caf::SRTruthMatch FillSliceTruth(const std::vector<art::Ptr<recob::Hit>> &hits,
                       const std::vector<art::Ptr<simb::MCTruth>> &neutrinos,
                       const std::vector<caf::SRTrueInteraction> &srneutrinos,
-                      const cheat::ParticleInventoryService &inventory_service,
-                      const detinfo::DetectorClocksData &clockData,
+                      const caf::TrueParticleIndex &particles,
+                      const caf::TruthCache &truth,
                       caf::SRSlice &srslice, caf::SRTruthBranch &srmc,
                       bool allowEmpty)
   {
 
-    caf::SRTruthMatch tmatch = MatchSlice2Truth(hits, neutrinos, srneutrinos, inventory_service, clockData);
+    caf::SRTruthMatch tmatch = MatchSlice2Truth(hits, neutrinos, srneutrinos, particles, truth);
 
     if (tmatch.index >= 0) {
       srslice.truth = srneutrinos[tmatch.index];
       srslice.tmatch = tmatch;
     }
 
-    std::cout << "Slice matched to index: " << tmatch.index
-        << " with match frac: " << tmatch.pur << std::endl;
-
+    return tmatch;
   }//FillSliceTruth
 
 
@@ -190,13 +190,13 @@ namespace caf {
  void FillSliceFakeReco(const std::vector<art::Ptr<recob::Hit>> &hits,
                          const std::vector<art::Ptr<simb::MCTruth>> &neutrinos,
                          const std::vector<caf::SRTrueInteraction> &srneutrinos,
-                         const cheat::ParticleInventoryService &inventory_service,
-                         const detinfo::DetectorClocksData &clockData,
+                         const caf::TrueParticleIndex &particles,
+                         const caf::TruthCache &truth,
                          caf::SRSlice &srslice, caf::SRTruthBranch &srmc,
                          const std::vector<art::Ptr<sim::MCTrack>> &mctracks,
                          const std::vector<geo::BoxBoundedGeo> &volumes, TRandom &rand)
   {
-    caf::SRTruthMatch tmatch = MatchSlice2Truth(hits, neutrinos, srneutrinos, inventory_service, clockData);
+    caf::SRTruthMatch tmatch = MatchSlice2Truth(hits, neutrinos, srneutrinos, particles, truth);
     if(tmatch.index >= 0) FRFillNumuCC(*neutrinos[tmatch.index], mctracks, volumes, rand, srslice.fake_reco);
   }//FillSliceFakeReco
 
@@ -206,7 +206,7 @@ namespace caf {
       const simb::MCFlux &mcflux,
       const simb::GTruth& gtruth,
       const std::vector<caf::SRTrueParticle> &srparticles,
-      const std::map<int, std::vector<art::Ptr<recob::Hit>>> &id_to_truehit_map,
+      const TrueHitIndex &id_to_truehit_map,
       caf::SRTrueInteraction &srneutrino, size_t i) {
 
     srneutrino.index = i;
@@ -235,8 +235,7 @@ namespace caf {
         if (srparticles[i_part].start_process == caf::kG4primary && srparticles[i_part].interaction_id == (int)i) {
           int track_id = srparticles[i_part].G4ID;
           // Look for hits
-          if (!id_to_truehit_map.count(track_id)) continue;
-          for (const art::Ptr<recob::Hit> &h: id_to_truehit_map.at(track_id)) {
+          for (const art::Ptr<recob::Hit> &h: id_to_truehit_map.Get(track_id)) {
             if (!h->WireID()) continue;
             planehitIDs[h->WireID().Plane].insert(h.key());
           }
@@ -255,8 +254,7 @@ namespace caf {
         if (srparticles[i_part].interaction_id == (int)i) {
           int track_id = srparticles[i_part].G4ID;
           // Look for hits
-          if (!id_to_truehit_map.count(track_id)) continue;
-          for (const art::Ptr<recob::Hit> &h: id_to_truehit_map.at(track_id)) {
+          for (const art::Ptr<recob::Hit> &h: id_to_truehit_map.Get(track_id)) {
             if (!h->WireID()) continue;
             planehitIDs[h->WireID().Plane].insert(h.key());
           }
@@ -359,18 +357,15 @@ namespace caf {
   void FillTrueG4Particle(const simb::MCParticle &particle,
         const std::vector<geo::BoxBoundedGeo> &active_volumes,
         const std::vector<std::vector<geo::BoxBoundedGeo>> &tpc_volumes,
-        const std::map<int, std::vector<std::pair<geo::WireID, const sim::IDE *>>> &id_to_ide_map,
-        const std::map<int, std::vector<art::Ptr<recob::Hit>>> &id_to_truehit_map,
+        const IDEIndex &id_to_ide_map,
+        const TrueHitIndex &id_to_truehit_map,
         const cheat::BackTrackerService &backtracker,
         const cheat::ParticleInventoryService &inventory_service,
         const std::vector<art::Ptr<simb::MCTruth>> &neutrinos,
                           caf::SRTrueParticle &srparticle) {
 
-    std::vector<std::pair<geo::WireID, const sim::IDE *>> empty;
-    const std::vector<std::pair<geo::WireID, const sim::IDE *>> &particle_ides = id_to_ide_map.count(particle.TrackId()) ? id_to_ide_map.at(particle.TrackId()) : empty;
-
-    std::vector<art::Ptr<recob::Hit>> emptyHits;
-    const std::vector<art::Ptr<recob::Hit>> &particle_hits = id_to_truehit_map.count(particle.TrackId()) ? id_to_truehit_map.at(particle.TrackId()) : emptyHits;
+    const IDEIndex::Range particle_ides = id_to_ide_map.Get(particle.TrackId());
+    const TrueHitIndex::Range particle_hits = id_to_truehit_map.Get(particle.TrackId());
 
     srparticle.length = 0.;
     srparticle.crosses_tpc = false;
@@ -573,19 +568,20 @@ namespace caf {
     }
   }
 
-  std::map<int, std::vector<art::Ptr<recob::Hit>>> PrepTrueHits(const std::vector<art::Ptr<recob::Hit>> &allHits, 
+  TrueHitIndex PrepTrueHits(const std::vector<art::Ptr<recob::Hit>> &allHits, 
     const detinfo::DetectorClocksData &clockData, const cheat::BackTrackerService &backtracker) {
-    std::map<int, std::vector<art::Ptr<recob::Hit>>> ret;
+    TrueHitIndex::Builder ret;
+    ret.Reserve(allHits.size());
     for (const art::Ptr<recob::Hit> h: allHits) {
       for (int ID: backtracker.HitToTrackIds(clockData, *h)) {
-        ret[abs(ID)].push_back(h);
+        ret.Add(abs(ID), h);
       }
     }
-    return ret;
+    return ret.Build();
   }
 
-  std::map<int, std::vector<std::pair<geo::WireID, const sim::IDE*>>> PrepSimChannels(const std::vector<art::Ptr<sim::SimChannel>> &simchannels, const geo::GeometryCore &geo) {
-    std::map<int, std::vector<std::pair<geo::WireID, const sim::IDE*>>> ret;
+  IDEIndex PrepSimChannels(const std::vector<art::Ptr<sim::SimChannel>> &simchannels, const geo::GeometryCore &geo) {
+    IDEIndex::Builder ret;
 
     for (const art::Ptr<sim::SimChannel> sc : simchannels) {
       // Lookup the wire of this channel
@@ -596,12 +592,11 @@ namespace caf {
 
       for (const auto &item : sc->TDCIDEMap()) {
         for (const sim::IDE &ide: item.second) {
-          // indexing initializes empty vector
-          ret[abs(ide.trackID)].push_back({thisWire, &ide});
+          ret.Add(abs(ide.trackID), {thisWire, &ide});
         }
       }
     }
-    return ret;
+    return ret.Build();
   }
 
 } // end namespace
@@ -997,11 +992,11 @@ float ContainedLength(const TVector3 &v0, const TVector3 &v1,
 }//ContainedLength
 
 //------------------------------------------------
-caf::SRTrackTruth MatchTrack2Truth(const detinfo::DetectorClocksData &clockData, const std::vector<caf::SRTrueParticle> &particles, const std::vector<art::Ptr<recob::Hit>> &hits) {
+caf::SRTrackTruth MatchTrack2Truth(const caf::TruthCache &truth, const caf::TrueParticleIndex &particles, const std::vector<art::Ptr<recob::Hit>> &hits, bool fillParticle) {
 
   // this id is the same as the mcparticle ID as long as we got it from geant4
-  std::vector<std::pair<int, float>> matches = CAFRecoUtils::AllTrueParticleIDEnergyMatches(clockData, hits, true);
-  float total_energy = CAFRecoUtils::TotalHitEnergy(clockData, hits);
+  std::vector<std::pair<int, float>> matches = truth.AllTrueParticleIDEnergyMatches(hits, true);
+  float total_energy = truth.TotalHitEnergy(hits);
 
   caf::SRTrackTruth ret;
 
@@ -1024,10 +1019,10 @@ caf::SRTrackTruth MatchTrack2Truth(const detinfo::DetectorClocksData &clockData,
 
   if (ret.matches.size()) {
     ret.bestmatch = ret.matches.at(0);
-    for (unsigned i_part = 0; i_part < particles.size(); i_part++) {
-      if (particles[i_part].G4ID == ret.bestmatch.G4ID) {
-        ret.p = particles[i_part];
-      }
+    // otherwise the particle is looked up in rec.true_particles by bestmatch.G4ID
+    if (fillParticle) {
+      const caf::SRTrueParticle *p = particles.Find(ret.bestmatch.G4ID);
+      if (p) ret.p = *p;
     }
   }
   ret.nmatches = ret.matches.size();
@@ -1038,10 +1033,10 @@ caf::SRTrackTruth MatchTrack2Truth(const detinfo::DetectorClocksData &clockData,
 caf::SRTruthMatch MatchSlice2Truth(const std::vector<art::Ptr<recob::Hit>> &hits,
            const std::vector<art::Ptr<simb::MCTruth>> &neutrinos,
                                    const std::vector<caf::SRTrueInteraction> &srneutrinos,
-           const cheat::ParticleInventoryService &inventory_service,
-                                   const detinfo::DetectorClocksData &clockData) {
+                                   const caf::TrueParticleIndex &particles,
+                                   const caf::TruthCache &truth) {
   caf::SRTruthMatch ret;
-  float total_energy = CAFRecoUtils::TotalHitEnergy(clockData, hits);
+  float total_energy = truth.TotalHitEnergy(hits);
   // speed optimization: if there are no neutrinos, all the matching energy must be cosmic
   if (neutrinos.size() == 0) {
     ret.visEinslc = total_energy / 1000. /* MeV -> GeV */;
@@ -1051,19 +1046,26 @@ caf::SRTruthMatch MatchSlice2Truth(const std::vector<art::Ptr<recob::Hit>> &hits
     ret.index = -1;
     return ret;
   }
-  std::vector<std::pair<int, float>> matches = CAFRecoUtils::AllTrueParticleIDEnergyMatches(clockData, hits, true);
+  std::vector<std::pair<int, float>> matches = truth.AllTrueParticleIDEnergyMatches(hits, true);
   std::vector<float> matching_energy(neutrinos.size(), 0.);
   for (auto const &pair: matches) {
-    art::Ptr<simb::MCTruth> truth;
+    // the true particles already know their interaction
+    const caf::SRTrueParticle *particle = particles.Find(pair.first);
+    if (particle) {
+      if (particle->interaction_id >= 0) matching_energy[particle->interaction_id] += pair.second;
+      continue;
+    }
+
+    art::Ptr<simb::MCTruth> mctruth;
     try {
-      truth = inventory_service.TrackIdToMCTruth_P(pair.first);
+      mctruth = truth.TrackIdToMCTruth(pair.first);
     }
     // Ignore track ID's that cannot be looked up
     catch(...) {
       continue;
     }
     for (unsigned ind = 0; ind < neutrinos.size(); ind++) {
-      if (truth == neutrinos[ind]) {
+      if (mctruth == neutrinos[ind]) {
         matching_energy[ind] += pair.second;
         break;
       }
@@ -32,8 +32,17 @@
 #include "sbnanaobj/StandardRecord/StandardRecord.h"
 #include "sbnanaobj/StandardRecord/SRMeVPrtl.h"
 
+#include "sbncode/CAFMaker/TrackIDIndex.h"
+#include "sbncode/CAFMaker/TrueParticleIndex.h"
+#include "sbncode/CAFMaker/TruthCache.h"
+
 namespace caf
 {
+  /// Energy depositions of each G4 track, with the wire they were read out on
+  typedef TrackIDIndex<std::pair<geo::WireID, const sim::IDE*>> IDEIndex;
+  /// Hits backtracked to each G4 track
+  typedef TrackIDIndex<art::Ptr<recob::Hit>> TrueHitIndex;
+
   // Helpers
   caf::Wall_t GetWallCross( const geo::BoxBoundedGeo &volume,
         const TVector3 p0,
@@ -45,19 +54,21 @@ namespace caf
                     caf::SRGlobal& srglobal,
                     std::map<std::string, unsigned int>& weightPSetIndex);
 
-  void FillSliceTruth(const std::vector<art::Ptr<recob::Hit>> &hits,
+  /// Fills the truth of the slice, and returns its match, also when the
+  /// slice was not matched
+  caf::SRTruthMatch FillSliceTruth(const std::vector<art::Ptr<recob::Hit>> &hits,
                       const std::vector<art::Ptr<simb::MCTruth>> &neutrinos,
                       const std::vector<caf::SRTrueInteraction> &srneutrinos,
-                      const cheat::ParticleInventoryService &inventory_service,
-                      const detinfo::DetectorClocksData &clockData,
+                      const caf::TrueParticleIndex &particles,
+                      const caf::TruthCache &truth,
                       caf::SRSlice &srslice, caf::SRTruthBranch &srmc,
                       bool allowEmpty = false);
 
   void FillSliceFakeReco(const std::vector<art::Ptr<recob::Hit>> &hits,
                          const std::vector<art::Ptr<simb::MCTruth>> &neutrinos,
                          const std::vector<caf::SRTrueInteraction> &srneutrinos,
-                         const cheat::ParticleInventoryService &inventory_service,
-                         const detinfo::DetectorClocksData &clockData,
+                         const caf::TrueParticleIndex &particles,
+                         const caf::TruthCache &truth,
                          caf::SRSlice &srslice, caf::SRTruthBranch &srmc,
                          const std::vector<art::Ptr<sim::MCTrack>> &mctracks,
                          const std::vector<geo::BoxBoundedGeo> &volumes, TRandom &rand);
@@ -65,8 +76,8 @@ namespace caf
   void FillTrueG4Particle(const simb::MCParticle &particle,
         const std::vector<geo::BoxBoundedGeo> &active_volumes,
         const std::vector<std::vector<geo::BoxBoundedGeo>> &tpc_volumes,
-        const std::map<int, std::vector<std::pair<geo::WireID, const sim::IDE *>>> &id_to_ide_map,
-        const std::map<int, std::vector<art::Ptr<recob::Hit>>> &id_to_truehit_map,
+        const IDEIndex &id_to_ide_map,
+        const TrueHitIndex &id_to_truehit_map,
         const cheat::BackTrackerService &backtracker,
         const cheat::ParticleInventoryService &inventory_service,
         const std::vector<art::Ptr<simb::MCTruth>> &neutrinos,
@@ -79,30 +90,35 @@ namespace caf
 			const simb::MCFlux &mcflux, 
                         const simb::GTruth& gtruth,
 			const std::vector<caf::SRTrueParticle> &srparticles,
-                        const std::map<int, std::vector<art::Ptr<recob::Hit>>> &id_to_truehit_map,
+                        const TrueHitIndex &id_to_truehit_map,
 			caf::SRTrueInteraction &srneutrino, size_t i);
 
   void FillEventWeight(const sbn::evwgh::EventWeightMap& wgtmap,
                        caf::SRTrueInteraction& srint,
                        const std::map<std::string, unsigned int>& weightPSetIndex);
 
+  // With fillParticle false, truth.p is left empty and the matched
+  // particle is only referenced through truth.bestmatch.G4ID
   void FillTrackTruth(const std::vector<art::Ptr<recob::Hit>> &hits,
-                      const std::vector<caf::SRTrueParticle> &particles,
-                      const detinfo::DetectorClocksData &clockData,
+                      const caf::TrueParticleIndex &particles,
+                      const caf::TruthCache &truth,
 		      caf::SRTrack& srtrack,
-		      bool allowEmpty = false);
+		      bool allowEmpty = false,
+		      bool fillParticle = true);
 
   void FillStubTruth(const std::vector<art::Ptr<recob::Hit>> &hits,
-                     const std::vector<caf::SRTrueParticle> &particles,
-                     const detinfo::DetectorClocksData &clockData,
+                     const caf::TrueParticleIndex &particles,
+                     const caf::TruthCache &truth,
                      caf::SRStub& srstub,
-                     bool allowEmpty = false);
+                     bool allowEmpty = false,
+                     bool fillParticle = true);
 
   void FillShowerTruth(const std::vector<art::Ptr<recob::Hit>> &hits,
-                      const std::vector<caf::SRTrueParticle> &particles,
-                      const detinfo::DetectorClocksData &clockData,
+                      const caf::TrueParticleIndex &particles,
+                      const caf::TruthCache &truth,
 		      caf::SRShower& srshower,
-		      bool allowEmpty = false);
+		      bool allowEmpty = false,
+		      bool fillParticle = true);
 
   void FillFakeReco(const std::vector<art::Ptr<simb::MCTruth>> &mctruths, 
                     const std::vector<art::Ptr<sim::MCTrack>> &mctracks, 
@@ -110,8 +126,8 @@ namespace caf
                     TRandom &rand,
                     std::vector<caf::SRFakeReco> &srfakereco);
 
-  std::map<int, std::vector<std::pair<geo::WireID, const sim::IDE*>>> PrepSimChannels(const std::vector<art::Ptr<sim::SimChannel>> &simchannels, const geo::GeometryCore &geo);
-  std::map<int, std::vector<art::Ptr<recob::Hit>>> PrepTrueHits(const std::vector<art::Ptr<recob::Hit>> &allHits, 
+  IDEIndex PrepSimChannels(const std::vector<art::Ptr<sim::SimChannel>> &simchannels, const geo::GeometryCore &geo);
+  TrueHitIndex PrepTrueHits(const std::vector<art::Ptr<recob::Hit>> &allHits, 
     const detinfo::DetectorClocksData &clockData, const cheat::BackTrackerService &backtracker);
 
 }
@@ -0,0 +1,283 @@
+//////////////////////////////////////////////////////////////////////
+// \file    FlatRecordWriter.cxx
+// \brief   Writes an object as a flat, one-leaf-per-field TTree
+//////////////////////////////////////////////////////////////////////
+
+#include "sbncode/CAFMaker/FlatRecordWriter.h"
+
+#include "TBaseClass.h"
+#include "TClass.h"
+#include "TDataMember.h"
+#include "TDataType.h"
+#include "TList.h"
+#include "TTree.h"
+#include "TVirtualCollectionProxy.h"
+
+#include "messagefacility/MessageLogger/MessageLogger.h"
+
+#include <stdexcept>
+
+namespace caf
+{
+  namespace
+  {
+    /// Stand-in EDataType for std::string fields
+    const int kString_t = -2;
+  }
+
+  //......................................................................
+  /// Buffer behind one branch: a scalar for fields outside any vector, a
+  /// vector with one entry per element otherwise
+  class FlatRecordWriter::Leaf
+  {
+  public:
+    virtual ~Leaf() {}
+    /// Reads one value from memory
+    virtual void Push(const char* addr) = 0;
+    /// Stores a counter (only for the ..length and ..idx leaves)
+    virtual void PushCount(size_t n) = 0;
+    virtual void Clear() = 0;
+  };
+
+  namespace
+  {
+    /// T is the type stored in the tree, Mem the type in memory
+    template<class T, class Mem = T>
+    class LeafT: public FlatRecordWriter::Leaf
+    {
+    public:
+      LeafT(TTree* tree, const std::string& name, bool vec)
+        : fVec(vec), fScalar()
+      {
+        if(vec) tree->Branch(name.c_str(), &fValues);
+        else    tree->Branch(name.c_str(), &fScalar);
+      }
+
+      void Push(const char* addr) override
+      {
+        const T v = T(*reinterpret_cast<const Mem*>(addr));
+        if(fVec) fValues.push_back(v); else fScalar = v;
+      }
+
+      void PushCount(size_t n) override
+      {
+        if(fVec) fValues.push_back(T(n)); else fScalar = T(n);
+      }
+
+      void Clear() override {fValues.clear();}
+
+    protected:
+      bool fVec;
+      T fScalar;
+      std::vector<T> fValues;
+    };
+
+    /// EDataType of a signed integer of the given size, for enums
+    int IntegerType(size_t size)
+    {
+      switch(size){
+      case 1: return kChar_t;
+      case 2: return kShort_t;
+      case 8: return kLong64_t;
+      default: return kInt_t;
+      }
+    }
+
+    bool IsString(const std::string& type_name)
+    {
+      return type_name == "string" || type_name == "std::string";
+    }
+  }
+
+  //......................................................................
+  FlatRecordWriter::FlatRecordWriter(TTree* tree,
+                                     const std::string& class_name,
+                                     const std::string& prefix)
+    : fTree(tree)
+  {
+    TClass* cl = TClass::GetClass(class_name.c_str());
+    if(!cl || !cl->HasDictionary())
+      throw std::runtime_error("FlatRecordWriter: no dictionary for class " + class_name);
+
+    AddClass(fNodes, cl, prefix, 0, 0);
+
+    if(!fSkipped.empty()){
+      mf::LogWarning log("FlatRecordWriter");
+      log << fSkipped.size() << " fields have an unsupported type and are not written:";
+      for(const std::string& f: fSkipped) log << "\n  " << f;
+    }
+  }
+
+  //......................................................................
+  FlatRecordWriter::~FlatRecordWriter()
+  {
+  }
+
+  //......................................................................
+  void FlatRecordWriter::AddClass(std::vector<Node>& nodes, TClass* cl,
+                                  const std::string& name,
+                                  size_t offset, int depth)
+  {
+    TIter next_base(cl->GetListOfBases());
+    while(TBaseClass* base = (TBaseClass*)next_base()){
+      TClass* bcl = base->GetClassPointer();
+      if(bcl) AddClass(nodes, bcl, name, offset + base->GetDelta(), depth);
+    }
+
+    TIter next_member(cl->GetListOfDataMembers());
+    while(TDataMember* dm = (TDataMember*)next_member()){
+      if(!dm->IsPersistent() || (dm->Property() & kIsStatic)) continue;
+      AddMember(nodes, dm, name + "." + dm->GetName(), offset + dm->GetOffset(), depth);
+    }
+  }
+
+  //......................................................................
+  void FlatRecordWriter::AddMember(std::vector<Node>& nodes, TDataMember* dm,
+                                   const std::string& name,
+                                   size_t offset, int depth)
+  {
+    // expand fixed-size arrays into one field per element
+    size_t n = 1;
+    for(int i = 0; i < dm->GetArrayDim(); ++i) n *= dm->GetMaxIndex(i);
+    const size_t unit = dm->GetUnitSize();
+
+    for(size_t k = 0; k < n; ++k){
+      const std::string elem_name = (dm->GetArrayDim() > 0) ? name + "." + std::to_string(k) : name;
+      const size_t elem_offset = offset + k*unit;
+
+      int type = kOther_t;
+      if(dm->IsEnum())                             type = IntegerType(unit);
+      else if(dm->IsBasic() && dm->GetDataType())  type = dm->GetDataType()->GetType();
+      else if(IsString(dm->GetTypeName()))         type = kString_t;
+
+      if(type != kOther_t){
+        Node node;
+        node.offset = elem_offset;
+        node.leaf = MakeLeaf(type, elem_name, depth > 0);
+        if(node.leaf) nodes.push_back(std::move(node));
+        else Skip(name);
+        continue;
+      }
+
+      TClass* cl = TClass::GetClass(dm->GetTypeName());
+      if(cl && cl->GetCollectionProxy()){
+        AddVector(nodes, cl, elem_name, elem_offset, depth);
+      }
+      else if(cl && cl->HasDictionary()){
+        AddClass(nodes, cl, elem_name, elem_offset, depth);
+      }
+      else{
+        Skip(name);
+      }
+    }
+  }
+
+  //......................................................................
+  void FlatRecordWriter::AddVector(std::vector<Node>& nodes, TClass* cl,
+                                   const std::string& name,
+                                   size_t offset, int depth)
+  {
+    TVirtualCollectionProxy* proxy = cl->GetCollectionProxy();
+    if(cl->GetCollectionType() != ROOT::kSTLvector){
+      Skip(name);
+      return;
+    }
+
+    Node node;
+    node.offset = offset;
+    node.proxy = proxy;
+    node.length = MakeLeaf(kUInt_t, name + "..length", depth > 0);
+    if(depth > 0) node.idx = MakeLeaf(kUInt_t, name + "..idx", true);
+    node.counter = fCounters.size();
+    fCounters.push_back(0);
+
+    TClass* value_class = proxy->GetValueClass();
+    if(!value_class){
+      node.leaf = MakeLeaf(proxy->GetType(), name, true);
+    }
+    else if(IsString(value_class->GetName())){
+      node.leaf = MakeLeaf(kString_t, name, true);
+    }
+    else if(value_class->GetCollectionProxy() || !value_class->HasDictionary()){
+      // vectors of vectors are not flattened
+      node.leaf = nullptr;
+      Skip(name);
+    }
+    else{
+      AddClass(node.children, value_class, name, 0, depth+1);
+    }
+
+    if(!node.leaf && node.children.empty()) return;
+    nodes.push_back(std::move(node));
+  }
+
+  //......................................................................
+  void FlatRecordWriter::Skip(const std::string& name)
+  {
+    // the elements of a fixed-size array share the name of the array
+    if(fSkippedNames.insert(name).second) fSkipped.push_back(name);
+  }
+
+  //......................................................................
+  FlatRecordWriter::Leaf* FlatRecordWriter::MakeLeaf(int type,
+                                                     const std::string& name,
+                                                     bool vec)
+  {
+    Leaf* leaf = nullptr;
+    switch(type){
+    case kBool_t:     leaf = new LeafT<bool>(fTree, name, vec); break;
+    case kChar_t:
+    case kchar:       leaf = new LeafT<Char_t>(fTree, name, vec); break;
+    case kUChar_t:    leaf = new LeafT<UChar_t>(fTree, name, vec); break;
+    case kShort_t:    leaf = new LeafT<Short_t>(fTree, name, vec); break;
+    case kUShort_t:   leaf = new LeafT<UShort_t>(fTree, name, vec); break;
+    case kInt_t:      leaf = new LeafT<Int_t>(fTree, name, vec); break;
+    case kUInt_t:     leaf = new LeafT<UInt_t>(fTree, name, vec); break;
+    case kLong_t:     leaf = new LeafT<Long64_t, Long_t>(fTree, name, vec); break;
+    case kULong_t:    leaf = new LeafT<ULong64_t, ULong_t>(fTree, name, vec); break;
+    case kLong64_t:   leaf = new LeafT<Long64_t>(fTree, name, vec); break;
+    case kULong64_t:  leaf = new LeafT<ULong64_t>(fTree, name, vec); break;
+    case kFloat_t:
+    case kFloat16_t:  leaf = new LeafT<Float_t>(fTree, name, vec); break;
+    case kDouble_t:
+    case kDouble32_t: leaf = new LeafT<Double_t>(fTree, name, vec); break;
+    case kString_t:   leaf = new LeafT<std::string>(fTree, name, vec); break;
+    default: return nullptr;
+    }
+    fLeaves.emplace_back(leaf);
+    return leaf;
+  }
+
+  //......................................................................
+  void FlatRecordWriter::Fill(const void* obj)
+  {
+    for(auto& leaf: fLeaves) leaf->Clear();
+    for(size_t& c: fCounters) c = 0;
+
+    for(const Node& node: fNodes) FillNode(node, (const char*)obj);
+  }
+
+  //......................................................................
+  void FlatRecordWriter::FillNode(const Node& node, const char* base)
+  {
+    const char* addr = base + node.offset;
+
+    if(!node.proxy){
+      node.leaf->Push(addr);
+      return;
+    }
+
+    TVirtualCollectionProxy::TPushPop helper(node.proxy, (void*)addr);
+    const size_t n = node.proxy->Size();
+
+    node.length->PushCount(n);
+    if(node.idx) node.idx->PushCount(fCounters[node.counter]);
+    fCounters[node.counter] += n;
+
+    for(size_t i = 0; i < n; ++i){
+      const char* elem = (const char*)node.proxy->At(i);
+      if(node.leaf) node.leaf->Push(elem);
+      for(const Node& child: node.children) FillNode(child, elem);
+    }
+  }
+}
@@ -0,0 +1,87 @@
+//////////////////////////////////////////////////////////////////////
+// \file    FlatRecordWriter.h
+// \brief   Writes an object as a flat, one-leaf-per-field TTree, with the
+//          layout generated from its ROOT dictionary
+//////////////////////////////////////////////////////////////////////
+
+#ifndef CAF_FLATRECORDWRITER_H
+#define CAF_FLATRECORDWRITER_H
+
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+class TClass;
+class TDataMember;
+class TTree;
+class TVirtualCollectionProxy;
+
+namespace caf
+{
+  /// Flattens every instance of a class into branches of a TTree.
+  ///
+  /// Each scalar field becomes one branch named by its full path, e.g.
+  /// "rec.hdr.run". A std::vector field "x" becomes a counter "x..length";
+  /// the fields of its elements are branches holding one value per
+  /// element. Vectors nested in vectors are concatenated over the parent
+  /// elements, with "x..length" and "x..idx" giving the size and the first
+  /// index of each one. Fixed-size arrays become one branch per element,
+  /// "a.0", "a.1", ...
+  ///
+  /// The layout is built once, from the dictionary, so that it follows
+  /// the class definition without any hand-maintained list.
+  class FlatRecordWriter
+  {
+  public:
+    FlatRecordWriter(TTree* tree, const std::string& class_name,
+                     const std::string& prefix);
+    ~FlatRecordWriter();
+
+    /// Sets the branches from obj, an instance of the class. Call
+    /// tree->Fill() afterwards.
+    void Fill(const void* obj);
+
+    size_t NBranches() const {return fLeaves.size();}
+
+    /// Fields that could not be flattened and are missing from the tree
+    const std::vector<std::string>& Skipped() const {return fSkipped;}
+
+    class Leaf;
+
+  protected:
+    struct Node
+    {
+      size_t offset = 0;
+      Leaf* leaf = nullptr;                 ///< a value, or the values of a vector of basic type
+      TVirtualCollectionProxy* proxy = nullptr; ///< set for vectors
+      Leaf* length = nullptr;
+      Leaf* idx = nullptr;
+      size_t counter = 0;                   ///< index in fCounters
+      std::vector<Node> children;           ///< members of vector elements
+    };
+
+    void AddClass(std::vector<Node>& nodes, TClass* cl, const std::string& name,
+                  size_t offset, int depth);
+    void AddMember(std::vector<Node>& nodes, TDataMember* dm, const std::string& name,
+                   size_t offset, int depth);
+    void AddVector(std::vector<Node>& nodes, TClass* cl, const std::string& name,
+                   size_t offset, int depth);
+
+    Leaf* MakeLeaf(int type, const std::string& name, bool vec);
+
+    /// Records a field that is not written, once
+    void Skip(const std::string& name);
+
+    void FillNode(const Node& node, const char* base);
+
+    TTree* fTree;
+    std::vector<Node> fNodes;
+    std::vector<std::unique_ptr<Leaf>> fLeaves;
+    std::vector<size_t> fCounters; ///< running number of elements per nested vector
+    std::vector<std::string> fSkipped;
+    std::set<std::string> fSkippedNames; ///< the contents of fSkipped
+  };
+}
+
+#endif
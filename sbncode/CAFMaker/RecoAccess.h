@@ -0,0 +1,149 @@
+//////////////////////////////////////////////////////////////////////
+// \file    RecoAccess.h
+// \brief   Access to the event-level reco objects of a StandardRecord,
+//          whether or not it was written with DeduplicateReco, and to
+//          the true particles they are matched to
+//////////////////////////////////////////////////////////////////////
+
+#ifndef CAF_RECOACCESS_H
+#define CAF_RECOACCESS_H
+
+#include "sbnanaobj/StandardRecord/StandardRecord.h"
+
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace caf
+{
+  // With DeduplicateReco, CAFMaker stores each track, shower and stub only in
+  // its slice and leaves rec.reco.trk/shw/stub empty, filling only
+  // rec.reco.ntrk/nshw/nstub. Without it, CAFMaker builds rec.reco.trk/shw/stub
+  // by appending the lists of the slices in rec.slc order, so the event-level
+  // lists are exactly the concatenation of the slice lists. The accessors
+  // below rely on that order to find the i-th object of a deduplicated record
+  // by walking the per-slice lists; the objects carry no key to index them
+  // by. A record whose slices do not hold exactly the event count of objects,
+  // or whose event list is neither complete nor empty, does not follow
+  // either layout and makes the accessors throw std::runtime_error.
+
+  namespace detail
+  {
+    /// Checks that evt_list is complete, or empty with the slices holding
+    /// exactly n objects. Returns whether the slice lists are to be used.
+    template<class T, class SliceList>
+    bool UseSliceLists(const std::vector<T>& evt_list, size_t n,
+                       const std::vector<SRSlice>& slcs, SliceList slice_list)
+    {
+      if(evt_list.size() == n) return false;
+      if(!evt_list.empty()){
+        throw std::runtime_error("caf::RecoAccess: the event list holds " + std::to_string(evt_list.size()) +
+                                 " objects, neither none nor the event count " + std::to_string(n));
+      }
+      size_t total = 0;
+      for(const SRSlice& slc: slcs) total += slice_list(slc).size();
+      if(total != n){
+        throw std::runtime_error("caf::RecoAccess: the slices hold " + std::to_string(total) +
+                                 " objects, not the event count " + std::to_string(n));
+      }
+      return true;
+    }
+
+    template<class T, class SliceList>
+    const T& RecoAt(const std::vector<T>& evt_list, size_t n,
+                    const std::vector<SRSlice>& slcs, SliceList slice_list,
+                    size_t i)
+    {
+      if(i >= n) throw std::out_of_range("caf::RecoAt: index out of range");
+      if(!UseSliceLists(evt_list, n, slcs, slice_list)) return evt_list[i];
+      for(const SRSlice& slc: slcs){
+        const std::vector<T>& l = slice_list(slc);
+        if(i < l.size()) return l[i];
+        i -= l.size();
+      }
+      throw std::logic_error("caf::RecoAt: object not found in the slices"); // checked above
+    }
+
+    template<class T, class SliceList>
+    std::vector<const T*> RecoAll(const std::vector<T>& evt_list, size_t n,
+                                  const std::vector<SRSlice>& slcs,
+                                  SliceList slice_list)
+    {
+      std::vector<const T*> ret;
+      ret.reserve(n);
+      if(!UseSliceLists(evt_list, n, slcs, slice_list)){
+        for(const T& x: evt_list) ret.push_back(&x);
+        return ret;
+      }
+      for(const SRSlice& slc: slcs)
+        for(const T& x: slice_list(slc)) ret.push_back(&x);
+      return ret;
+    }
+  }
+
+  /// Whether the record was written with DeduplicateReco
+  inline bool IsRecoDeduplicated(const StandardRecord& sr)
+  {
+    return (size_t)sr.reco.ntrk != sr.reco.trk.size() ||
+           (size_t)sr.reco.nshw != sr.reco.shw.size() ||
+           (size_t)sr.reco.nstub != sr.reco.stub.size();
+  }
+
+  /// i-th track of the event, same as sr.reco.trk[i] for a non-deduplicated record
+  inline const SRTrack& GetTrack(const StandardRecord& sr, size_t i)
+  {
+    return detail::RecoAt(sr.reco.trk, sr.reco.ntrk, sr.slc,
+                          [](const SRSlice& s) -> const std::vector<SRTrack>& {return s.reco.trk;}, i);
+  }
+
+  /// i-th shower of the event, same as sr.reco.shw[i] for a non-deduplicated record
+  inline const SRShower& GetShower(const StandardRecord& sr, size_t i)
+  {
+    return detail::RecoAt(sr.reco.shw, sr.reco.nshw, sr.slc,
+                          [](const SRSlice& s) -> const std::vector<SRShower>& {return s.reco.shw;}, i);
+  }
+
+  /// i-th stub of the event, same as sr.reco.stub[i] for a non-deduplicated record
+  inline const SRStub& GetStub(const StandardRecord& sr, size_t i)
+  {
+    return detail::RecoAt(sr.reco.stub, sr.reco.nstub, sr.slc,
+                          [](const SRSlice& s) -> const std::vector<SRStub>& {return s.reco.stub;}, i);
+  }
+
+  /// All the tracks of the event, in the order of sr.reco.trk
+  inline std::vector<const SRTrack*> AllTracks(const StandardRecord& sr)
+  {
+    return detail::RecoAll(sr.reco.trk, sr.reco.ntrk, sr.slc,
+                           [](const SRSlice& s) -> const std::vector<SRTrack>& {return s.reco.trk;});
+  }
+
+  /// All the showers of the event, in the order of sr.reco.shw
+  inline std::vector<const SRShower*> AllShowers(const StandardRecord& sr)
+  {
+    return detail::RecoAll(sr.reco.shw, sr.reco.nshw, sr.slc,
+                           [](const SRSlice& s) -> const std::vector<SRShower>& {return s.reco.shw;});
+  }
+
+  /// All the stubs of the event, in the order of sr.reco.stub
+  inline std::vector<const SRStub*> AllStubs(const StandardRecord& sr)
+  {
+    return detail::RecoAll(sr.reco.stub, sr.reco.nstub, sr.slc,
+                           [](const SRSlice& s) -> const std::vector<SRStub>& {return s.reco.stub;});
+  }
+
+  /// Best-matched true particle of a track, shower or stub truth. With
+  /// FillTruthMatchParticle off, truth.p is empty and the particle is
+  /// looked up in rec.true_particles. Returns nullptr if there is no match.
+  template<class Truth>
+  const SRTrueParticle* GetTrueParticle(const StandardRecord& sr, const Truth& truth)
+  {
+    if(truth.nmatches == 0) return nullptr;
+    if(truth.p.G4ID == truth.bestmatch.G4ID) return &truth.p;
+    for(const SRTrueParticle& p: sr.true_particles)
+      if(p.G4ID == truth.bestmatch.G4ID) return &p;
+    return nullptr;
+  }
+}
+
+#endif
@@ -0,0 +1,118 @@
+//////////////////////////////////////////////////////////////////////
+// \file    StageTimes.h
+// \brief   Wall-clock time spent in the stages of CAFMaker::produce, per
+//          event and summed over the job
+//////////////////////////////////////////////////////////////////////
+
+#ifndef CAF_STAGETIMES_H
+#define CAF_STAGETIMES_H
+
+#include <chrono>
+#include <iomanip>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace caf
+{
+  /// Accumulates the time spent in a fixed list of named stages. Time a
+  /// stage with a Scope; a stage entered several times in an event (e.g.
+  /// once per slice) accumulates. Stages are meant to be disjoint, so that
+  /// their sum is the time of the event.
+  class StageTimes
+  {
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit StageTimes(const std::vector<std::string>& names)
+      : fNames(names), fEvent(names.size(), 0), fTotal(names.size(), 0),
+        fNEvents(0)
+    {
+    }
+
+    /// Starts timing \a stage, stops on destruction or Stop()
+    class Scope
+    {
+    public:
+      Scope(StageTimes& times, size_t stage)
+        : fTimes(&times), fStage(stage), fStart(Clock::now())
+      {
+      }
+      ~Scope() {Stop();}
+
+      Scope(const Scope&) = delete;
+      Scope& operator=(const Scope&) = delete;
+
+      void Stop()
+      {
+        if(!fTimes) return;
+        fTimes->Add(fStage, std::chrono::duration<double>(Clock::now() - fStart).count());
+        fTimes = nullptr;
+      }
+
+    protected:
+      StageTimes* fTimes;
+      size_t fStage;
+      Clock::time_point fStart;
+    };
+
+    /// Zeroes the per-event times, call at the start of each event
+    void NewEvent()
+    {
+      for(double& t: fEvent) t = 0;
+      ++fNEvents;
+    }
+
+    void Add(size_t stage, double seconds)
+    {
+      fEvent[stage] += seconds;
+      fTotal[stage] += seconds;
+    }
+
+    /// Adds the current-event times of \a other, with the same stages,
+    /// e.g. those of work done on another thread
+    void AddEvent(const StageTimes& other)
+    {
+      for(size_t i = 0; i < fEvent.size(); ++i) Add(i, other.Event(i));
+    }
+
+    size_t NStages() const {return fNames.size();}
+    const std::string& Name(size_t stage) const {return fNames[stage];}
+    /// Seconds spent in \a stage in the current event
+    double Event(size_t stage) const {return fEvent[stage];}
+    /// Seconds spent in \a stage over the job
+    double Total(size_t stage) const {return fTotal[stage];}
+    long NEvents() const {return fNEvents;}
+
+    /// One line per stage: total, mean per event, and share of the total
+    void Print(std::ostream& os) const
+    {
+      double sum = 0;
+      for(double t: fTotal) sum += t;
+
+      os << std::setw(16) << "stage" << std::setw(12) << "total [s]"
+         << std::setw(14) << "mean [ms/ev]" << std::setw(9) << "share" << "\n";
+      for(size_t i = 0; i < fNames.size(); ++i){
+        os << std::setw(16) << fNames[i]
+           << std::fixed << std::setprecision(3)
+           << std::setw(12) << fTotal[i]
+           << std::setw(14) << (fNEvents ? 1e3*fTotal[i]/fNEvents : 0.)
+           << std::setprecision(1)
+           << std::setw(8) << (sum > 0 ? 100*fTotal[i]/sum : 0.) << "%"
+           << std::defaultfloat << "\n";
+      }
+      os << std::setw(16) << "all" << std::fixed << std::setprecision(3)
+         << std::setw(12) << sum
+         << std::setw(14) << (fNEvents ? 1e3*sum/fNEvents : 0.)
+         << std::defaultfloat << std::endl;
+    }
+
+  protected:
+    std::vector<std::string> fNames;
+    std::vector<double> fEvent;
+    std::vector<double> fTotal;
+    long fNEvents;
+  };
+}
+
+#endif
@@ -0,0 +1,117 @@
+//////////////////////////////////////////////////////////////////////
+// \file    TrackIDIndex.h
+// \brief   Compact per-G4-track-ID index of truth objects (IDEs, hits),
+//          stored as one contiguous array with CSR offsets
+//////////////////////////////////////////////////////////////////////
+
+#ifndef CAF_TRACKIDINDEX_H
+#define CAF_TRACKIDINDEX_H
+
+#include <cstddef>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace caf
+{
+  /// Maps each G4 track ID to the list of objects of type T attributed to
+  /// it, replacing a std::map<int, std::vector<T>>.
+  ///
+  /// The track IDs are remapped to dense indices 0..N-1 in order of first
+  /// appearance, and all the objects are stored in a single array grouped
+  /// by dense index: the objects of index i are values[offsets[i],
+  /// offsets[i+1]), in the order in which they were added.
+  ///
+  /// Fill with a Builder: Add() records each (ID, object) pair and counts
+  /// the objects per ID, Build() turns the counts into offsets and places
+  /// every object in one pass.
+  template<class T>
+  class TrackIDIndex
+  {
+  public:
+    /// Contiguous, read-only view of the objects of one track ID
+    class Range
+    {
+    public:
+      Range() : fBegin(nullptr), fEnd(nullptr) {}
+      Range(const T* b, const T* e) : fBegin(b), fEnd(e) {}
+
+      const T* begin() const {return fBegin;}
+      const T* end() const {return fEnd;}
+      size_t size() const {return fEnd - fBegin;}
+      bool empty() const {return fBegin == fEnd;}
+      const T& operator[](size_t i) const {return fBegin[i];}
+
+    protected:
+      const T* fBegin;
+      const T* fEnd;
+    };
+
+    class Builder
+    {
+    public:
+      /// Hint at the total number of objects, to avoid regrowing
+      void Reserve(size_t n) {fEntries.reserve(n);}
+
+      void Add(int id, T value)
+      {
+        const auto it = fIndex.emplace(id, fCounts.size()).first;
+        if(it->second == fCounts.size()) fCounts.push_back(0);
+        ++fCounts[it->second];
+        fEntries.emplace_back(it->second, std::move(value));
+      }
+
+      /// Leaves the Builder empty
+      TrackIDIndex Build()
+      {
+        TrackIDIndex ret;
+        ret.fIndex = std::move(fIndex);
+
+        ret.fOffsets.resize(fCounts.size()+1);
+        ret.fOffsets[0] = 0;
+        for(size_t i = 0; i < fCounts.size(); ++i)
+          ret.fOffsets[i+1] = ret.fOffsets[i] + fCounts[i];
+
+        // reuse the counts as the insertion cursors
+        for(size_t i = 0; i < fCounts.size(); ++i) fCounts[i] = ret.fOffsets[i];
+        ret.fValues.resize(fEntries.size());
+        for(auto& entry: fEntries)
+          ret.fValues[fCounts[entry.first]++] = std::move(entry.second);
+
+        fIndex.clear();
+        fCounts.clear();
+        fEntries.clear();
+        return ret;
+      }
+
+    protected:
+      std::unordered_map<int, size_t> fIndex; ///< track ID -> dense index
+      std::vector<size_t> fCounts;            ///< objects per dense index
+      std::vector<std::pair<size_t, T>> fEntries;
+    };
+
+    /// Objects of track \a id, empty if there are none
+    Range Get(int id) const
+    {
+      const auto it = fIndex.find(id);
+      if(it == fIndex.end()) return Range();
+      return Range(fValues.data() + fOffsets[it->second],
+                   fValues.data() + fOffsets[it->second+1]);
+    }
+
+    size_t count(int id) const {return fIndex.count(id);}
+
+    /// Number of distinct track IDs
+    size_t NIDs() const {return fIndex.size();}
+    /// Total number of objects
+    size_t size() const {return fValues.size();}
+    bool empty() const {return fValues.empty();}
+
+  protected:
+    std::unordered_map<int, size_t> fIndex;
+    std::vector<size_t> fOffsets;
+    std::vector<T> fValues;
+  };
+}
+
+#endif
@@ -0,0 +1,90 @@
+//////////////////////////////////////////////////////////////////////
+// \file    TrueParticleIndex.h
+// \brief   Per-event lookup of the true particles of an event by G4 track
+//          ID, for the truth matching of tracks, showers, stubs and slices
+//////////////////////////////////////////////////////////////////////
+
+#ifndef CAF_TRUEPARTICLEINDEX_H
+#define CAF_TRUEPARTICLEINDEX_H
+
+#include "sbnanaobj/StandardRecord/SRTrueParticle.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace caf
+{
+  /// Maps G4 track IDs to their position in the event's list of true
+  /// particles, with an open-addressing (linear probing) hash table built
+  /// once after the particles are filled.
+  ///
+  /// The index refers to the particle list it was built from, which must
+  /// outlive it and not be modified in between.
+  class TrueParticleIndex
+  {
+  public:
+    TrueParticleIndex() : fParticles(nullptr), fMask(0) {}
+
+    explicit TrueParticleIndex(const std::vector<SRTrueParticle>& particles)
+      : fParticles(&particles)
+    {
+      // keep the load factor at or below 1/2
+      size_t cap = 16;
+      while(cap < 2*particles.size()) cap *= 2;
+      fMask = cap-1;
+      fSlots.assign(cap, Slot{0, -1});
+
+      for(size_t i = 0; i < particles.size(); ++i){
+        Slot& s = fSlots[Probe(particles[i].G4ID)];
+        s.G4ID = particles[i].G4ID;
+        s.index = i; // a repeated G4ID resolves to the last particle
+      }
+    }
+
+    /// Position of the particle with this G4 track ID, -1 if there is none
+    int Index(int G4ID) const
+    {
+      if(fSlots.empty()) return -1;
+      return fSlots[Probe(G4ID)].index;
+    }
+
+    /// The particle with this G4 track ID, nullptr if there is none
+    const SRTrueParticle* Find(int G4ID) const
+    {
+      const int i = Index(G4ID);
+      return (i < 0) ? nullptr : &(*fParticles)[i];
+    }
+
+    /// The list of particles the index was built from
+    const std::vector<SRTrueParticle>& Particles() const
+    {
+      static const std::vector<SRTrueParticle> empty;
+      return fParticles ? *fParticles : empty;
+    }
+
+  protected:
+    struct Slot
+    {
+      int G4ID;
+      int index; ///< -1 for an empty slot
+    };
+
+    /// Position of the slot holding G4ID, or of the empty slot where it
+    /// would go
+    size_t Probe(int G4ID) const
+    {
+      // The multiplier is odd, so IDs that differ only in their low bits
+      // (consecutive G4 IDs) never share a home slot
+      size_t h = (uint32_t(G4ID) * 2654435769u) & fMask;
+      while(fSlots[h].index >= 0 && fSlots[h].G4ID != G4ID) h = (h+1) & fMask;
+      return h;
+    }
+
+    const std::vector<SRTrueParticle>* fParticles;
+    std::vector<Slot> fSlots;
+    size_t fMask;
+  };
+}
+
+#endif
@@ -0,0 +1,82 @@
+//////////////////////////////////////////////////////////////////////
+// \file    TruthCache.cxx
+// \brief   Per-event backtracking of hits to true particles
+//////////////////////////////////////////////////////////////////////
+
+#include "sbncode/CAFMaker/TruthCache.h"
+
+#include <cstdlib>
+
+namespace caf
+{
+  //......................................................................
+  TruthCache::TruthCache(const detinfo::DetectorClocksData& clockData,
+                         const cheat::BackTrackerService& backtracker,
+                         const cheat::ParticleInventoryService& inventory)
+    : fClockData(clockData), fBackTracker(backtracker), fInventory(inventory)
+  {
+  }
+
+  //......................................................................
+  void TruthCache::Prepare(const std::vector<art::Ptr<recob::Hit>>& hits)
+  {
+    for(const art::Ptr<recob::Hit>& hit: hits){
+      Table& t = fTables[hit.id()];
+      if(t.ides.size() <= hit.key()){
+        t.ides.resize(hit.key()+1);
+        t.done.resize(hit.key()+1, false);
+      }
+      if(t.done[hit.key()]) continue;
+      t.ides[hit.key()] = fBackTracker.HitToTrackIDEs(fClockData, hit);
+      t.done[hit.key()] = true;
+    }
+  }
+
+  //......................................................................
+  const std::vector<sim::TrackIDE>* TruthCache::HitToTrackIDEs(const art::Ptr<recob::Hit>& hit,
+                                                               std::vector<sim::TrackIDE>& buf) const
+  {
+    const auto it = fTables.find(hit.id());
+    if(it != fTables.end() && hit.key() < it->second.done.size() && it->second.done[hit.key()])
+      return &it->second.ides[hit.key()];
+
+    std::lock_guard<std::mutex> lock(fServiceMutex);
+    buf = fBackTracker.HitToTrackIDEs(fClockData, hit);
+    return &buf;
+  }
+
+  //......................................................................
+  std::vector<std::pair<int, float>> TruthCache::AllTrueParticleIDEnergyMatches(const std::vector<art::Ptr<recob::Hit>>& hits,
+                                                                                bool rollup_unsaved_ids) const
+  {
+    std::vector<sim::TrackIDE> buf;
+    std::map<int, float> trackIDToEDepMap;
+    for(const art::Ptr<recob::Hit>& hit: hits){
+      for(const sim::TrackIDE& ide: *HitToTrackIDEs(hit, buf)){
+        int id = ide.trackID;
+        if(rollup_unsaved_ids) id = std::abs(id);
+        trackIDToEDepMap[id] += ide.energy;
+      }
+    }
+
+    return std::vector<std::pair<int, float>>(trackIDToEDepMap.begin(), trackIDToEDepMap.end());
+  }
+
+  //......................................................................
+  float TruthCache::TotalHitEnergy(const std::vector<art::Ptr<recob::Hit>>& hits) const
+  {
+    std::vector<sim::TrackIDE> buf;
+    float ret = 0.;
+    for(const art::Ptr<recob::Hit>& hit: hits){
+      for(const sim::TrackIDE& ide: *HitToTrackIDEs(hit, buf)) ret += ide.energy;
+    }
+    return ret;
+  }
+
+  //......................................................................
+  art::Ptr<simb::MCTruth> TruthCache::TrackIdToMCTruth(int trackID) const
+  {
+    std::lock_guard<std::mutex> lock(fServiceMutex);
+    return fInventory.TrackIdToMCTruth_P(trackID);
+  }
+}
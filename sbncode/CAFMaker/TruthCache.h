@@ -0,0 +1,75 @@
+//////////////////////////////////////////////////////////////////////
+// \file    TruthCache.h
+// \brief   Per-event backtracking of hits to true particles, safe to
+//          query from several threads
+//////////////////////////////////////////////////////////////////////
+
+#ifndef CAF_TRUTHCACHE_H
+#define CAF_TRUTHCACHE_H
+
+#include "canvas/Persistency/Common/Ptr.h"
+#include "canvas/Persistency/Provenance/ProductID.h"
+
+#include "lardataobj/RecoBase/Hit.h"
+#include "larsim/MCCheater/BackTrackerService.h"
+#include "larsim/MCCheater/ParticleInventoryService.h"
+#include "nusimdata/SimulationBase/MCTruth.h"
+
+#include <map>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace caf
+{
+  /// Front end to the BackTracker and ParticleInventory services for the
+  /// truth matching of reco objects.
+  ///
+  /// Hits passed to Prepare() are backtracked once, and later lookups of
+  /// them only read the cached result, so they can be made concurrently.
+  /// Anything else falls back to the services, one call at a time, since
+  /// those are not thread-safe. Without Prepare() this is the same as
+  /// calling the services directly.
+  class TruthCache
+  {
+  public:
+    TruthCache(const detinfo::DetectorClocksData& clockData,
+               const cheat::BackTrackerService& backtracker,
+               const cheat::ParticleInventoryService& inventory);
+
+    /// Backtracks \a hits now. Not thread-safe itself.
+    void Prepare(const std::vector<art::Ptr<recob::Hit>>& hits);
+
+    /// Same as CAFRecoUtils::AllTrueParticleIDEnergyMatches
+    std::vector<std::pair<int, float>> AllTrueParticleIDEnergyMatches(const std::vector<art::Ptr<recob::Hit>>& hits,
+                                                                      bool rollup_unsaved_ids = true) const;
+
+    /// Same as CAFRecoUtils::TotalHitEnergy
+    float TotalHitEnergy(const std::vector<art::Ptr<recob::Hit>>& hits) const;
+
+    /// Same as ParticleInventoryService::TrackIdToMCTruth_P, including
+    /// the exception for unknown track IDs
+    art::Ptr<simb::MCTruth> TrackIdToMCTruth(int trackID) const;
+
+  protected:
+    /// The cached IDEs of \a hit, or nullptr. In the latter case they are
+    /// looked up in the BackTracker and stored in \a buf.
+    const std::vector<sim::TrackIDE>* HitToTrackIDEs(const art::Ptr<recob::Hit>& hit,
+                                                     std::vector<sim::TrackIDE>& buf) const;
+
+    const detinfo::DetectorClocksData& fClockData;
+    const cheat::BackTrackerService& fBackTracker;
+    const cheat::ParticleInventoryService& fInventory;
+
+    struct Table
+    {
+      std::vector<std::vector<sim::TrackIDE>> ides; ///< indexed by hit key
+      std::vector<bool> done;
+    };
+    std::map<art::ProductID, Table> fTables; ///< one per hit product
+
+    mutable std::mutex fServiceMutex;
+  };
+}
+
+#endif
@@ -0,0 +1,254 @@
+// Rewrites the recTree of an existing CAF under a matrix of output layouts
+// (compression, basket size, auto-flush, split level) and reports, for
+// each, the write and read throughputs and the file size.
+//
+// Usage: benchCAFLayout input.caf.root [options]
+//   -n N        number of records to use (default 1000)
+//   -c LIST     compression settings, algorithm*100+level (default 505,404,207,101)
+//               algorithms: 1 ZLIB, 2 LZMA, 4 LZ4, 5 ZSTD
+//   -b LIST     basket sizes in bytes (default 32000,256000)
+//   -f LIST     auto-flush, >0 entries or <0 bytes (default -30000000,1000)
+//   -s LIST     split levels (default 99,0)
+//   -p LIST     branches read in the partial read (default rec.hdr.*,rec.slc.nu_score)
+//   -o FILE     temporary output file (default benchCAFLayout.tmp.root)
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <sys/stat.h>
+
+#include "TClass.h"
+#include "TError.h"
+#include "TFile.h"
+#include "TTree.h"
+
+namespace
+{
+  using Clock = std::chrono::steady_clock;
+
+  double Seconds(const Clock::time_point& start)
+  {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+  }
+
+  std::vector<std::string> Split(const std::string& s)
+  {
+    std::vector<std::string> ret;
+    std::stringstream ss(s);
+    std::string tok;
+    while(std::getline(ss, tok, ',')) if(!tok.empty()) ret.push_back(tok);
+    return ret;
+  }
+
+  std::vector<long> SplitLong(const std::string& s)
+  {
+    std::vector<long> ret;
+    for(const std::string& tok: Split(s)) ret.push_back(std::stol(tok));
+    return ret;
+  }
+
+  struct Layout
+  {
+    int compress;
+    int basket;
+    long flush;
+    int split;
+  };
+
+  struct Result
+  {
+    double write_s;
+    double full_read_s;
+    double partial_read_s;
+    long long tot_bytes;
+    long long file_bytes;
+    long long partial_bytes;
+  };
+
+  Result Measure(TClass* cl, const std::vector<void*>& recs, const Layout& l,
+                 const std::string& tmpname,
+                 const std::vector<std::string>& partial)
+  {
+    Result res;
+
+    // write
+    auto start = Clock::now();
+    {
+      TFile fout(tmpname.c_str(), "RECREATE", "", l.compress);
+      // owned, and deleted on Close(), by fout
+      TTree* tr = new TTree("recTree", "records");
+      void* obj = recs.front();
+      tr->Branch("rec", cl->GetName(), &obj, l.basket, l.split);
+      tr->SetAutoFlush(l.flush);
+      for(void* rec: recs){
+        obj = rec;
+        tr->SetBranchAddress("rec", &obj);
+        tr->Fill();
+      }
+      tr->Write();
+      res.tot_bytes = tr->GetTotBytes();
+      fout.Close();
+    }
+    res.write_s = Seconds(start);
+
+    struct stat buf;
+    res.file_bytes = (stat(tmpname.c_str(), &buf) == 0) ? buf.st_size : -1;
+
+    void* obj = cl->New();
+
+    // full read
+    start = Clock::now();
+    {
+      TFile fin(tmpname.c_str(), "READ");
+      TTree* tr = (TTree*)fin.Get("recTree");
+      tr->SetBranchAddress("rec", &obj);
+      for(long i = 0; i < tr->GetEntries(); ++i) tr->GetEntry(i);
+    }
+    res.full_read_s = Seconds(start);
+
+    // partial read
+    res.partial_bytes = 0;
+    start = Clock::now();
+    {
+      TFile fin(tmpname.c_str(), "READ");
+      TTree* tr = (TTree*)fin.Get("recTree");
+      tr->SetBranchAddress("rec", &obj);
+      if(l.split > 0){
+        tr->SetBranchStatus("*", false);
+        for(const std::string& b: partial) tr->SetBranchStatus(b.c_str(), true);
+      }
+      for(long i = 0; i < tr->GetEntries(); ++i) res.partial_bytes += tr->GetEntry(i);
+    }
+    res.partial_read_s = Seconds(start);
+
+    cl->Destructor(obj);
+    std::remove(tmpname.c_str());
+
+    return res;
+  }
+}
+
+int main(int argc, char** argv)
+{
+  gErrorIgnoreLevel = kWarning;
+
+  if(argc < 2 || argv[1][0] == '-'){
+    std::cerr << "Usage: benchCAFLayout input.caf.root [-n N] [-c LIST] [-b LIST] "
+              << "[-f LIST] [-s LIST] [-p LIST] [-o FILE]" << std::endl;
+    exit(1);
+  }
+
+  const std::string filePath = argv[1];
+  long nmax = 1000;
+  std::vector<long> compress = {505, 404, 207, 101};
+  std::vector<long> baskets = {32000, 256000};
+  std::vector<long> flushes = {-30000000, 1000};
+  std::vector<long> splits = {99, 0};
+  std::vector<std::string> partial = {"rec.hdr.*", "rec.slc.nu_score"};
+  std::string tmpname = "benchCAFLayout.tmp.root";
+
+  for(int i = 2; i < argc; i += 2){
+    const std::string opt = argv[i];
+    if(i+1 >= argc){
+      std::cerr << "ERROR: Option " << opt << " needs a value" << std::endl;
+      exit(1);
+    }
+    const std::string val = argv[i+1];
+    if(opt == "-n") nmax = std::stol(val);
+    else if(opt == "-c") compress = SplitLong(val);
+    else if(opt == "-b") baskets = SplitLong(val);
+    else if(opt == "-f") flushes = SplitLong(val);
+    else if(opt == "-s") splits = SplitLong(val);
+    else if(opt == "-p") partial = Split(val);
+    else if(opt == "-o") tmpname = val;
+    else{
+      std::cerr << "ERROR: Unknown option " << opt << std::endl;
+      exit(1);
+    }
+  }
+
+  std::unique_ptr<TFile> f(TFile::Open(filePath.c_str(), "READ"));
+  if(!f || !f->IsOpen()){
+    std::cerr << "ERROR: Unable to open " << filePath
+              << " as a TFile, is this a proper ROOT file?" << std::endl;
+    exit(1);
+  }
+
+  TTree* tr = (TTree*)f->Get("recTree");
+  if(!tr || !tr->GetBranch("rec")){
+    std::cerr << "ERROR: Unable to access recTree in " << filePath
+              << " is this a proper CAF?" << std::endl;
+    exit(1);
+  }
+
+  TClass* cl = TClass::GetClass(tr->GetBranch("rec")->GetClassName());
+  if(!cl || !cl->HasDictionary()){
+    std::cerr << "ERROR: No dictionary for " << tr->GetBranch("rec")->GetClassName() << std::endl;
+    exit(1);
+  }
+
+  // Hold the records in memory, so that the write timing does not include
+  // reading the input
+  std::vector<void*> recs;
+  const long n = std::min(nmax, (long)tr->GetEntries());
+  recs.reserve(n);
+  for(long i = 0; i < n; ++i){
+    void* obj = cl->New();
+    tr->SetBranchAddress("rec", &obj);
+    tr->GetEntry(i);
+    recs.push_back(obj);
+  }
+  tr->ResetBranchAddresses();
+  f.reset();
+
+  if(recs.empty()){
+    std::cerr << "ERROR: No records in " << filePath << std::endl;
+    exit(1);
+  }
+
+  std::cout << "Read " << recs.size() << " records of " << cl->GetName()
+            << " from " << filePath << std::endl;
+  std::cout << std::setw(8) << "compress" << std::setw(9) << "basket"
+            << std::setw(11) << "autoflush" << std::setw(6) << "split"
+            << std::setw(12) << "size[MB]" << std::setw(8) << "ratio"
+            << std::setw(13) << "write[MB/s]" << std::setw(12) << "write[ev/s]"
+            << std::setw(12) << "read[MB/s]" << std::setw(11) << "read[ev/s]"
+            << std::setw(14) << "partial[ev/s]" << std::setw(14) << "partial[MB]"
+            << std::endl;
+
+  for(long c: compress){
+    for(long b: baskets){
+      for(long fl: flushes){
+        for(long s: splits){
+          const Layout l{(int)c, (int)b, fl, (int)s};
+          const Result r = Measure(cl, recs, l, tmpname, partial);
+          const double mb = r.tot_bytes / 1e6;
+          std::cout << std::setw(8) << c << std::setw(9) << b
+                    << std::setw(11) << fl << std::setw(6) << s
+                    << std::fixed << std::setprecision(2)
+                    << std::setw(12) << r.file_bytes / 1e6
+                    << std::setw(8) << double(r.tot_bytes) / r.file_bytes
+                    << std::setw(13) << mb / r.write_s
+                    << std::setw(12) << recs.size() / r.write_s
+                    << std::setw(12) << mb / r.full_read_s
+                    << std::setw(11) << recs.size() / r.full_read_s
+                    << std::setw(14) << recs.size() / r.partial_read_s
+                    << std::setw(14) << r.partial_bytes / 1e6
+                    << std::defaultfloat << std::endl;
+        }
+      }
+    }
+  }
+
+  for(void* obj: recs) cl->Destructor(obj);
+
+  return 0;
+}
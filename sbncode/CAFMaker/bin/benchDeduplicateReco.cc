@@ -0,0 +1,244 @@
+// Measures what the DeduplicateReco option of CAFMaker saves: rewrites the
+// records of a CAF made without it, once as they are and once with
+// rec.reco.trk/shw/stub emptied as CAFMaker leaves them with
+// DeduplicateReco, and reports the size of each recTree and the time spent
+// in TTree::Fill(). The deduplicated records must give back, through the
+// accessors of RecoAccess.h, the same tracks, showers and stubs as the
+// event-level lists of the original records, compared byte by byte as ROOT
+// streams them.
+//
+// Usage: benchDeduplicateReco input.caf.root [options]
+//   -n N        number of records to use (default 1000)
+//   -r N        number of times each layout is written, the best is kept (default 3)
+//   -o FILE     temporary output file (default benchDeduplicateReco.tmp.root)
+//
+// Returns 1 if a deduplicated record gives back a different object.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "TBufferFile.h"
+#include "TClass.h"
+#include "TError.h"
+#include "TFile.h"
+#include "TTree.h"
+
+#include "sbnanaobj/StandardRecord/StandardRecord.h"
+#include "sbncode/CAFMaker/RecoAccess.h"
+
+namespace
+{
+  using Clock = std::chrono::steady_clock;
+
+  double Seconds(const Clock::time_point& start)
+  {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+  }
+
+  struct Result
+  {
+    double fill_s;
+    long long zip_bytes;
+    long long tot_bytes;
+  };
+
+  // Writes the records as CAFMaker::WriteRecord does, into a file with
+  // CAFMaker's default settings
+  Result Measure(const std::vector<std::unique_ptr<caf::StandardRecord>>& recs,
+                 const std::string& tmpname)
+  {
+    Result res{0., 0, 0};
+    {
+      TFile fout(tmpname.c_str(), "RECREATE");
+      // owned, and deleted on Close(), by fout
+      TTree* tr = new TTree("recTree", "records");
+      caf::StandardRecord* prec = recs.front().get();
+      tr->Branch("rec", "caf::StandardRecord", &prec);
+      for(const auto& rec: recs){
+        prec = rec.get();
+        tr->SetBranchAddress("rec", &prec);
+        const auto start = Clock::now();
+        tr->Fill();
+        res.fill_s += Seconds(start);
+      }
+      tr->Write();
+      res.zip_bytes = tr->GetZipBytes();
+      res.tot_bytes = tr->GetTotBytes();
+      fout.Close();
+    }
+    std::remove(tmpname.c_str());
+    return res;
+  }
+
+  Result Best(const std::vector<std::unique_ptr<caf::StandardRecord>>& recs,
+              const std::string& tmpname, int nrepeat)
+  {
+    Result best{std::numeric_limits<double>::max(), 0, 0};
+    for(int i = 0; i < nrepeat; ++i){
+      const Result r = Measure(recs, tmpname);
+      if(r.fill_s < best.fill_s) best = r;
+    }
+    return best;
+  }
+
+  // The object as ROOT streams it, to compare objects without an operator==
+  template<class T>
+  std::string Bytes(const T& obj)
+  {
+    TBufferFile buf(TBuffer::kWrite);
+    TClass::GetClass(typeid(T))->Streamer(const_cast<T*>(&obj), buf);
+    return std::string(buf.Buffer(), buf.Length());
+  }
+
+  // Compares the event-level list of the original record to what the
+  // accessors give back from the deduplicated one
+  template<class T, class GetAt, class GetAll>
+  unsigned long Compare(const std::vector<T>& orig, const caf::StandardRecord& dedup,
+                        GetAt get_at, GetAll get_all, const char* name, long entry)
+  {
+    unsigned long nbad = 0;
+    try{
+      const std::vector<const T*> all = get_all(dedup);
+      if(all.size() != orig.size()){
+        std::cout << "Record " << entry << ": " << all.size() << " " << name
+                  << "s instead of " << orig.size() << std::endl;
+        return 1;
+      }
+      for(size_t i = 0; i < orig.size(); ++i){
+        const std::string bytes = Bytes(orig[i]);
+        if(Bytes(get_at(dedup, i)) != bytes || Bytes(*all[i]) != bytes){
+          if(++nbad <= 10) std::cout << "Record " << entry << ": " << name << " " << i << " differs" << std::endl;
+        }
+      }
+    }
+    catch(const std::exception& e){
+      std::cout << "Record " << entry << ": " << e.what() << std::endl;
+      ++nbad;
+    }
+    return nbad;
+  }
+}
+
+int main(int argc, char** argv)
+{
+  gErrorIgnoreLevel = kWarning;
+
+  if(argc < 2 || argv[1][0] == '-'){
+    std::cerr << "Usage: benchDeduplicateReco input.caf.root [-n N] [-r N] [-o FILE]" << std::endl;
+    exit(1);
+  }
+
+  const std::string filePath = argv[1];
+  long nmax = 1000;
+  int nrepeat = 3;
+  std::string tmpname = "benchDeduplicateReco.tmp.root";
+
+  for(int i = 2; i < argc; i += 2){
+    const std::string opt = argv[i];
+    if(i+1 >= argc){
+      std::cerr << "ERROR: Option " << opt << " needs a value" << std::endl;
+      exit(1);
+    }
+    const std::string val = argv[i+1];
+    if(opt == "-n") nmax = std::stol(val);
+    else if(opt == "-r") nrepeat = std::max(1, std::stoi(val));
+    else if(opt == "-o") tmpname = val;
+    else{
+      std::cerr << "ERROR: Unknown option " << opt << std::endl;
+      exit(1);
+    }
+  }
+
+  std::unique_ptr<TFile> f(TFile::Open(filePath.c_str(), "READ"));
+  if(!f || !f->IsOpen()){
+    std::cerr << "ERROR: Unable to open " << filePath
+              << " as a TFile, is this a proper ROOT file?" << std::endl;
+    exit(1);
+  }
+
+  TTree* tr = (TTree*)f->Get("recTree");
+  if(!tr || !tr->GetBranch("rec")){
+    std::cerr << "ERROR: Unable to access recTree in " << filePath
+              << " is this a proper CAF?" << std::endl;
+    exit(1);
+  }
+
+  std::vector<std::unique_ptr<caf::StandardRecord>> recs;
+  const long n = std::min(nmax, (long)tr->GetEntries());
+  recs.reserve(n);
+  for(long i = 0; i < n; ++i){
+    recs.push_back(std::make_unique<caf::StandardRecord>());
+    caf::StandardRecord* prec = recs.back().get();
+    tr->SetBranchAddress("rec", &prec);
+    tr->GetEntry(i);
+    if(caf::IsRecoDeduplicated(*prec)){
+      std::cerr << "ERROR: Record " << i << " of " << filePath
+                << " was written with DeduplicateReco" << std::endl;
+      exit(1);
+    }
+  }
+  tr->ResetBranchAddresses();
+  f.reset();
+
+  if(recs.empty()){
+    std::cerr << "ERROR: No records in " << filePath << std::endl;
+    exit(1);
+  }
+
+  // As CAFMaker fills them with DeduplicateReco: the counts stay, the
+  // event-level lists are left empty
+  std::vector<std::unique_ptr<caf::StandardRecord>> dedups;
+  dedups.reserve(recs.size());
+  for(const auto& rec: recs){
+    dedups.push_back(std::make_unique<caf::StandardRecord>(*rec));
+    dedups.back()->reco.trk.clear();
+    dedups.back()->reco.shw.clear();
+    dedups.back()->reco.stub.clear();
+  }
+
+  unsigned long nobjects = 0, nbad = 0;
+  for(size_t i = 0; i < recs.size(); ++i){
+    const caf::StandardRecord& orig = *recs[i];
+    const caf::StandardRecord& dedup = *dedups[i];
+    nobjects += orig.reco.trk.size() + orig.reco.shw.size() + orig.reco.stub.size();
+    nbad += Compare(orig.reco.trk, dedup, caf::GetTrack, caf::AllTracks, "track", i);
+    nbad += Compare(orig.reco.shw, dedup, caf::GetShower, caf::AllShowers, "shower", i);
+    nbad += Compare(orig.reco.stub, dedup, caf::GetStub, caf::AllStubs, "stub", i);
+  }
+
+  std::cout << "Read " << recs.size() << " records from " << filePath << std::endl;
+
+  const Result dup = Best(recs, tmpname, nrepeat);
+  const Result ded = Best(dedups, tmpname, nrepeat);
+
+  std::cout << std::setw(14) << "layout" << std::setw(12) << "zip[MB]"
+            << std::setw(12) << "tot[MB]" << std::setw(10) << "Fill[s]" << std::endl;
+  for(const auto& row: {std::make_pair("duplicated", dup), std::make_pair("deduplicated", ded)}){
+    std::cout << std::setw(14) << row.first << std::fixed << std::setprecision(2)
+              << std::setw(12) << row.second.zip_bytes / 1e6
+              << std::setw(12) << row.second.tot_bytes / 1e6
+              << std::setw(10) << row.second.fill_s << std::defaultfloat << std::endl;
+  }
+  std::cout << "DeduplicateReco saves " << std::fixed << std::setprecision(1)
+            << 100. * (1. - double(ded.zip_bytes) / dup.zip_bytes) << "% of the compressed size and "
+            << 100. * (1. - ded.fill_s / dup.fill_s) << "% of the Fill() time"
+            << std::defaultfloat << std::endl;
+
+  std::cout << "Compared " << nobjects << " tracks, showers and stubs, "
+            << nbad << " differ" << std::endl;
+  if(nbad > 0){
+    std::cout << "FAILED" << std::endl;
+    return 1;
+  }
+  std::cout << "OK" << std::endl;
+  return 0;
+}
@@ -0,0 +1,165 @@
+// Copies a list of events out of many CAF files into a new one, finding
+// them through the eventIndex tree that CAFMaker writes, so that only the
+// selected recTree entries are read.
+//
+// Usage: extractCAFEvents events.txt output.root input.caf.root [...]
+//   events.txt holds one "run subrun event" per line, '#' starts a comment
+//
+// The output has the selected records in recTree, in input file and then
+// entry order, its own eventIndex, and the globalTree of the first input
+// with any selected event. Inputs without an eventIndex (written before
+// it existed) are skipped with a warning.
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <set>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include <sys/stat.h>
+
+#include "TChain.h"
+#include "TError.h"
+#include "TFile.h"
+#include "TTree.h"
+
+#include "sbncode/CAFMaker/CAFEventIndex.h"
+
+namespace
+{
+  using EventID = std::tuple<unsigned, unsigned, unsigned>;
+
+  std::vector<EventID> ReadEventList(const std::string& fname)
+  {
+    std::ifstream in(fname);
+    if(!in){
+      std::cerr << "ERROR: Unable to open event list " << fname << std::endl;
+      exit(1);
+    }
+
+    std::vector<EventID> ret;
+    std::string line;
+    int lineno = 0;
+    while(std::getline(in, line)){
+      ++lineno;
+      line = line.substr(0, line.find('#'));
+      std::stringstream ss(line);
+      unsigned run, subrun, evt;
+      if(!(ss >> run)) continue; // blank line
+      if(!(ss >> subrun >> evt)){
+        std::cerr << "ERROR: " << fname << ":" << lineno
+                  << ": expected 'run subrun event'" << std::endl;
+        exit(1);
+      }
+      ret.emplace_back(run, subrun, evt);
+    }
+    return ret;
+  }
+}
+
+int main(int argc, char** argv)
+{
+  gErrorIgnoreLevel = kError;
+
+  if(argc < 4){
+    std::cerr << "Usage: extractCAFEvents events.txt output.root input.caf.root [...]" << std::endl;
+    exit(1);
+  }
+
+  const std::vector<EventID> events = ReadEventList(argv[1]);
+  const std::string outName = argv[2];
+  std::cout << "Looking for " << events.size() << " events" << std::endl;
+
+  // Look up the events in the index of each file first, so that the
+  // files with nothing selected are never read further
+  TChain chain("recTree");
+  std::vector<std::map<Long64_t, EventID>> entries; // per file in the chain
+  std::string firstFile;
+  std::set<EventID> found;
+  for(int i = 3; i < argc; ++i){
+    const std::string filePath = argv[i];
+
+    struct stat buf;
+    if(stat(filePath.c_str(), &buf) != 0 && filePath.find("://") == std::string::npos){
+      std::cerr << "ERROR: File does not exist: " << filePath << std::endl;
+      exit(1);
+    }
+
+    std::unique_ptr<TFile> f(TFile::Open(filePath.c_str(), "READ"));
+    if(!f || !f->IsOpen()){
+      std::cerr << "ERROR: Unable to open " << filePath
+                << " as a TFile, is this a proper ROOT file?" << std::endl;
+      exit(1);
+    }
+
+    caf::CAFEventIndex index;
+    if(!index.Read(f.get())){
+      std::cerr << "WARNING: No eventIndex in " << filePath << ", skipping it" << std::endl;
+      continue;
+    }
+
+    // each entry once, in file order
+    std::map<Long64_t, EventID> sel;
+    for(const EventID& id: events){
+      for(Long64_t e: index.Find(std::get<0>(id), std::get<1>(id), std::get<2>(id))){
+        sel.emplace(e, id);
+        found.insert(id);
+      }
+    }
+    if(sel.empty()) continue;
+
+    entries.push_back(std::move(sel));
+    chain.Add(filePath.c_str());
+    if(firstFile.empty()) firstFile = filePath;
+  }
+
+  std::cout << "Found " << found.size() << " of them in " << entries.size() << " files" << std::endl;
+  if(entries.empty()){
+    std::cerr << "ERROR: None of the events were found, no output written" << std::endl;
+    exit(1);
+  }
+
+  std::unique_ptr<TFile> fout(TFile::Open(outName.c_str(), "RECREATE"));
+  if(!fout || !fout->IsOpen()){
+    std::cerr << "ERROR: Unable to create " << outName << std::endl;
+    exit(1);
+  }
+
+  // The clone follows the chain across files
+  chain.GetEntries(); // fills the tree offsets
+  TTree* out = chain.CloneTree(0);
+  out->SetDirectory(fout.get());
+
+  caf::CAFEventIndex outIndex;
+  for(size_t ifile = 0; ifile < entries.size(); ++ifile){
+    for(const auto& sel: entries[ifile]){
+      chain.GetEntry(chain.GetTreeOffset()[ifile] + sel.first);
+      out->Fill();
+      outIndex.Add(std::get<0>(sel.second), std::get<1>(sel.second), std::get<2>(sel.second),
+                   out->GetEntries()-1);
+    }
+  }
+
+  fout->cd();
+  out->Write();
+  outIndex.Write(fout.get());
+
+  // The weight definitions, needed to read the weights back
+  std::unique_ptr<TFile> first(TFile::Open(firstFile.c_str(), "READ"));
+  TTree* global = first ? (TTree*)first->Get("globalTree") : nullptr;
+  if(global){
+    fout->cd();
+    TTree* globalOut = global->CloneTree(-1, "fast");
+    globalOut->Write();
+  }
+
+  std::cout << "Wrote " << out->GetEntries() << " records to " << outName << std::endl;
+  fout->Close();
+
+  return 0;
+}
@@ -62,6 +62,7 @@
 #include "larsim/MCCheater/ParticleInventoryService.h"
 
 #include "sbnobj/Common/Calibration/TrackCaloSkimmerObj.h"
+#include "sbncode/CAFMaker/FillTrue.h"
 #include "ITCSSelectionTool.h"
 
 namespace sbn {
@@ -141,8 +142,8 @@ private:
     const std::vector<art::Ptr<simb::MCParticle>> &mcparticles,
     const std::vector<geo::BoxBoundedGeo> &active_volumes,
     const std::vector<std::vector<geo::BoxBoundedGeo>> &tpc_volumes,
-    const std::map<int, std::vector<std::pair<geo::WireID, const sim::IDE*>>> id_to_ide_map,
-    const std::map<int, std::vector<art::Ptr<recob::Hit>>> id_to_truehit_map);
+    const caf::IDEIndex &id_to_ide_map,
+    const caf::TrueHitIndex &id_to_truehit_map);
 
   TrackHitInfo MakeHit(const recob::Hit &hit,
     unsigned hkey,
@@ -259,8 +259,8 @@ void sbn::TrackCaloSkimmer::analyze(art::Event const& e)
   // Prep truth-to-reco-matching info
   //
   // Use helper functions from CAFMaker/FillTrue
-  std::map<int, std::vector<std::pair<geo::WireID, const sim::IDE*>>> id_to_ide_map;
-  std::map<int, std::vector<art::Ptr<recob::Hit>>> id_to_truehit_map;
+  caf::IDEIndex id_to_ide_map;
+  caf::TrueHitIndex id_to_truehit_map;
   if (simchannels.size()) {
     art::ServiceHandle<cheat::BackTrackerService> bt_serv;
     id_to_ide_map = caf::PrepSimChannels(simchannels, *geometry);
@@ -408,14 +408,11 @@ sbn::Vector3D ConvertTVector(const TVector3 &tv) {
 sbn::TrueParticle TrueParticleInfo(const simb::MCParticle &particle,
     const std::vector<geo::BoxBoundedGeo> &active_volumes,
     const std::vector<std::vector<geo::BoxBoundedGeo>> &tpc_volumes,
-    const std::map<int, std::vector<std::pair<geo::WireID, const sim::IDE *>>> &id_to_ide_map,
-    const std::map<int, std::vector<art::Ptr<recob::Hit>>> &id_to_truehit_map) {
+    const caf::IDEIndex &id_to_ide_map,
+    const caf::TrueHitIndex &id_to_truehit_map) {
 
-  std::vector<std::pair<geo::WireID, const sim::IDE *>> empty;
-  const std::vector<std::pair<geo::WireID, const sim::IDE *>> &particle_ides = id_to_ide_map.count(particle.TrackId()) ? id_to_ide_map.at(particle.TrackId()) : empty;
-  
-  std::vector<art::Ptr<recob::Hit>> emptyHits;
-  const std::vector<art::Ptr<recob::Hit>> &particle_hits = id_to_truehit_map.count(particle.TrackId()) ? id_to_truehit_map.at(particle.TrackId()) : emptyHits;
+  const caf::IDEIndex::Range particle_ides = id_to_ide_map.Get(particle.TrackId());
+  const caf::TrueHitIndex::Range particle_hits = id_to_truehit_map.Get(particle.TrackId());
 
   sbn::TrueParticle trueparticle;
 
@@ -652,8 +649,8 @@ void sbn::TrackCaloSkimmer::FillTrackTruth(const detinfo::DetectorClocksData &cl
     const std::vector<art::Ptr<simb::MCParticle>> &mcparticles,
     const std::vector<geo::BoxBoundedGeo> &active_volumes,
     const std::vector<std::vector<geo::BoxBoundedGeo>> &tpc_volumes,
-    const std::map<int, std::vector<std::pair<geo::WireID, const sim::IDE*>>> id_to_ide_map,
-    const std::map<int, std::vector<art::Ptr<recob::Hit>>> id_to_truehit_map) {
+    const caf::IDEIndex &id_to_ide_map,
+    const caf::TrueHitIndex &id_to_truehit_map) {
 
   // Lookup the true-particle match -- use utils in CAF
   std::vector<std::pair<int, float>> matches = CAFRecoUtils::AllTrueParticleIDEnergyMatches(clock_data, trkHits, true);
@@ -43,7 +43,9 @@
 #include "TFile.h"
 #include "TH1.h"
 #include "TH2.h"
+#include "TRandom.h"
 
+#include "sbncode/FlashMatch/FlashPredictMetrics.h"
 #include "sbncode/OpT0Finder/flashmatch/Base/OpT0FinderTypes.h"
 #include "sbncode/OpDet/PDMapAlg.h"
 #include "sbnobj/Common/Reco/SimpleFlashMatchVars.h"
@@ -218,8 +220,6 @@ private:
     double flash_rr, double flash_ratio) const;
   std::tuple<double, double, double, double> hypoFlashX_H2(
     double flash_rr, double flash_ratio) const;
-  std::tuple<double, double> xEstimateAndRMS(
-    double metric_value, const TH2D* metric_h2) const;
   ChargeDigestMap makeChargeDigest(
     const art::Event& evt,
     const art::ValidHandle<std::vector<recob::PFParticle>>& pfps_h);
@@ -279,6 +279,7 @@ private:
   void updateBookKeeping();
   template <typename Stream>
   void printMetrics(const std::string metric,
+                    const unsigned xbin,
                     const ChargeMetrics& charge,
                     const FlashMetrics& flash,
                     const int pdgc,
@@ -340,7 +341,6 @@ private:
     double min, max;
     std::unique_ptr<TF1> f;
   };
-  TH2D* fRRH2; TH2D* fRatioH2;
   static constexpr unsigned kMinEntriesInProjection = 100;
   std::array<Fits, 3> fRRFits;
   std::array<Fits, 3> fRatioFits;
@@ -359,8 +359,8 @@ private:
   unsigned _slices = -1; unsigned _true_nus = -1;
   double _mcT0 = -9999.;
 
-  std::vector<double> fdYMeans, fdZMeans, fRRMeans, fRatioMeans;
-  std::vector<double> fdYSpreads, fdZSpreads, fRRSpreads, fRatioSpreads;
+  // read-only after loadMetrics(), can be shared
+  std::shared_ptr<const FlashPredictMetrics> fMetrics;
 
   static constexpr bool kNoScr = false;
   static constexpr double kNoScrTime = -9999.;
@@ -0,0 +1,299 @@
+#include "sbncode/FlashMatch/FlashPredictMetrics.h"
+
+#include "cetlib_except/exception.h"
+#include "messagefacility/MessageLogger/MessageLogger.h"
+
+#include "TFile.h"
+#include "TH1.h"
+#include "TH2.h"
+
+#include <cmath>
+#include <fstream>
+#include <memory>
+
+namespace {
+
+  const std::array<std::string, FlashPredictMetrics::kNProfiles> kProfileNames{
+    "dy_h1", "dz_h1", "rr_h1", "ratio_h1"};
+  const std::array<std::string, FlashPredictMetrics::kNMaps> kMapNames{
+    "rr_h2", "ratio_h2"};
+
+  template<typename T>
+  void writePOD(std::ofstream& out, const T& v)
+  {
+    out.write(reinterpret_cast<const char*>(&v), sizeof(T));
+  }
+
+  template<typename T>
+  void readPOD(std::ifstream& in, T& v)
+  {
+    in.read(reinterpret_cast<char*>(&v), sizeof(T));
+  }
+
+  void writeArray(std::ofstream& out, const std::vector<double>& v)
+  {
+    out.write(reinterpret_cast<const char*>(v.data()), v.size()*sizeof(double));
+  }
+
+  void readArray(std::ifstream& in, std::vector<double>& v, const size_t n)
+  {
+    v.resize(n);
+    in.read(reinterpret_cast<char*>(v.data()), n*sizeof(double));
+  }
+
+} // namespace
+
+
+void FlashPredictMetrics::Map2D::buildCumulative()
+{
+  const size_t row = nx + 2;
+  cumY.assign((ny + 3) * row, 0.);
+  for(size_t iy = 0; iy < ny + 2; ++iy){
+    for(size_t ix = 0; ix < row; ++ix){
+      cumY[(iy+1)*row + ix] = cumY[iy*row + ix] + contents[iy*row + ix];
+    }
+  }
+}
+
+
+FlashPredictMetrics FlashPredictMetrics::fromROOTFile(
+  const std::string& fname, const bool noAvailableMetrics)
+{
+  std::unique_ptr<TFile> infile(TFile::Open(fname.c_str(), "READ"));
+  if(!infile || infile->IsZombie()){
+    throw cet::exception("FlashPredictMetrics")
+      << "Could not open metrics file '" << fname << "'\n";
+  }
+  auto metricsInFile = infile->GetListOfKeys();
+  for(const auto& name : kProfileNames){
+    if(!metricsInFile->Contains(name.c_str())){
+      throw cet::exception("FlashPredictMetrics")
+        << "The metrics file '" << fname << "' lacks metric " << name << ".\n";
+    }
+  }
+  for(const auto& name : kMapNames){
+    if(!metricsInFile->Contains(name.c_str())){
+      throw cet::exception("FlashPredictMetrics")
+        << "The metrics file '" << fname << "' lacks metric " << name << ".\n";
+    }
+  }
+
+  FlashPredictMetrics metrics;
+  for(unsigned p = 0; p < kNProfiles; ++p){
+    TH1* h1 = (TH1*)infile->Get(kProfileNames[p].c_str());
+    const TAxis* axis = h1->GetXaxis();
+    if(axis->GetXbins()->GetSize() != 0){
+      throw cet::exception("FlashPredictMetrics")
+        << kProfileNames[p] << " in '" << fname << "' is not uniformly binned.\n";
+    }
+    Profile& prof = metrics.fProfiles[p];
+    const int bins = h1->GetNbinsX();
+    if(bins <= 0) continue; // handled by resetProfile() below
+    prof.nbins = bins;
+    prof.lo = axis->GetXmin();
+    prof.invWidth = bins / (axis->GetXmax() - axis->GetXmin());
+    prof.means.reserve(bins);
+    prof.spreads.reserve(bins);
+    for(int ib = 1; ib <= bins; ++ib){
+      prof.means.push_back(h1->GetBinContent(ib));
+      double tt = h1->GetBinError(ib);
+      if(tt <= 0){
+        mf::LogWarning("FlashPredictMetrics")
+          << "zero value for bin spread in " << kProfileNames[p] << "\n"
+          << "ib:\t" << ib << "\n"
+          << "GetBinContent(ib):\t" << h1->GetBinContent(ib) << "\n"
+          << "GetBinError(ib):\t" << h1->GetBinError(ib);
+        tt = 100.;
+      }
+      prof.spreads.push_back(tt);
+    }
+  }
+
+  for(unsigned m = 0; m < kNMaps; ++m){
+    TH2* h2 = (TH2*)infile->Get(kMapNames[m].c_str());
+    const TAxis* xaxis = h2->GetXaxis();
+    const TAxis* yaxis = h2->GetYaxis();
+    if(xaxis->GetXbins()->GetSize() != 0 || yaxis->GetXbins()->GetSize() != 0){
+      throw cet::exception("FlashPredictMetrics")
+        << kMapNames[m] << " in '" << fname << "' is not uniformly binned.\n";
+    }
+    Map2D& map = metrics.fMaps[m];
+    map.nx = h2->GetNbinsX();
+    map.ny = h2->GetNbinsY();
+    map.xlo = xaxis->GetXmin();
+    map.xWidth = (xaxis->GetXmax() - xaxis->GetXmin()) / map.nx;
+    map.ylo = yaxis->GetXmin();
+    map.invYWidth = map.ny / (yaxis->GetXmax() - yaxis->GetXmin());
+    const size_t row = map.nx + 2;
+    map.contents.resize((map.ny + 2) * row);
+    for(unsigned iy = 0; iy < map.ny + 2; ++iy){
+      for(unsigned ix = 0; ix < row; ++ix){
+        map.contents[iy*row + ix] = h2->GetBinContent(ix, iy);
+      }
+    }
+    map.buildCumulative();
+  }
+  infile->Close();
+
+  for(auto& prof : metrics.fProfiles){
+    if(prof.nbins == 0 || noAvailableMetrics) resetProfile(prof);
+  }
+  return metrics;
+}
+
+
+FlashPredictMetrics FlashPredictMetrics::fromBinaryFile(
+  const std::string& fname, const bool noAvailableMetrics)
+{
+  std::ifstream in(fname, std::ios::binary);
+  uint32_t magic = 0, version = 0;
+  readPOD(in, magic);
+  readPOD(in, version);
+  if(!in || magic != kMagic || version != kVersion){
+    throw cet::exception("FlashPredictMetrics")
+      << "'" << fname << "' is not a version " << kVersion
+      << " FlashPredict binary metrics file.\n";
+  }
+
+  FlashPredictMetrics metrics;
+  for(auto& prof : metrics.fProfiles){
+    uint32_t nbins = 0;
+    readPOD(in, nbins);
+    prof.nbins = nbins;
+    readPOD(in, prof.lo);
+    readPOD(in, prof.invWidth);
+    readArray(in, prof.means, nbins);
+    readArray(in, prof.spreads, nbins);
+  }
+  for(auto& map : metrics.fMaps){
+    uint32_t nx = 0, ny = 0;
+    readPOD(in, nx);
+    readPOD(in, ny);
+    map.nx = nx;
+    map.ny = ny;
+    readPOD(in, map.xlo);
+    readPOD(in, map.xWidth);
+    readPOD(in, map.ylo);
+    readPOD(in, map.invYWidth);
+    readArray(in, map.contents, size_t(nx + 2) * (ny + 2));
+    map.buildCumulative();
+  }
+  if(!in){
+    throw cet::exception("FlashPredictMetrics")
+      << "Binary metrics file '" << fname << "' is truncated.\n";
+  }
+
+  if(noAvailableMetrics){
+    for(auto& prof : metrics.fProfiles) resetProfile(prof);
+  }
+  return metrics;
+}
+
+
+bool FlashPredictMetrics::isBinaryFile(const std::string& fname)
+{
+  std::ifstream in(fname, std::ios::binary);
+  uint32_t magic = 0;
+  readPOD(in, magic);
+  return in && magic == kMagic;
+}
+
+
+// NOTE: the layout is native-endian, it is meant to be generated where
+// it is used, not to be distributed across architectures
+void FlashPredictMetrics::writeBinaryFile(const std::string& fname) const
+{
+  std::ofstream out(fname, std::ios::binary | std::ios::trunc);
+  writePOD(out, kMagic);
+  writePOD(out, kVersion);
+  for(const auto& prof : fProfiles){
+    writePOD(out, uint32_t(prof.nbins));
+    writePOD(out, prof.lo);
+    writePOD(out, prof.invWidth);
+    writeArray(out, prof.means);
+    writeArray(out, prof.spreads);
+  }
+  for(const auto& map : fMaps){
+    writePOD(out, uint32_t(map.nx));
+    writePOD(out, uint32_t(map.ny));
+    writePOD(out, map.xlo);
+    writePOD(out, map.xWidth);
+    writePOD(out, map.ylo);
+    writePOD(out, map.invYWidth);
+    writeArray(out, map.contents);
+  }
+  if(!out){
+    throw cet::exception("FlashPredictMetrics")
+      << "Failed writing binary metrics file '" << fname << "'\n";
+  }
+}
+
+
+std::tuple<double, double> FlashPredictMetrics::xEstimateAndRMS(
+  const EMap2D m, const double metricValue, const double u,
+  const double minRMS, const unsigned minEntries) const
+{
+  const Map2D& map = fMaps[m];
+  const size_t row = map.nx + 2;
+  const int bins = map.ny;
+  const int bin = map.yBin(metricValue);
+  int bin_buff = 0;
+  while(0 < bin-bin_buff || bin+bin_buff <= bins){
+    // same window as TH2::ProjectionX(name, low_bin, high_bin)
+    const int low_bin = (0 < bin-bin_buff) ? bin-bin_buff : 0;
+    const int high_bin = (bin+bin_buff <= bins) ? bin+bin_buff : bins+1;
+    const double* hi = &map.cumY[(high_bin+1)*row];
+    const double* lo = &map.cumY[low_bin*row];
+
+    double entries = hi[0] - lo[0] + hi[row-1] - lo[row-1];
+    double sumw = 0., sumwx = 0., sumwx2 = 0.;
+    for(unsigned ix = 1; ix <= map.nx; ++ix){
+      const double w = hi[ix] - lo[ix];
+      const double x = map.xCenter(ix);
+      entries += w;
+      sumw += w;
+      sumwx += w * x;
+      sumwx2 += w * x * x;
+    }
+    if(entries > minEntries){
+      if(sumw <= 0.) return {-1., 0.}; // only under/overflows
+      const double mean = sumwx / sumw;
+      const double rmsX = std::sqrt(std::abs(sumwx2 / sumw - mean * mean));
+      if(rmsX < minRMS){//something went wrong
+        mf::LogDebug("FlashPredictMetrics")
+          << "metric_h2 projected on metric_value: " << metricValue
+          << ", bin: " << bin
+          << ", bin_buff: " << bin_buff
+          << "; has " << entries << " entries."
+          << "\nmetric_rmsX: " << rmsX;
+        return {-1., 0.}; // no estimate
+      }
+      // inverse CDF sampling, as TH1::GetRandom()
+      const double target = u * sumw;
+      double running = 0.;
+      double hypoX = map.xlo + map.nx * map.xWidth;
+      for(unsigned ix = 1; ix <= map.nx; ++ix){
+        const double w = hi[ix] - lo[ix];
+        if(running + w > target){
+          hypoX = map.xlo + (ix - 1 + (target - running) / w) * map.xWidth;
+          break;
+        }
+        running += w;
+      }
+      return {hypoX, 1/(rmsX*rmsX)};
+    }
+    bin_buff += 1;
+  }
+  return {-1., 0.}; // no estimate
+}
+
+
+// single neutral bin, used when the metrics are not available
+void FlashPredictMetrics::resetProfile(Profile& prof)
+{
+  prof.nbins = 1;
+  prof.lo = 0.;
+  prof.invWidth = 0.;
+  prof.means.assign(1, 0.);
+  prof.spreads.assign(1, 0.001);
+}
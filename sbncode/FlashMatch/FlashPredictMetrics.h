@@ -0,0 +1,93 @@
+#ifndef SBN_FLASHMATCH_FLASHPREDICTMETRICS_H
+#define SBN_FLASHMATCH_FLASHPREDICTMETRICS_H
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <tuple>
+#include <vector>
+
+// Immutable store of the FlashPredict score metrics.
+//
+// Every metric is kept as a uniformly binned flat array with its inverse
+// bin width precomputed, so that scoring never touches ROOT histogram
+// objects and a single instance can be shared read-only across threads.
+// It can be built from the ROOT metrics file produced by
+// template_generators/generate_simple_weighted_template.py, or from the
+// binary dump written by writeBinaryFile() (see makeFlashPredictMetrics).
+class FlashPredictMetrics {
+public:
+  // Means and spreads of a metric as a function of the drift coordinate
+  struct Profile {
+    unsigned nbins = 0;
+    double lo = 0., invWidth = 0.;
+    std::vector<double> means, spreads;
+    // clamped to [0, nbins-1], no branches on the hot path
+    unsigned bin(const double x) const
+      {
+        const int b = static_cast<int>((x - lo) * invWidth);
+        return static_cast<unsigned>(std::clamp(b, 0, static_cast<int>(nbins) - 1));
+      }
+    double mean(const unsigned b) const { return means[b]; }
+    double spread(const unsigned b) const { return spreads[b]; }
+  };
+
+  // Uniform 2D map: X is the drift coordinate, Y the metric value. Under
+  // and overflows are kept, following ROOT's bin numbering, and the
+  // contents are stored as cumulative sums along Y so that a projection
+  // over any range of Y bins costs O(nx).
+  struct Map2D {
+    unsigned nx = 0, ny = 0;
+    double xlo = 0., xWidth = 0.;
+    double ylo = 0., invYWidth = 0.;
+    std::vector<double> contents; // (ny+2) rows of (nx+2) bins
+    std::vector<double> cumY;     // (ny+3) rows of (nx+2) bins
+    // ROOT convention: 0 underflow, ny+1 overflow
+    int yBin(const double v) const
+      {
+        const double b = 1. + std::floor((v - ylo) * invYWidth);
+        return static_cast<int>(std::clamp(b, 0., static_cast<double>(ny + 1)));
+      }
+    double xCenter(const unsigned ix) const { return xlo + (ix - 0.5) * xWidth; }
+    void buildCumulative();
+  };
+
+  enum EProfile { kDY = 0, kDZ, kRR, kRatio, kNProfiles };
+  enum EMap2D { kRRH2 = 0, kRatioH2, kNMaps };
+
+  FlashPredictMetrics() = default;
+
+  // Reads the dy_h1, dz_h1, rr_h1, ratio_h1, rr_h2 and ratio_h2 objects;
+  // with noAvailableMetrics the profiles are replaced by a single neutral bin
+  static FlashPredictMetrics fromROOTFile(const std::string& fname,
+                                          const bool noAvailableMetrics = false);
+  static FlashPredictMetrics fromBinaryFile(const std::string& fname,
+                                            const bool noAvailableMetrics = false);
+  static bool isBinaryFile(const std::string& fname);
+  void writeBinaryFile(const std::string& fname) const;
+
+  const Profile& profile(const EProfile p) const { return fProfiles[p]; }
+  const Map2D& map(const EMap2D m) const { return fMaps[m]; }
+
+  // Estimate of the drift coordinate and its weight (1/rms^2) from the X
+  // projection of the map around the Y bin of metricValue. The Y window is
+  // widened until the projection has more than minEntries entries. The
+  // estimate is drawn from the projection with the uniform deviate u, as
+  // TH1::GetRandom() does; {-1, 0} is returned when there is no estimate.
+  std::tuple<double, double> xEstimateAndRMS(
+    const EMap2D m, const double metricValue, const double u,
+    const double minRMS, const unsigned minEntries) const;
+
+private:
+  static void resetProfile(Profile& prof);
+
+  static constexpr uint32_t kMagic = 0x4d504c46; // "FLPM"
+  static constexpr uint32_t kVersion = 1;
+
+  std::array<Profile, kNProfiles> fProfiles;
+  std::array<Map2D, kNMaps> fMaps;
+};
+
+#endif //SBN_FLASHMATCH_FLASHPREDICTMETRICS_H
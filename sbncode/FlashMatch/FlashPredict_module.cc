@@ -374,7 +374,8 @@ void FlashPredict::produce(art::Event& evt)
       continue;
     }
     else if(!flash.metric_ok){
-      printMetrics("ERROR", charge, flash, pfpPDGC, tpcWithHits, 0, mf::LogError("FlashPredict"));
+      printMetrics("ERROR", fMetrics->profile(FlashPredictMetrics::kDY).bin(charge.x),
+                   charge, flash, pfpPDGC, tpcWithHits, 0, mf::LogError("FlashPredict"));
       bk.no_flash_pe++;
       mf::LogDebug("FlashPredict") << "Creating sFM and PFP-sFM association";
       sFM_v->emplace_back(sFM(kNoScr, kNoScrTime, Charge(kNoScrQ),
@@ -406,7 +407,8 @@ void FlashPredict::produce(art::Event& evt)
                                    << "\n_scr_z:     " << _scr_z
                                    << "\n_scr_rr:    " << _scr_rr
                                    << "\n_scr_ratio: " << _scr_ratio;
-      printMetrics("ERROR", charge, flash, pfpPDGC, tpcWithHits, 0, mf::LogError("FlashPredict"));
+      printMetrics("ERROR", fMetrics->profile(FlashPredictMetrics::kDY).bin(charge.x),
+                   charge, flash, pfpPDGC, tpcWithHits, 0, mf::LogError("FlashPredict"));
     }
 
   } // chargeDigestMap: PFparticles that pass criteria
@@ -461,8 +463,9 @@ void FlashPredict::initTree(void)
 
 void FlashPredict::loadMetrics()
 {
-  // TODO: fill histos with less repetition and range for loops
-  // read histograms and fill vectors for match score calculation
+  // The metrics used for scoring live in a flat FlashPredictMetrics
+  // store, either read from the ROOT metrics file or from its binary
+  // dump (see bin/makeFlashPredictMetrics.cc)
   std::string fname;
   cet::search_path sp("FW_SEARCH_PATH");
   if(!sp.find_file(fInputFilename, fname)) {
@@ -474,13 +477,20 @@ void FlashPredict::loadMetrics()
       << fInputFilename << "' on FW_SEARCH_PATH\n";
   }
   mf::LogInfo("FlashPredict") << "Opening file with metrics: " << fname;
+  if(FlashPredictMetrics::isBinaryFile(fname)) {
+    fMetrics = std::make_shared<const FlashPredictMetrics>(
+      FlashPredictMetrics::fromBinaryFile(fname, fNoAvailableMetrics));
+    // the TF1 fits are only kept in the ROOT file, hypoFlashX_fits()
+    // will not produce an estimate
+    mf::LogInfo("FlashPredict") << "Finish loading metrics";
+    return;
+  }
+  fMetrics = std::make_shared<const FlashPredictMetrics>(
+    FlashPredictMetrics::fromROOTFile(fname, fNoAvailableMetrics));
+
   TFile *infile = new TFile(fname.c_str(), "READ");
   auto metricsInFile = infile->GetListOfKeys();
-  if(!metricsInFile->Contains("dy_h1") ||
-     !metricsInFile->Contains("dz_h1") ||
-     !metricsInFile->Contains("rr_h1") ||
-     !metricsInFile->Contains("ratio_h1") ||
-     !metricsInFile->Contains("rr_fit_l") ||
+  if(!metricsInFile->Contains("rr_fit_l") ||
      !metricsInFile->Contains("rr_fit_m") ||
      !metricsInFile->Contains("rr_fit_h") ||
      !metricsInFile->Contains("ratio_fit_l") ||
@@ -492,75 +502,7 @@ void FlashPredict::loadMetrics()
     throw cet::exception("FlashPredict")
       << "The metrics file '" << fname << "'lacks at least one metric.";
   }
-  //
-  TH1 *temphisto = (TH1*)infile->Get("dy_h1");
-  int bins = temphisto->GetNbinsX();
-  if (bins <= 0 || fNoAvailableMetrics) {
-    std::cout << " problem with input histos for dy " << bins << " bins " << std::endl;
-    bins = 1;
-    fdYMeans.push_back(0);
-    fdYSpreads.push_back(0.001);
-  }
-  else {
-    for (int ib = 1; ib <= bins; ++ib) {
-      fdYMeans.push_back(temphisto->GetBinContent(ib));
-      double tt = temphisto->GetBinError(ib);
-      if (tt <= 0) {
-        std::cout << "zero value for bin spread in dy" << std::endl;
-        std::cout << "ib:\t" << ib << "\n";
-        std::cout << "temphisto->GetBinContent(ib):\t" << temphisto->GetBinContent(ib) << "\n";
-        std::cout << "temphisto->GetBinError(ib):\t" << temphisto->GetBinError(ib) << "\n";
-        tt = 100.;
-      }
-      fdYSpreads.push_back(tt);
-    }
-  }
-  //
-  temphisto = (TH1*)infile->Get("dz_h1");
-  bins = temphisto->GetNbinsX();
-  if (bins <= 0 || fNoAvailableMetrics) {
-    std::cout << " problem with input histos for dz " << bins << " bins " << std::endl;
-    bins = 1;
-    fdZMeans.push_back(0);
-    fdZSpreads.push_back(0.001);
-  }
-  else {
-    for (int ib = 1; ib <= bins; ++ib) {
-      fdZMeans.push_back(temphisto->GetBinContent(ib));
-      double tt = temphisto->GetBinError(ib);
-      if (tt <= 0) {
-        std::cout << "zero value for bin spread in dz" << std::endl;
-        std::cout << "ib:\t" << ib << "\n";
-        std::cout << "temphisto->GetBinContent(ib):\t" << temphisto->GetBinContent(ib) << "\n";
-        std::cout << "temphisto->GetBinError(ib):\t" << temphisto->GetBinError(ib) << "\n";
-        tt = 100.;
-      }
-      fdZSpreads.push_back(tt);
-    }
-  }
-  //
-  temphisto = (TH1*)infile->Get("rr_h1");
-  bins = temphisto->GetNbinsX();
-  if (bins <= 0 || fNoAvailableMetrics) {
-    std::cout << " problem with input histos for rr " << bins << " bins " << std::endl;
-    bins = 1;
-    fRRMeans.push_back(0);
-    fRRSpreads.push_back(0.001);
-  }
-  else {
-    for (int ib = 1; ib <= bins; ++ib) {
-      double me = temphisto->GetBinContent(ib);
-      fRRMeans.push_back(me);
-      double tt = temphisto->GetBinError(ib);
-      if (tt <= 0) {
-        std::cout << "zero value for bin spread in rr" << std::endl;
-        std::cout << "ib:\t" << ib << "\n";
-        std::cout << "temphisto->GetBinContent(ib):\t" << temphisto->GetBinContent(ib) << "\n";
-        std::cout << "temphisto->GetBinError(ib):\t" << temphisto->GetBinError(ib) << "\n";
-        tt = 100.;
-      }
-      fRRSpreads.push_back(tt);
-    }
+  if(!fNoAvailableMetrics) {
     unsigned s = 0;
     for(auto& rrF : fRRFits){
       std::string nold = "rr_fit_" + kSuffixes[s];
@@ -574,31 +516,7 @@ void FlashPredict::loadMetrics()
       rrF.max = rrF.f->GetMaximum(0., fDriftDistance, kEps);
       s++;
     }
-  }
-  //
-  temphisto = (TH1*)infile->Get("ratio_h1");
-  bins = temphisto->GetNbinsX();
-  if (bins <= 0 || fNoAvailableMetrics) {
-    std::cout << " problem with input histos for ratio " << bins << " bins " << std::endl;
-    bins = 1;
-    fRatioMeans.push_back(0);
-    fRatioSpreads.push_back(0.001);
-  }
-  else {
-    for (int ib = 1; ib <= bins; ++ib) {
-      double me = temphisto->GetBinContent(ib);
-      fRatioMeans.push_back(me);
-      double tt = temphisto->GetBinError(ib);
-      if (tt <= 0) {
-        std::cout << "zero value for bin spread in ratio" << std::endl;
-        std::cout << "ib:\t" << ib << "\n";
-        std::cout << "temphisto->GetBinContent(ib):\t" << temphisto->GetBinContent(ib) << "\n";
-        std::cout << "temphisto->GetBinError(ib):\t" << temphisto->GetBinError(ib) << "\n";
-        tt = 100.;
-      }
-      fRatioSpreads.push_back(tt);
-    }
-    unsigned s = 0;
+    s = 0;
     for(auto& ratioF : fRatioFits){
       std::string nold = "ratio_fit_" + kSuffixes[s];
       std::string nnew = "ratioFit_" + kSuffixes[s];
@@ -613,11 +531,6 @@ void FlashPredict::loadMetrics()
     }
   }
 
-  TH2* tmp1_h2 = (TH2*)infile->Get("rr_h2");
-  fRRH2 = (TH2D*)tmp1_h2->Clone("fRRH2");
-  TH2* tmp2_h2 = (TH2*)infile->Get("ratio_h2");
-  fRatioH2 = (TH2D*)tmp2_h2->Clone("fRatioH2");
-
   infile->Close();
   delete infile;
   mf::LogInfo("FlashPredict") << "Finish loading metrics";
@@ -800,24 +713,32 @@ FlashPredict::Score FlashPredict::computeScore(
 {
   double score = 0.;
   unsigned tcount = 0;
-  int xbin = static_cast<int>(fXBins * (charge.x / fDriftDistance));
+  using M = FlashPredictMetrics;
+  const M::Profile& dy = fMetrics->profile(M::kDY);
+  const M::Profile& dz = fMetrics->profile(M::kDZ);
+  const M::Profile& rr = fMetrics->profile(M::kRR);
+  const M::Profile& ratio = fMetrics->profile(M::kRatio);
   auto out = mf::LogWarning("FlashPredict");
 
-  double scr_y = scoreTerm(flash.y, charge.y, fdYMeans[xbin], fdYSpreads[xbin]);
-  if(scr_y > fTermThreshold) printMetrics("Y", charge, flash, pdgc, tpcWithHits, scr_y, out);
+  unsigned xbin = dy.bin(charge.x);
+  double scr_y = scoreTerm(flash.y, charge.y, dy.mean(xbin), dy.spread(xbin));
+  if(scr_y > fTermThreshold) printMetrics("Y", xbin, charge, flash, pdgc, tpcWithHits, scr_y, out);
   score += scr_y;
   tcount++;
-  double scr_z = scoreTerm(flash.z, charge.z, fdZMeans[xbin], fdZSpreads[xbin]);
-  if(scr_z > fTermThreshold) printMetrics("Z", charge, flash, pdgc, tpcWithHits, scr_z, out);
+  xbin = dz.bin(charge.x);
+  double scr_z = scoreTerm(flash.z, charge.z, dz.mean(xbin), dz.spread(xbin));
+  if(scr_z > fTermThreshold) printMetrics("Z", xbin, charge, flash, pdgc, tpcWithHits, scr_z, out);
   score += scr_z;
   tcount++;
-  double scr_rr = scoreTerm(flash.rr, fRRMeans[xbin], fRRSpreads[xbin]);
-  if(scr_rr > fTermThreshold) printMetrics("RR", charge, flash, pdgc, tpcWithHits, scr_rr, out);
+  xbin = rr.bin(charge.x);
+  double scr_rr = scoreTerm(flash.rr, rr.mean(xbin), rr.spread(xbin));
+  if(scr_rr > fTermThreshold) printMetrics("RR", xbin, charge, flash, pdgc, tpcWithHits, scr_rr, out);
   score += scr_rr;
   tcount++;
   double scr_ratio = 0.;
   if(fUseUncoatedPMT || fUseOppVolMetric) {
-    scr_ratio = scoreTerm(flash.ratio, fRatioMeans[xbin], fRatioSpreads[xbin]);
+    xbin = ratio.bin(charge.x);
+    scr_ratio = scoreTerm(flash.ratio, ratio.mean(xbin), ratio.spread(xbin));
     if(fICARUS && !std::isnan(flash.h_x)){
       // HACK to penalise matches with flash and charge on opposite volumes
       double x_gl_diff = std::abs(flash.x_gl-charge.x_gl);
@@ -825,9 +746,9 @@ FlashPredict::Score FlashPredict::computeScore(
       double cathode_tolerance = 40.;
       if(x_gl_diff > x_diff + cathode_tolerance) // ok if close to the cathode
         scr_ratio += scoreTerm((flash.pe-flash.unpe)/flash.pe,
-                               fRatioMeans[xbin], fRatioSpreads[xbin]);
+                               ratio.mean(xbin), ratio.spread(xbin));
     }
-    if(scr_ratio > fTermThreshold) printMetrics("RATIO", charge, flash, pdgc, tpcWithHits, scr_ratio, out);
+    if(scr_ratio > fTermThreshold) printMetrics("RATIO", xbin, charge, flash, pdgc, tpcWithHits, scr_ratio, out);
     score += scr_ratio;
     tcount++;
   }
@@ -843,6 +764,7 @@ std::tuple<double, double, double, double> FlashPredict::hypoFlashX_fits(
   std::vector<double> rrXs;
   double rr_hypoX, rr_hypoXWgt;
   for(const auto& rrF : fRRFits){
+    if(!rrF.f) continue; // not available from binary metrics
     if(rrF.min < flash_rr && flash_rr < rrF.max){
       try{
         rrXs.emplace_back(rrF.f->GetX(flash_rr, 0., fDriftDistance, kEps));
@@ -882,6 +804,7 @@ std::tuple<double, double, double, double> FlashPredict::hypoFlashX_fits(
   std::vector<double> ratioXs;
   double ratio_hypoX, ratio_hypoXWgt;
   for(const auto& ratioF : fRatioFits){
+    if(!ratioF.f) continue; // not available from binary metrics
     if(ratioF.min < flash_ratio && flash_ratio < ratioF.max){
       try{
         ratioXs.emplace_back(ratioF.f->GetX(flash_ratio, 0., fDriftDistance, kEps));
@@ -926,8 +849,13 @@ std::tuple<double, double, double, double> FlashPredict::hypoFlashX_fits(
 std::tuple<double, double, double, double> FlashPredict::hypoFlashX_H2(
   double flash_rr, double flash_ratio) const
 {
-  auto[rr_hypoX, rr_hypoXWgt] = xEstimateAndRMS(flash_rr, fRRH2);
-  auto[ratio_hypoX, ratio_hypoXWgt] = xEstimateAndRMS(flash_ratio, fRatioH2);
+  using M = FlashPredictMetrics;
+  auto[rr_hypoX, rr_hypoXWgt] =
+    fMetrics->xEstimateAndRMS(M::kRRH2, flash_rr, gRandom->Rndm(),
+                              fXBinWidth, kMinEntriesInProjection);
+  auto[ratio_hypoX, ratio_hypoXWgt] =
+    fMetrics->xEstimateAndRMS(M::kRatioH2, flash_ratio, gRandom->Rndm(),
+                              fXBinWidth, kMinEntriesInProjection);
 
   double sum_weights = rr_hypoXWgt + ratio_hypoXWgt;
   double hypo_x =
@@ -937,41 +865,6 @@ std::tuple<double, double, double, double> FlashPredict::hypoFlashX_H2(
 }
 
 
-std::tuple<double, double> FlashPredict::xEstimateAndRMS(
-  double metric_value, const TH2D* metric_h2) const
-{
-  int bin = metric_h2->GetYaxis()->FindBin(metric_value);
-  int bins = metric_h2->GetNbinsY();
-  double metric_hypoX = -1.;
-  double metric_hypoXWgt = 0.;
-  int bin_buff = 0;
-  while(0 < bin-bin_buff || bin+bin_buff <= bins){
-    int low_bin = (0 < bin-bin_buff) ? bin-bin_buff : 0;
-    int high_bin = (bin+bin_buff <= bins) ? bin+bin_buff : -1;
-    TH1D* metric_px = metric_h2->ProjectionX("metric_px", low_bin, high_bin);
-    if(metric_px->GetEntries() > kMinEntriesInProjection){
-      metric_hypoX = metric_px->GetRandom();
-      // metric_hypoX = metric_px->GetMean(); TODO: which one is more justified?
-      double metric_rmsX = metric_px->GetRMS();
-      if(metric_rmsX < fXBinWidth){//something went wrong
-        mf::LogDebug("FlashPredict")
-          << "metric_h2 projected on metric_value: "<< metric_value
-          << ", bin: " << bin
-          << ", bin_buff: " << bin_buff
-          << "; has " << metric_px->GetEntries() << " entries."
-          << "\nmetric_hypoX: " << metric_hypoX
-          << ",  metric_rmsX: " << metric_rmsX;
-        return {-1., 0.}; // no estimate
-      }
-      metric_hypoXWgt = 1/(metric_rmsX*metric_rmsX);
-      return {metric_hypoX, metric_hypoXWgt};
-    }
-    bin_buff += 1;
-  }
-  return {-1., 0.}; // no estimate
-}
-
-
 FlashPredict::ChargeDigestMap FlashPredict::makeChargeDigest(
   const art::Event& evt,
   const art::ValidHandle<std::vector<recob::PFParticle>>& pfps_h)
@@ -1608,6 +1501,7 @@ void FlashPredict::updateBookKeeping()
 
 template <typename Stream>
 void FlashPredict::printMetrics(const std::string metric,
+                                const unsigned xbin,
                                 const ChargeMetrics& charge,
                                 const FlashMetrics& flash,
                                 const int pdgc,
@@ -1615,7 +1509,6 @@ void FlashPredict::printMetrics(const std::string metric,
                                 const double term,
                                 Stream&& out) const
 {
-  int xbin = static_cast<int>(fXBins * (_charge_x / fDriftDistance));
   std::string tpcs;
   for(auto itpc: tpcWithHits) tpcs += std::to_string(itpc) + ' ';
   out
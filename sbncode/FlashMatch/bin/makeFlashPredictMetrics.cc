@@ -0,0 +1,38 @@
+// Dumps the score metrics of a FlashPredict ROOT metrics file into the
+// flat binary format read by FlashPredictMetrics::fromBinaryFile()
+
+#include <iostream>
+#include <string>
+
+#include "cetlib_except/exception.h"
+
+#include "TError.h"
+
+#include "sbncode/FlashMatch/FlashPredictMetrics.h"
+
+int main(int argc, char** argv)
+{
+  gErrorIgnoreLevel = 100000;
+
+  if(argc != 3){
+    std::cerr << "Usage: makeFlashPredictMetrics metrics.root metrics.bin" << std::endl;
+    exit(1);
+  }
+
+  const std::string inPath = argv[1];
+  const std::string outPath = argv[2];
+
+  try{
+    const FlashPredictMetrics metrics = FlashPredictMetrics::fromROOTFile(inPath);
+    metrics.writeBinaryFile(outPath);
+    // read it back, so a broken dump is caught here and not in the job
+    FlashPredictMetrics::fromBinaryFile(outPath);
+  }
+  catch(const cet::exception& e){
+    std::cerr << "ERROR: " << e.what() << std::endl;
+    exit(1);
+  }
+
+  std::cout << "Wrote " << outPath << std::endl;
+  return 0;
+}
@@ -0,0 +1,210 @@
+////////////////////////////////////////////////////////////////////////
+// Class:       FitterSampleDumper
+// Plugin Type: analyzer (art v3_06_03)
+// File:        FitterSampleDumper_module.cc
+//
+// Writes the inputs of the LArRecoProducer fitters to flat trees: the
+// trajectory and the calorimetry of the tracks, and the space points of
+// the showers. The benchLArRecoFitters executable runs the fitters on
+// them outside of art.
+////////////////////////////////////////////////////////////////////////
+
+#include "art/Framework/Core/EDAnalyzer.h"
+#include "art/Framework/Core/ModuleMacros.h"
+#include "art/Framework/Principal/Event.h"
+#include "art/Framework/Principal/Handle.h"
+#include "art/Framework/Services/Registry/ServiceHandle.h"
+#include "art_root_io/TFileService.h"
+#include "canvas/Persistency/Common/FindManyP.h"
+#include "canvas/Utilities/InputTag.h"
+#include "cetlib_except/exception.h"
+#include "fhiclcpp/ParameterSet.h"
+
+#include "lardataobj/AnalysisBase/Calorimetry.h"
+#include "lardataobj/RecoBase/Shower.h"
+#include "lardataobj/RecoBase/SpacePoint.h"
+#include "lardataobj/RecoBase/Track.h"
+
+#include "TTree.h"
+#include "TVector3.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace sbn {
+class FitterSampleDumper : public art::EDAnalyzer {
+  public:
+  explicit FitterSampleDumper(fhicl::ParameterSet const& p);
+  // The compiler-generated destructor is fine for non-base
+  // classes without bare pointers or other resource use.
+
+  // Plugins should not be copied or assigned.
+  FitterSampleDumper(FitterSampleDumper const&) = delete;
+  FitterSampleDumper(FitterSampleDumper&&) = delete;
+  FitterSampleDumper& operator=(FitterSampleDumper const&) = delete;
+  FitterSampleDumper& operator=(FitterSampleDumper&&) = delete;
+
+  // Required functions.
+  void analyze(art::Event const& e) override;
+
+  private:
+  const art::InputTag fTrackLabel, fCaloLabel, fShowerLabel;
+
+  TTree* fTrackTree;
+  TTree* fShowerTree;
+
+  // Branches of both trees
+  unsigned int fRun, fSubRun, fEvent;
+  int fID;
+
+  // Track branches: the valid points of the trajectory, and the
+  // calorimetry of the plane with the most hits
+  float fTrackLength;
+  bool fHasMomenta;
+  std::vector<double> fX, fY, fZ, fPx, fPy, fPz;
+  std::vector<float> fResRange, fdEdx;
+
+  // Shower branches
+  double fStart[3], fDir[3];
+  double fShowerLength, fOpenAngle;
+  std::vector<double> fSpX, fSpY, fSpZ;
+
+  void DumpTrack(const recob::Track& track, const std::vector<art::Ptr<anab::Calorimetry>>& caloVec);
+  void DumpShower(const recob::Shower& shower, const std::vector<art::Ptr<recob::SpacePoint>>& sps);
+};
+
+FitterSampleDumper::FitterSampleDumper(fhicl::ParameterSet const& p)
+    : EDAnalyzer { p }
+    , fTrackLabel(p.get<std::string>("TrackLabel"))
+    , fCaloLabel(p.get<std::string>("CaloLabel"))
+    , fShowerLabel(p.get<std::string>("ShowerLabel"))
+{
+  art::ServiceHandle<art::TFileService> tfs;
+
+  fTrackTree = tfs->make<TTree>("tracks", "Inputs of the track fitters");
+  fTrackTree->Branch("run", &fRun);
+  fTrackTree->Branch("subrun", &fSubRun);
+  fTrackTree->Branch("event", &fEvent);
+  fTrackTree->Branch("id", &fID);
+  fTrackTree->Branch("length", &fTrackLength);
+  fTrackTree->Branch("hasMomenta", &fHasMomenta);
+  fTrackTree->Branch("x", &fX);
+  fTrackTree->Branch("y", &fY);
+  fTrackTree->Branch("z", &fZ);
+  fTrackTree->Branch("px", &fPx);
+  fTrackTree->Branch("py", &fPy);
+  fTrackTree->Branch("pz", &fPz);
+  fTrackTree->Branch("resRange", &fResRange);
+  fTrackTree->Branch("dEdx", &fdEdx);
+
+  fShowerTree = tfs->make<TTree>("showers", "Inputs of the shower density fitter");
+  fShowerTree->Branch("run", &fRun);
+  fShowerTree->Branch("subrun", &fSubRun);
+  fShowerTree->Branch("event", &fEvent);
+  fShowerTree->Branch("id", &fID);
+  fShowerTree->Branch("start", fStart, "start[3]/D");
+  fShowerTree->Branch("dir", fDir, "dir[3]/D");
+  fShowerTree->Branch("length", &fShowerLength);
+  fShowerTree->Branch("openAngle", &fOpenAngle);
+  fShowerTree->Branch("spX", &fSpX);
+  fShowerTree->Branch("spY", &fSpY);
+  fShowerTree->Branch("spZ", &fSpZ);
+}
+
+void FitterSampleDumper::analyze(art::Event const& e)
+{
+  fRun = e.run();
+  fSubRun = e.subRun();
+  fEvent = e.event();
+
+  auto const trackHandle(e.getValidHandle<std::vector<recob::Track>>(fTrackLabel));
+  art::FindManyP<anab::Calorimetry> fmTrackCalo(trackHandle, e, fCaloLabel);
+
+  for (size_t i = 0; i < trackHandle->size(); i++)
+    this->DumpTrack(trackHandle->at(i), fmTrackCalo.isValid() ? fmTrackCalo.at(i) : std::vector<art::Ptr<anab::Calorimetry>>());
+
+  auto const showerHandle(e.getValidHandle<std::vector<recob::Shower>>(fShowerLabel));
+  art::FindManyP<recob::SpacePoint> fmShowerSP(showerHandle, e, fShowerLabel);
+  if (!fmShowerSP.isValid())
+    throw cet::exception("FitterSampleDumper") << "Shower-SP association is somehow not valid. Stopping";
+
+  for (size_t i = 0; i < showerHandle->size(); i++)
+    this->DumpShower(showerHandle->at(i), fmShowerSP.at(i));
+}
+
+void FitterSampleDumper::DumpTrack(const recob::Track& track, const std::vector<art::Ptr<anab::Calorimetry>>& caloVec)
+{
+  fX.clear();
+  fY.clear();
+  fZ.clear();
+  fPx.clear();
+  fPy.clear();
+  fPz.clear();
+
+  // The fitters skip the invalid points, so leaving them out gives them
+  // the same trajectory
+  for (size_t i = track.FirstValidPoint(); i != recob::TrackTrajectory::InvalidIndex; i = track.NextValidPoint(i + 1)) {
+    const auto& pos(track.LocationAtPoint(i));
+    const auto& mom(track.MomentumVectorAtPoint(i));
+    fX.push_back(pos.X());
+    fY.push_back(pos.Y());
+    fZ.push_back(pos.Z());
+    fPx.push_back(mom.X());
+    fPy.push_back(mom.Y());
+    fPz.push_back(mom.Z());
+  }
+
+  // A trajectory needs at least two points
+  if (fX.size() < 2)
+    return;
+
+  fID = track.ID();
+  fTrackLength = track.Length();
+  fHasMomenta = track.HasMomentum();
+
+  // The plane with the most hits, as in TrackStoppingChi2Fitter: prefer
+  // collection > 1st induction > 2nd induction if several have as many
+  fResRange.clear();
+  fdEdx.clear();
+  if (caloVec.size() == 3) {
+    const size_t maxHits(std::max({ caloVec[0]->dEdx().size(), caloVec[1]->dEdx().size(), caloVec[2]->dEdx().size() }));
+    const size_t bestPlane((caloVec[2]->dEdx().size() == maxHits) ? 2 : (caloVec[0]->dEdx().size() == maxHits) ? 0 : 1);
+    fResRange = caloVec[bestPlane]->ResidualRange();
+    fdEdx = caloVec[bestPlane]->dEdx();
+  }
+
+  fTrackTree->Fill();
+}
+
+void FitterSampleDumper::DumpShower(const recob::Shower& shower, const std::vector<art::Ptr<recob::SpacePoint>>& sps)
+{
+  if (!shower.has_length() || !shower.has_open_angle() || sps.empty())
+    return;
+
+  fID = shower.ID();
+  const TVector3& start(shower.ShowerStart());
+  const TVector3& dir(shower.Direction());
+  fStart[0] = start.X();
+  fStart[1] = start.Y();
+  fStart[2] = start.Z();
+  fDir[0] = dir.X();
+  fDir[1] = dir.Y();
+  fDir[2] = dir.Z();
+  fShowerLength = shower.Length();
+  fOpenAngle = shower.OpenAngle();
+
+  fSpX.clear();
+  fSpY.clear();
+  fSpZ.clear();
+  for (auto const& sp : sps) {
+    const Double32_t* xyz(sp->XYZ());
+    fSpX.push_back(xyz[0]);
+    fSpY.push_back(xyz[1]);
+    fSpZ.push_back(xyz[2]);
+  }
+
+  fShowerTree->Fill();
+}
+}
+
+DEFINE_ART_MODULE(sbn::FitterSampleDumper)
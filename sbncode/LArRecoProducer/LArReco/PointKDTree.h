@@ -0,0 +1,103 @@
+/// \file  PointKDTree.h
+//
+// Static k-d tree over 3D points, for nearest neighbour queries.
+
+#ifndef PointKDTree_H
+#define PointKDTree_H
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+namespace sbn {
+
+  /// Built once over a set of points, then answers nearest-neighbour
+  /// queries in O(log n) on average instead of a scan over all points.
+  ///
+  /// The tree is stored implicitly: the points are reordered so that the
+  /// node of a range [begin, end) is its middle point, with the points of
+  /// the left subtree before it and those of the right subtree after it.
+  class PointKDTree {
+  public:
+    using Point = std::array<double, 3>;
+
+    PointKDTree() = default;
+
+    explicit PointKDTree(std::vector<Point> points)
+      : fPoints(std::move(points))
+      , fSplit(fPoints.size(), 0)
+    {
+      Build(0, fPoints.size());
+    }
+
+    size_t size() const { return fPoints.size(); }
+    bool empty() const { return fPoints.empty(); }
+
+    /// Squared distance from \a q to the nearest point, computed as
+    /// dx*dx + dy*dy + dz*dz; the largest double if the tree is empty
+    double NearestDist2(const Point& q) const
+    {
+      double best = std::numeric_limits<double>::max();
+      Nearest(q, 0, fPoints.size(), best);
+      return best;
+    }
+
+  private:
+    void Build(size_t begin, size_t end)
+    {
+      if (end - begin < 2) return;
+
+      // split along the largest extent of the range
+      Point lo = fPoints[begin], hi = fPoints[begin];
+      for (size_t i = begin + 1; i < end; i++) {
+        for (unsigned d = 0; d < 3; d++) {
+          lo[d] = std::min(lo[d], fPoints[i][d]);
+          hi[d] = std::max(hi[d], fPoints[i][d]);
+        }
+      }
+      unsigned dim = 0;
+      for (unsigned d = 1; d < 3; d++)
+        if (hi[d] - lo[d] > hi[dim] - lo[dim]) dim = d;
+
+      const size_t mid = begin + (end - begin) / 2;
+      std::nth_element(fPoints.begin() + begin, fPoints.begin() + mid, fPoints.begin() + end,
+                       [dim](const Point& a, const Point& b) { return a[dim] < b[dim]; });
+      fSplit[mid] = dim;
+
+      Build(begin, mid);
+      Build(mid + 1, end);
+    }
+
+    void Nearest(const Point& q, size_t begin, size_t end, double& best) const
+    {
+      if (begin >= end) return;
+
+      const size_t mid = begin + (end - begin) / 2;
+      const Point& p = fPoints[mid];
+      const double dx = q[0] - p[0], dy = q[1] - p[1], dz = q[2] - p[2];
+      best = std::min(best, dx * dx + dy * dy + dz * dz);
+      if (end - begin == 1) return;
+
+      // the side of the splitting plane where q is first, the other side
+      // only if it can hold a point closer than the best so far
+      const unsigned dim = fSplit[mid];
+      const double delta = q[dim] - p[dim];
+      if (delta < 0) {
+        Nearest(q, begin, mid, best);
+        if (delta * delta <= best) Nearest(q, mid + 1, end, best);
+      }
+      else {
+        Nearest(q, mid + 1, end, best);
+        if (delta * delta <= best) Nearest(q, begin, mid, best);
+      }
+    }
+
+    std::vector<Point> fPoints;
+    std::vector<unsigned char> fSplit; ///< splitting dimension of each node
+  };
+
+} // namespace sbn
+
+#endif // PointKDTree_H
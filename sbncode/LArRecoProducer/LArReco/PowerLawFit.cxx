@@ -0,0 +1,138 @@
+/// \file  PowerLawFit.cxx
+
+#include "PowerLawFit.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+  constexpr int kMaxIterations = 100;
+  constexpr double kRelTolerance = 1e-12;
+  constexpr double kMaxLambda = 1e10;
+
+  double PowerLawChi2(const double* x, const double* y, size_t n, double norm, double power)
+  {
+    double chi2 = 0.;
+    for (size_t i = 0; i < n; i++) {
+      if (!(x[i] > 0.)) continue;
+      const double r = y[i] - norm * std::pow(x[i], -power);
+      chi2 += r * r;
+    }
+    return chi2;
+  }
+
+} // namespace
+
+namespace sbn {
+
+  PowerLawFitResult FitPowerLaw(const double* x, const double* y, size_t n,
+                                double minNorm, double maxNorm,
+                                double minPower, double maxPower)
+  {
+    PowerLawFitResult res;
+
+    // Starting point: log(y) = log(norm) - power*log(x)
+    size_t nfit = 0, npos = 0;
+    double sx = 0., sl = 0., sxx = 0., sxl = 0.;
+    for (size_t i = 0; i < n; i++) {
+      if (!(x[i] > 0.)) continue;
+      nfit++;
+      if (!(y[i] > 0.)) continue;
+      npos++;
+      const double lx = std::log(x[i]);
+      const double ly = std::log(y[i]);
+      sx += lx;
+      sl += ly;
+      sxx += lx * lx;
+      sxl += lx * ly;
+    }
+    if (nfit < 2) return res;
+
+    double norm = 0.5 * (minNorm + maxNorm);
+    double power = 0.5 * (minPower + maxPower);
+    const double det = npos * sxx - sx * sx;
+    if (npos >= 2 && det > 0.) {
+      const double slope = (npos * sxl - sx * sl) / det;
+      power = -slope;
+      norm = std::exp((sl - slope * sx) / npos);
+    }
+    norm = std::clamp(norm, minNorm, maxNorm);
+    power = std::clamp(power, minPower, maxPower);
+
+    double chi2 = PowerLawChi2(x, y, n, norm, power);
+    if (!std::isfinite(chi2)) return res;
+
+    // Levenberg-Marquardt, f = norm * x^-power
+    double lambda = 1e-3;
+    int it = 0;
+    for (; it < kMaxIterations && chi2 > 0.; it++) {
+      // J^T J and J^T r, with J the derivatives of f
+      double jnn = 0., jnp = 0., jpp = 0., gn = 0., gp = 0.;
+      for (size_t i = 0; i < n; i++) {
+        if (!(x[i] > 0.)) continue;
+        const double u = std::pow(x[i], -power);
+        const double dn = u;
+        const double dp = -norm * std::log(x[i]) * u;
+        const double r = y[i] - norm * u;
+        jnn += dn * dn;
+        jnp += dn * dp;
+        jpp += dp * dp;
+        gn += dn * r;
+        gp += dp * r;
+      }
+
+      // Hold a parameter at its limit if chi2 decreases beyond it
+      const bool holdNorm = (norm <= minNorm && gn < 0.) || (norm >= maxNorm && gn > 0.);
+      const bool holdPower = (power <= minPower && gp < 0.) || (power >= maxPower && gp > 0.);
+      if (holdNorm && holdPower) break;
+
+      bool stepped = false;
+      double newChi2 = chi2;
+      for (; lambda < kMaxLambda; lambda *= 10.) {
+        const double mnn = jnn * (1. + lambda);
+        const double mpp = jpp * (1. + lambda);
+        double dnorm = 0., dpower = 0.;
+        if (holdNorm) {
+          if (!(mpp > 0.)) continue;
+          dpower = gp / mpp;
+        }
+        else if (holdPower) {
+          if (!(mnn > 0.)) continue;
+          dnorm = gn / mnn;
+        }
+        else {
+          const double d = mnn * mpp - jnp * jnp;
+          if (!(d > 0.)) continue;
+          dnorm = (gn * mpp - gp * jnp) / d;
+          dpower = (mnn * gp - jnp * gn) / d;
+        }
+
+        const double newNorm = std::clamp(norm + dnorm, minNorm, maxNorm);
+        const double newPower = std::clamp(power + dpower, minPower, maxPower);
+        newChi2 = PowerLawChi2(x, y, n, newNorm, newPower);
+        if (std::isfinite(newChi2) && newChi2 <= chi2) {
+          norm = newNorm;
+          power = newPower;
+          stepped = true;
+          break;
+        }
+      }
+      // no step lowers chi2 any more: at the minimum
+      if (!stepped) break;
+
+      const bool converged = (chi2 - newChi2) <= kRelTolerance * chi2;
+      chi2 = newChi2;
+      lambda = std::max(lambda / 10., 1e-12);
+      if (converged) break;
+    }
+
+    res.norm = norm;
+    res.power = power;
+    res.chi2 = chi2;
+    res.iterations = it;
+    res.valid = true;
+    return res;
+  }
+
+} // namespace sbn
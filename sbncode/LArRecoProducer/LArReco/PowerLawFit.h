@@ -0,0 +1,35 @@
+/// \file  PowerLawFit.h
+//
+// Bounded least-squares fit of y = norm / x^power, replacing a ROOT fit
+// of TF1("[0]/x^[1]") with parameter limits.
+
+#ifndef PowerLawFit_H
+#define PowerLawFit_H
+
+#include <cstddef>
+
+namespace sbn {
+
+  struct PowerLawFitResult {
+    bool valid{false};
+    double norm{0.};
+    double power{0.};
+    double chi2{-1.};
+    int iterations{0};
+  };
+
+  /// Fits y = norm / x^power to the n points (x[i], y[i]) with unit
+  /// weights, minNorm <= norm <= maxNorm and minPower <= power <= maxPower.
+  ///
+  /// Starts from the regression of log(y) on log(x), clamped into the
+  /// limits, and refines it with Levenberg-Marquardt steps kept inside the
+  /// limits: a parameter at a limit that the step would push beyond it is
+  /// held there. Points with x <= 0, where the model is undefined, are
+  /// ignored. Needs at least 2 usable points.
+  PowerLawFitResult FitPowerLaw(const double* x, const double* y, size_t n,
+                                double minNorm, double maxNorm,
+                                double minPower, double maxPower);
+
+} // namespace sbn
+
+#endif // PowerLawFit_H
@@ -0,0 +1,212 @@
+/// \file  PrincipalAxis.h
+//
+// Principal axis of a set of 3D points, from the closed-form eigenvalues
+// of their symmetric 3x3 covariance matrix, replacing TMatrixDSymEigen
+// where only the direction of largest spread is needed.
+
+#ifndef PrincipalAxis_H
+#define PrincipalAxis_H
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+
+namespace sbn {
+
+  /// Symmetric 3x3 matrix, (xx xy xz; xy yy yz; xz yz zz)
+  struct SymMatrix3 {
+    double xx{0.}, xy{0.}, xz{0.};
+    double yy{0.}, yz{0.};
+    double zz{0.};
+  };
+
+  namespace detail {
+
+    /// Eigenvalues of a symmetric 3x3 matrix in the trigonometric form,
+    /// q + 2 p cos(phi + 2 pi k / 3), 0 <= phi <= pi / 3: the largest for
+    /// k = 0, the smallest for k = 1. The largest is farther from the
+    /// middle one than the smallest is if phi <= pi / 6.
+    struct TrigEigen {
+      double q{0.}, p{0.}, phi{0.};
+
+      double Largest() const { return q + 2. * p * std::cos(phi); }
+      double Middle() const { return q + 2. * p * std::cos(phi + 4. * M_PI / 3.); }
+      double Smallest() const { return q + 2. * p * std::cos(phi + 2. * M_PI / 3.); }
+      bool LargestIsolated() const { return phi <= M_PI / 6.; }
+    };
+
+    /// Of \a m scaled to its largest element, against overflow and
+    /// underflow: with B = (m - q 1) / p of trace 0, cos(3 phi) = det(B) / 2
+    inline TrigEigen ScaledTrigEigen(const SymMatrix3& m)
+    {
+      TrigEigen ret;
+      ret.q = (m.xx + m.yy + m.zz) / 3.;
+      const double bxx = m.xx - ret.q, byy = m.yy - ret.q, bzz = m.zz - ret.q;
+      const double p2 = (bxx * bxx + byy * byy + bzz * bzz + 2. * (m.xy * m.xy + m.xz * m.xz + m.yz * m.yz)) / 6.;
+      if (!(p2 > 0.)) return ret;
+      ret.p = std::sqrt(p2);
+      const double detB = (bxx * (byy * bzz - m.yz * m.yz) - m.xy * (m.xy * bzz - m.yz * m.xz) + m.xz * (m.xy * m.yz - byy * m.xz)) / (p2 * ret.p);
+      ret.phi = std::acos(std::clamp(0.5 * detB, -1., 1.)) / 3.;
+      return ret;
+    }
+
+    inline double MaxElement(const SymMatrix3& m)
+    {
+      return std::max({std::abs(m.xx), std::abs(m.xy), std::abs(m.xz),
+                       std::abs(m.yy), std::abs(m.yz), std::abs(m.zz)});
+    }
+
+    inline SymMatrix3 Scaled(const SymMatrix3& m, double scale)
+    {
+      return {m.xx / scale, m.xy / scale, m.xz / scale, m.yy / scale, m.yz / scale, m.zz / scale};
+    }
+
+    /// Unit eigenvector \a v of the eigenvalue \a lambda of \a m: the
+    /// largest cross product of two rows of m - lambda * 1, which are
+    /// orthogonal to it. Only accurate if \a lambda is not close to the
+    /// other eigenvalues; false if \a lambda is degenerate.
+    inline bool RowsEigenvector(const SymMatrix3& m, double lambda, std::array<double, 3>& v)
+    {
+      const double r0[3] = {m.xx - lambda, m.xy, m.xz};
+      const double r1[3] = {m.xy, m.yy - lambda, m.yz};
+      const double r2[3] = {m.xz, m.yz, m.zz - lambda};
+      const std::array<double, 3> c01 = {r0[1] * r1[2] - r0[2] * r1[1], r0[2] * r1[0] - r0[0] * r1[2], r0[0] * r1[1] - r0[1] * r1[0]};
+      const std::array<double, 3> c02 = {r0[1] * r2[2] - r0[2] * r2[1], r0[2] * r2[0] - r0[0] * r2[2], r0[0] * r2[1] - r0[1] * r2[0]};
+      const std::array<double, 3> c12 = {r1[1] * r2[2] - r1[2] * r2[1], r1[2] * r2[0] - r1[0] * r2[2], r1[0] * r2[1] - r1[1] * r2[0]};
+      const double n01 = c01[0] * c01[0] + c01[1] * c01[1] + c01[2] * c01[2];
+      const double n02 = c02[0] * c02[0] + c02[1] * c02[1] + c02[2] * c02[2];
+      const double n12 = c12[0] * c12[0] + c12[1] * c12[1] + c12[2] * c12[2];
+
+      const std::array<double, 3>& c = (n01 >= n02 && n01 >= n12) ? c01 : (n02 >= n12 ? c02 : c12);
+      const double n = std::max({n01, n02, n12});
+      if (!(n > 0.)) return false;
+      const double inv = 1. / std::sqrt(n);
+      v = {c[0] * inv, c[1] * inv, c[2] * inv};
+      return true;
+    }
+
+    /// \a m restricted to the plane orthogonal to the unit eigenvector
+    /// \a v: the unit vectors \a u and \a w of an orthonormal basis of the
+    /// plane, and the angle \a theta of the eigenvector of the larger of
+    /// the two other eigenvalues, cos(theta) u + sin(theta) w, and the
+    /// eigenvalues. Accurate also if the two are close or equal.
+    struct PlaneEigen {
+      std::array<double, 3> u, w;
+      double theta;
+      double larger, smaller;
+    };
+
+    inline PlaneEigen ScaledPlaneEigen(const SymMatrix3& m, const std::array<double, 3>& v)
+    {
+      PlaneEigen ret;
+      if (std::abs(v[0]) > std::abs(v[1])) {
+        const double inv = 1. / std::sqrt(v[0] * v[0] + v[2] * v[2]);
+        ret.u = {-v[2] * inv, 0., v[0] * inv};
+      }
+      else {
+        const double inv = 1. / std::sqrt(v[1] * v[1] + v[2] * v[2]);
+        ret.u = {0., v[2] * inv, -v[1] * inv};
+      }
+      ret.w = {v[1] * ret.u[2] - v[2] * ret.u[1], v[2] * ret.u[0] - v[0] * ret.u[2], v[0] * ret.u[1] - v[1] * ret.u[0]};
+
+      auto const product = [&m](const std::array<double, 3>& a, const std::array<double, 3>& b) {
+        return a[0] * (m.xx * b[0] + m.xy * b[1] + m.xz * b[2]) + a[1] * (m.xy * b[0] + m.yy * b[1] + m.yz * b[2]) + a[2] * (m.xz * b[0] + m.yz * b[1] + m.zz * b[2]);
+      };
+      const double uu = product(ret.u, ret.u), uw = product(ret.u, ret.w), ww = product(ret.w, ret.w);
+
+      // the Jacobi rotation that diagonalises (uu uw; uw ww)
+      ret.theta = 0.5 * std::atan2(2. * uw, uu - ww);
+      const double mean = 0.5 * (uu + ww), half = std::hypot(0.5 * (uu - ww), uw);
+      ret.larger = mean + half;
+      ret.smaller = mean - half;
+      return ret;
+    }
+
+  } // namespace detail
+
+  /// Eigenvalues of \a m, largest first.
+  ///
+  /// The eigenvalue farthest from the middle one is the root of the
+  /// characteristic cubic, in the trigonometric form, which loses accuracy
+  /// for the two other ones when they are close; those come from m in the
+  /// plane orthogonal to the eigenvector of the first.
+  inline std::array<double, 3> Eigenvalues(const SymMatrix3& m)
+  {
+    const double scale = detail::MaxElement(m);
+    if (!(scale > 0.)) return {0., 0., 0.};
+    const SymMatrix3 a = detail::Scaled(m, scale);
+    const detail::TrigEigen e = detail::ScaledTrigEigen(a);
+    if (!(e.p > 0.)) return {m.xx, m.xx, m.xx};
+
+    const bool largest = e.LargestIsolated();
+    const double isolated = largest ? e.Largest() : e.Smallest();
+    std::array<double, 3> v;
+    if (!detail::RowsEigenvector(a, isolated, v)) return {e.Largest() * scale, e.Middle() * scale, e.Smallest() * scale};
+    const detail::PlaneEigen plane = detail::ScaledPlaneEigen(a, v);
+    if (largest) return {isolated * scale, plane.larger * scale, plane.smaller * scale};
+    return {plane.larger * scale, plane.smaller * scale, isolated * scale};
+  }
+
+  /// Unit eigenvector of the largest eigenvalue of \a m, with an
+  /// arbitrary sign; (1, 0, 0) if \a m is a multiple of the identity, as
+  /// TMatrixDSymEigen then gives the axes.
+  ///
+  /// The eigenvalue is the largest root of the characteristic cubic, in
+  /// the trigonometric form, and the eigenvector the largest cross product
+  /// of two rows of m - lambda * 1, which are orthogonal to it. When the
+  /// largest eigenvalue is closer to the middle one than the smallest is,
+  /// those rows are nearly parallel, so the eigenvector of the smallest
+  /// is found that way instead, and the axis in the plane orthogonal to it.
+  inline std::array<double, 3> PrincipalAxis(const SymMatrix3& m)
+  {
+    const double scale = detail::MaxElement(m);
+    if (!(scale > 0.)) return {1., 0., 0.};
+    const SymMatrix3 a = detail::Scaled(m, scale);
+    const detail::TrigEigen e = detail::ScaledTrigEigen(a);
+    if (!(e.p > 0.)) return {1., 0., 0.};
+
+    std::array<double, 3> v;
+    const bool largest = e.LargestIsolated();
+    // the eigenvalue is degenerate: any axis of its plane will do
+    if (!detail::RowsEigenvector(a, largest ? e.Largest() : e.Smallest(), v)) return {1., 0., 0.};
+    if (largest) return v;
+
+    const detail::PlaneEigen plane = detail::ScaledPlaneEigen(a, v);
+    const double c = std::cos(plane.theta), s = std::sin(plane.theta);
+    return {c * plane.u[0] + s * plane.w[0], c * plane.u[1] + s * plane.w[1], c * plane.u[2] + s * plane.w[2]};
+  }
+
+  /// Principal axis of the \a n points (x[i], y[i], z[i]): the covariance
+  /// of the points about their mean, then PrincipalAxis(SymMatrix3).
+  template <class T>
+  std::array<double, 3> PrincipalAxis(const T* x, const T* y, const T* z, size_t n)
+  {
+    if (n == 0) return {1., 0., 0.};
+    double mx = 0., my = 0., mz = 0.;
+    for (size_t i = 0; i < n; i++) {
+      mx += x[i];
+      my += y[i];
+      mz += z[i];
+    }
+    const double norm = 1. / double(n);
+    mx *= norm;
+    my *= norm;
+    mz *= norm;
+
+    SymMatrix3 m;
+    for (size_t i = 0; i < n; i++) {
+      const double dx = x[i] - mx, dy = y[i] - my, dz = z[i] - mz;
+      m.xx += dx * dx * norm;
+      m.xy += dx * dy * norm;
+      m.xz += dx * dz * norm;
+      m.yy += dy * dy * norm;
+      m.yz += dy * dz * norm;
+      m.zz += dz * dz * norm;
+    }
+    return PrincipalAxis(m);
+  }
+
+} // namespace sbn
+
+#endif // PrincipalAxis_H
@@ -0,0 +1,115 @@
+/// \file  RangeTables.cxx
+
+#include "RangeTables.h"
+
+#include "TGraph.h"
+#include "TSpline.h"
+
+#include <array>
+#include <cstdlib>
+
+namespace {
+
+  constexpr double kMuonMass = 105.7;
+  constexpr double kPionMass = 139.570;
+  constexpr double kKaonMass = 493.677;
+  constexpr double kProtonMass = 938.272;
+
+  constexpr size_t kNodes = 16384;
+
+  /* Muon range-momentum tables from CSDA (Argon density = 1.396 g/cm^3)
+     website:
+     http://pdg.lbl.gov/2012/AtomicNuclearProperties/MUON_ELOSS_TABLES/muonloss_289.pdf
+  */
+  constexpr std::array<float, 29> kMuonRange_grampercm{{
+    9.833E-1, 1.786E0, 3.321E0, 6.598E0, 1.058E1, 3.084E1, 4.250E1, 6.732E1,
+    1.063E2,  1.725E2, 2.385E2, 4.934E2, 6.163E2, 8.552E2, 1.202E3, 1.758E3,
+    2.297E3,  4.359E3, 5.354E3, 7.298E3, 1.013E4, 1.469E4, 1.910E4, 3.558E4,
+    4.326E4,  5.768E4, 7.734E4, 1.060E5, 1.307E5}};
+  constexpr std::array<float, 29> kMuonKE_MeV{{
+    10,    14,    20,    30,    40,     80,     100,    140,    200,   300,
+    400,   800,   1000,  1400,  2000,   3000,   4000,   8000,   10000, 14000,
+    20000, 30000, 40000, 80000, 100000, 140000, 200000, 300000, 400000}};
+
+  /* Proton KE vs range (cm), from fits to the NIST PSTAR CSDA tables:
+     https://physics.nist.gov/PhysRefData/Star/Text/PSTAR.html
+     a*(x^b) below 80 cm and a polynomial of power 6 above, valid up to
+     3.022E3 cm (KE of 5 GeV).
+  */
+  constexpr double kProtonMaxRange = 3.022E3;
+
+  double
+  ProtonKE(double const r)
+  {
+    if (r <= 0)
+      return 0;
+    if (r <= 80)
+      return 29.9317 * std::pow(r, 0.586304);
+    return 149.904 + (3.34146 * r) + (-0.00318856 * r * r) + (4.34587E-6 * r * r * r) +
+           (-3.18146E-9 * r * r * r * r) + (1.17854E-12 * r * r * r * r * r) +
+           (-1.71763E-16 * r * r * r * r * r * r);
+  }
+
+} // namespace
+
+namespace sbn {
+
+  const RangeTables&
+  RangeTables::Instance()
+  {
+    static const RangeTables tables;
+    return tables;
+  }
+
+  RangeTables::RangeTables()
+  {
+    std::array<float, 29> muonRange = kMuonRange_grampercm;
+    for (float& r : muonRange)
+      r /= kReferenceDensity; // convert to cm
+    TGraph muonKEvsR{29, muonRange.data(), kMuonKE_MeV.data()};
+    TSpline3 const muonSpline{"KEvsRS", &muonKEvsR};
+    // the spline is extrapolated below the first point, down to 0 at 0
+    auto const muonKE = [&muonSpline](double r) { return r > 0 ? muonSpline.Eval(r) : 0.; };
+    double const muonMaxRange = muonRange.back();
+
+    fMuon = RangeKETable{muonKE, muonMaxRange, kNodes};
+
+    // Bethe-Bloch stopping power is a function of beta alone, so at the
+    // same beta range and KE both scale with the mass
+    // (https://inspirehep.net/literature/1766384, eq. 6.2)
+    auto const scaled = [&muonKE](double ratio) {
+      return [&muonKE, ratio](double r) { return ratio * muonKE(r / ratio); };
+    };
+    fPion = RangeKETable{scaled(kPionMass / kMuonMass),
+                         muonMaxRange * kPionMass / kMuonMass, kNodes};
+    fKaon = RangeKETable{scaled(kKaonMass / kMuonMass),
+                         muonMaxRange * kKaonMass / kMuonMass, kNodes};
+
+    fProton = RangeKETable{ProtonKE, kProtonMaxRange, kNodes};
+  }
+
+  const RangeKETable*
+  RangeTables::Table(int const pdg) const
+  {
+    switch (std::abs(pdg)) {
+    case 13: return &fMuon;
+    case 211: return &fPion;
+    case 321: return &fKaon;
+    case 2212: return &fProton;
+    default: return nullptr;
+    }
+  }
+
+  double
+  RangeTables::Mass(int const pdg)
+  {
+    switch (std::abs(pdg)) {
+    case 13: return kMuonMass;
+    case 211: return kPionMass;
+    case 321: return kKaonMass;
+    case 2212: return kProtonMass;
+    default: return -1.;
+    }
+  }
+
+} // namespace sbn
@@ -0,0 +1,154 @@
+/// \file  RangeTables.h
+//
+// Kinetic energy vs range in liquid argon of muons, charged pions,
+// charged kaons and protons, tabulated once and shared by the range and
+// MCS momentum estimators.
+
+#ifndef RangeTables_H
+#define RangeTables_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+namespace sbn {
+
+  /// Kinetic energy of a particle stopping after a given range, sampled
+  /// on a grid uniform in sqrt(range), and the inverse, sampled on a grid
+  /// uniform in sqrt(KE). KE goes roughly as a power of the range between
+  /// 1/2 and 1, which the square root straightens, and finding the node
+  /// of a lookup takes a sqrt and a multiplication.
+  class RangeKETable {
+  public:
+    RangeKETable() = default;
+
+    /// \param keFromRange KE [MeV] of the particle stopping after a range
+    ///        [cm], with KE 0 for range 0. The inverse table covers the
+    ///        part of [0, maxRange] where it increases.
+    template <class F>
+    RangeKETable(F&& keFromRange, double maxRange, size_t nNodes);
+
+    /// KE [MeV] for \a range [cm]; -1 beyond the table
+    double KE(double range) const
+    {
+      if (!(range >= 0.) || range > fMaxRange) return -1.;
+      return Interpolate(fKE, std::sqrt(range) * fInvRangeStep);
+    }
+
+    /// Range [cm] for \a ke [MeV]; the inverse of KE(), -1 beyond the table
+    double Range(double ke) const
+    {
+      if (!(ke >= 0.) || ke > fMaxKE) return -1.;
+      return Interpolate(fRange, std::sqrt(ke) * fInvKEStep);
+    }
+
+    double MaxRange() const { return fMaxRange; }
+    double MaxKE() const { return fMaxKE; }
+
+  private:
+    static double Interpolate(const std::vector<double>& v, double u)
+    {
+      const size_t i = std::min(static_cast<size_t>(u), v.size() - 2);
+      return v[i] + (u - i) * (v[i + 1] - v[i]);
+    }
+
+    double fMaxRange{-1.};
+    double fInvRangeStep{1.}; ///< nodes per unit of sqrt(range)
+    std::vector<double> fKE;  ///< KE at the range nodes
+
+    double fMaxKE{-1.};
+    double fInvKEStep{1.};     ///< nodes per unit of sqrt(KE)
+    std::vector<double> fRange; ///< range at the KE nodes
+  };
+
+  /// The tables of all the supported particles, built on first use and
+  /// read-only afterwards, so they can be shared between threads.
+  ///
+  /// The tables are those of argon at kReferenceDensity; ranges at another
+  /// density are scaled by the density ratio.
+  class RangeTables {
+  public:
+    static constexpr double kReferenceDensity = 1.396; ///< g/cm^3
+
+    static const RangeTables& Instance();
+
+    /// The table for the particle with PDG code \a pdg (either sign),
+    /// nullptr if there is none
+    const RangeKETable* Table(int pdg) const;
+
+    /// Mass [MeV] used with the table of \a pdg, -1 if there is none
+    static double Mass(int pdg);
+
+    /// KE [MeV] of a particle \a pdg stopping after \a range [cm] in argon
+    /// of \a density [g/cm^3]; -1 if not covered by the tables
+    double KEFromRange(int pdg, double range, double density = kReferenceDensity) const
+    {
+      const RangeKETable* table = Table(pdg);
+      return table ? table->KE(range * density / kReferenceDensity) : -1.;
+    }
+
+    /// Range [cm] of a particle \a pdg with kinetic energy \a ke [MeV] in
+    /// argon of \a density [g/cm^3]; -1 if not covered by the tables
+    double RangeFromKE(int pdg, double ke, double density = kReferenceDensity) const
+    {
+      const RangeKETable* table = Table(pdg);
+      if (!table) return -1.;
+      const double range = table->Range(ke);
+      return range < 0. ? -1. : range * kReferenceDensity / density;
+    }
+
+    /// Momentum [GeV/c] of a particle \a pdg stopping after \a range [cm];
+    /// -1 if not covered by the tables
+    double MomentumFromRange(int pdg, double range, double density = kReferenceDensity) const
+    {
+      const double ke = KEFromRange(pdg, range, density);
+      if (ke < 0.) return -1.;
+      return std::sqrt(ke * ke + 2. * Mass(pdg) * ke) / 1000.;
+    }
+
+  private:
+    RangeTables();
+
+    RangeKETable fMuon;
+    RangeKETable fPion;
+    RangeKETable fKaon;
+    RangeKETable fProton;
+  };
+
+  template <class F>
+  RangeKETable::RangeKETable(F&& keFromRange, double maxRange, size_t nNodes)
+    : fMaxRange(maxRange)
+    , fInvRangeStep((nNodes - 1) / std::sqrt(maxRange))
+    , fKE(nNodes)
+  {
+    for (size_t i = 1; i < nNodes; i++) {
+      const double s = i / fInvRangeStep;
+      fKE[i] = keFromRange(i + 1 < nNodes ? s * s : maxRange);
+    }
+
+    // the inverse stops where KE stops increasing
+    size_t last = 1;
+    while (last + 1 < nNodes && fKE[last + 1] > fKE[last]) last++;
+    fMaxKE = fKE[last];
+    fInvKEStep = (nNodes - 1) / std::sqrt(fMaxKE);
+
+    // invert by bisection on the increasing part of the range table
+    const double maxMonotonic = (last + 1 < nNodes) ? last * last / (fInvRangeStep * fInvRangeStep) : maxRange;
+    fRange.resize(nNodes);
+    for (size_t i = 1; i < nNodes; i++) {
+      const double s = i / fInvKEStep;
+      const double ke = (i + 1 < nNodes) ? s * s : fMaxKE;
+      double lo = 0., hi = maxMonotonic;
+      for (int it = 0; it < 100 && hi - lo > 1e-12 * hi; it++) {
+        const double mid = 0.5 * (lo + hi);
+        (KE(mid) < ke ? lo : hi) = mid;
+      }
+      fRange[i] = 0.5 * (lo + hi);
+    }
+    fRange.back() = maxMonotonic;
+  }
+
+} // namespace sbn
+
+#endif // RangeTables_H
@@ -0,0 +1,82 @@
+/// \file  ShowerDensityProfile.cxx
+
+#include "ShowerDensityProfile.h"
+
+#include <cmath>
+#include <vector>
+
+namespace {
+
+  constexpr unsigned int kMinSegmentPoints = 10;
+  constexpr size_t kMinProfilePoints = 3;
+
+} // namespace
+
+namespace sbn {
+
+  PowerLawFitResult FitShowerDensityProfile(const double* x, const double* y, const double* z, size_t n,
+                                            const double start[3], const double dir[3],
+                                            double length, double openAngle,
+                                            unsigned int nSegments, bool removeStartFin)
+  {
+    if (n == 0 || nSegments == 0)
+      return PowerLawFitResult();
+
+    // Space points per segment, indexed by sg_len for sg_len >= 0 and by
+    // -sg_len-1 below. Points projecting beyond the shower length land past
+    // the nominal nSegments+1.
+    std::vector<unsigned int> segmentCounts(nSegments + 1, 0), backSegmentCounts;
+    const double segmentSize = length / nSegments;
+    const double tanOpenAngle = std::abs(std::tan(openAngle));
+    unsigned int totalHits = 0;
+
+    for (size_t i = 0; i < n; i++) {
+      const double px = x[i] - start[0], py = y[i] - start[1], pz = z[i] - start[2];
+      const double projLen = px * dir[0] + py * dir[1] + pz * dir[2];
+      const double ox = px - projLen * dir[0], oy = py - projLen * dir[1], oz = pz - projLen * dir[2];
+      const double perpLen = std::sqrt(ox * ox + oy * oy + oz * oz);
+
+      if (perpLen > std::abs(tanOpenAngle * projLen))
+        continue;
+
+      const int sg_len = std::round(projLen / segmentSize);
+      std::vector<unsigned int>& counts = (sg_len >= 0) ? segmentCounts : backSegmentCounts;
+      const unsigned int index = (sg_len >= 0) ? sg_len : -sg_len - 1;
+      if (index >= counts.size()) counts.resize(index + 1, 0);
+      ++counts[index];
+      ++totalHits;
+    }
+
+    std::vector<double> lengths, densities;
+    lengths.reserve(segmentCounts.size() + backSegmentCounts.size());
+    densities.reserve(segmentCounts.size() + backSegmentCounts.size());
+
+    const double tanHalfAngle = std::tan(0.5 * openAngle);
+    auto const addSegment = [&](int sg_len, unsigned int count) {
+      if (count < kMinSegmentPoints) return;
+      if (removeStartFin && (sg_len == 0 || sg_len == (int)nSegments)) return;
+
+      // volume between the cones up to the two ends of the segment
+      double lower_dist = sg_len * segmentSize - segmentSize / 2;
+      double upper_dist = sg_len * segmentSize + segmentSize / 2;
+      if (sg_len == 0) lower_dist = 0;
+      if (sg_len == (int)nSegments) upper_dist = sg_len * segmentSize;
+
+      const double littlevolume = lower_dist * std::pow(tanHalfAngle * lower_dist, 2) * M_PI / 3;
+      const double bigvolume = upper_dist * std::pow(tanHalfAngle * upper_dist, 2) * M_PI / 3;
+
+      lengths.push_back((lower_dist + upper_dist) / 2);
+      densities.push_back(count / (bigvolume - littlevolume) / totalHits);
+    };
+    for (unsigned int i = backSegmentCounts.size(); i > 0; --i)
+      addSegment(-(int)i, backSegmentCounts[i - 1]);
+    for (unsigned int i = 0; i < segmentCounts.size(); ++i)
+      addSegment(i, segmentCounts[i]);
+
+    if (lengths.size() < kMinProfilePoints)
+      return PowerLawFitResult();
+
+    return FitPowerLaw(lengths.data(), densities.data(), lengths.size(), 0, 1, 1, 2);
+  }
+
+} // namespace sbn
@@ -0,0 +1,36 @@
+/// \file  ShowerDensityProfile.h
+//
+// Density of the space points of a shower along its axis, in segments of
+// the cone of the shower, and its fit to a power law of the distance from
+// the start of the shower.
+
+#ifndef ShowerDensityProfile_H
+#define ShowerDensityProfile_H
+
+#include "PowerLawFit.h"
+
+#include <cstddef>
+
+namespace sbn {
+
+  /// Fits density = norm / length^power, 0 <= norm <= 1 and
+  /// 1 <= power <= 2, to the density profile of the \a n space points
+  /// (x[i], y[i], z[i]) of a shower starting at \a start with unit
+  /// direction \a dir, \a length [cm] and \a openAngle [rad].
+  ///
+  /// The points outside the cone of \a openAngle are dropped and the rest
+  /// counted in \a nSegments segments of the length of the shower, each
+  /// centred on a multiple of the segment length. Segments with at least
+  /// 10 points give a point of the profile: the distance to the centre of
+  /// the segment, and the fraction of the points of the shower in the
+  /// segment per unit volume of the cone. With \a removeStartFin the first
+  /// and the last segments are left out. Not valid with less than 3
+  /// points in the profile.
+  PowerLawFitResult FitShowerDensityProfile(const double* x, const double* y, const double* z, size_t n,
+                                            const double start[3], const double dir[3],
+                                            double length, double openAngle,
+                                            unsigned int nSegments, bool removeStartFin);
+
+} // namespace sbn
+
+#endif // ShowerDensityProfile_H
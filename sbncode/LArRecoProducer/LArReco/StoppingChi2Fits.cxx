@@ -0,0 +1,132 @@
+/// \file  StoppingChi2Fits.cxx
+
+#include "StoppingChi2Fits.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+  constexpr int kMaxIterations = 100;
+  constexpr double kRelTolerance = 1e-12;
+  constexpr double kMaxLambda = 1e10;
+
+  double ExpoChi2(const sbn::StoppingFitPoints& points, double constant, double slope)
+  {
+    double chi2 = 0.;
+    points.ForEach([&](double x, double y) {
+      const double r = y - std::exp(constant + slope * x);
+      chi2 += r * r;
+    });
+    return chi2;
+  }
+
+} // namespace
+
+namespace sbn {
+
+  Pol0FitResult FitPol0(const StoppingFitPoints& points)
+  {
+    Pol0FitResult res;
+
+    size_t n = 0;
+    double sum = 0.;
+    points.ForEach([&](double, double y) {
+      n++;
+      sum += y;
+    });
+    if (n == 0) return res;
+
+    res.p0 = sum / n;
+    // from the residuals rather than sum(y^2) - n*mean^2, which cancels
+    res.chi2 = 0.;
+    points.ForEach([&](double, double y) { res.chi2 += (y - res.p0) * (y - res.p0); });
+    res.valid = true;
+    return res;
+  }
+
+  ExpoFitResult FitExpo(const StoppingFitPoints& points)
+  {
+    ExpoFitResult res;
+
+    // Starting point: linear regression of log(y), on the points where it
+    // is defined
+    size_t n = 0, npos = 0;
+    double sx = 0., sl = 0., sxx = 0., sxl = 0.;
+    points.ForEach([&](double x, double y) {
+      n++;
+      if (y <= 0.) return;
+      npos++;
+      const double l = std::log(y);
+      sx += x;
+      sl += l;
+      sxx += x * x;
+      sxl += x * l;
+    });
+    if (n < 2) return res;
+
+    double constant = 0., slope = 0.;
+    const double det = npos * sxx - sx * sx;
+    if (npos >= 2 && det > 0.) {
+      slope = (npos * sxl - sx * sl) / det;
+      constant = (sl - slope * sx) / npos;
+    }
+    else if (npos == 1) {
+      constant = sl;
+    }
+
+    double chi2 = ExpoChi2(points, constant, slope);
+    if (!std::isfinite(chi2)) return res;
+
+    // Levenberg-Marquardt on chi2 = sum (y - f)^2, f = exp(constant + slope*x)
+    double lambda = 1e-3;
+    int it = 0;
+    for (; it < kMaxIterations && chi2 > 0.; it++) {
+      // J^T J and J^T r, with J the derivatives of f
+      double jcc = 0., jcs = 0., jss = 0., gc = 0., gs = 0.;
+      points.ForEach([&](double x, double y) {
+        const double f = std::exp(constant + slope * x);
+        const double r = y - f;
+        jcc += f * f;
+        jcs += f * f * x;
+        jss += f * f * x * x;
+        gc += f * r;
+        gs += f * x * r;
+      });
+
+      bool stepped = false;
+      double newChi2 = chi2;
+      for (; lambda < kMaxLambda; lambda *= 10.) {
+        const double mcc = jcc * (1. + lambda);
+        const double mss = jss * (1. + lambda);
+        const double d = mcc * mss - jcs * jcs;
+        if (!(d > 0.)) continue;
+
+        const double dc = (gc * mss - gs * jcs) / d;
+        const double ds = (mcc * gs - jcs * gc) / d;
+        newChi2 = ExpoChi2(points, constant + dc, slope + ds);
+        if (std::isfinite(newChi2) && newChi2 <= chi2) {
+          constant += dc;
+          slope += ds;
+          stepped = true;
+          break;
+        }
+      }
+      // no step lowers chi2 any more: at the minimum
+      if (!stepped) break;
+
+      const bool converged = (chi2 - newChi2) <= kRelTolerance * chi2;
+      chi2 = newChi2;
+      lambda = std::max(lambda / 10., 1e-12);
+      if (converged) break;
+    }
+
+    res.constant = constant;
+    res.slope = slope;
+    res.chi2 = chi2;
+    res.iterations = it;
+    res.valid = true;
+    return res;
+  }
+
+} // namespace sbn
@@ -0,0 +1,68 @@
+/// \file  StoppingChi2Fits.h
+//
+// Least-squares fits of a dE/dx vs residual range profile to a constant
+// and to an exponential, with the same results as TGraph::Fit("pol0")
+// and TGraph::Fit("expo") but without going through ROOT's fitter.
+
+#ifndef StoppingChi2Fits_H
+#define StoppingChi2Fits_H
+
+#include <cstddef>
+
+namespace sbn {
+
+  /// The points (x[i], y[i]), begin <= i < end, with x <= maxX and
+  /// y <= maxY. Refers to the arrays, so no copy of the points is made.
+  struct StoppingFitPoints {
+    const float* x;
+    const float* y;
+    size_t begin;
+    size_t end;
+    float maxX;
+    float maxY;
+
+    template <class F>
+    void ForEach(F&& f) const
+    {
+      for (size_t i = begin; i < end; i++) {
+        if (x[i] > maxX || y[i] > maxY) continue;
+        f(double(x[i]), double(y[i]));
+      }
+    }
+
+    size_t Count() const
+    {
+      size_t n = 0;
+      ForEach([&n](double, double) { n++; });
+      return n;
+    }
+  };
+
+  struct Pol0FitResult {
+    bool valid{false};
+    double p0{0.};
+    double chi2{-1.};
+  };
+
+  struct ExpoFitResult {
+    bool valid{false};
+    double constant{0.}; ///< f(x) = exp(constant + slope * x)
+    double slope{0.};
+    double chi2{-1.};
+    int iterations{0};
+  };
+
+  /// Fit of y = p0 with unit weights, as ROOT does for a TGraph without
+  /// errors: p0 is the mean of y and chi2 the sum of squared residuals
+  Pol0FitResult FitPol0(const StoppingFitPoints& points);
+
+  /// Fit of y = exp(constant + slope * x) with unit weights.
+  ///
+  /// The linear regression of log(y) on x gives the starting point, which
+  /// is then refined to the least-squares minimum of the residuals in y,
+  /// where ROOT's fit ends, with Levenberg-Marquardt steps.
+  ExpoFitResult FitExpo(const StoppingFitPoints& points);
+
+} // namespace sbn
+
+#endif // StoppingChi2Fits_H
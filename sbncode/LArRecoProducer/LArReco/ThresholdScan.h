@@ -0,0 +1,76 @@
+/// \file  ThresholdScan.h
+//
+// Finds the runs of ADC samples at or below a threshold in a waveform,
+// comparing 16 samples at a time.
+
+#ifndef ThresholdScan_H
+#define ThresholdScan_H
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace sbn {
+
+  namespace detail {
+
+    /// Bit k set if adc[k] <= thresh, for the n <= 16 samples of adc
+    inline uint32_t AtOrBelowMask(const short* adc, size_t n, short thresh)
+    {
+#ifdef __SSE2__
+      if (n == 16) {
+        const __m128i t = _mm_set1_epi16(thresh);
+        const __m128i lo = _mm_cmpgt_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(adc)), t);
+        const __m128i hi = _mm_cmpgt_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(adc + 8)), t);
+        // one byte per sample, 0xff where above the threshold
+        return ~uint32_t(_mm_movemask_epi8(_mm_packs_epi16(lo, hi))) & 0xffffu;
+      }
+#endif
+      uint32_t mask = 0;
+      for (size_t k = 0; k < n; k++)
+        if (adc[k] <= thresh) mask |= (1u << k);
+      return mask;
+    }
+
+  } // namespace detail
+
+  /// Calls f(begin, end) for every maximal run [begin, end) of samples with
+  /// adc[i] <= thresh, start <= i < stop, in order.
+  ///
+  /// Blocks of samples all above the threshold, most of a PMT waveform,
+  /// cost one comparison of 16 samples.
+  template <class F>
+  void ForEachRunAtOrBelow(const short* adc, size_t start, size_t stop, int thresh, F&& f)
+  {
+    if (thresh < std::numeric_limits<short>::min()) return;
+    const short t = thresh > std::numeric_limits<short>::max() ? std::numeric_limits<short>::max() : short(thresh);
+
+    bool inRun = false;
+    size_t runBegin = 0;
+    for (size_t base = start; base < stop; base += 16) {
+      const size_t n = (stop - base < 16) ? stop - base : 16;
+      const uint32_t full = (1u << n) - 1;
+      const uint32_t mask = detail::AtOrBelowMask(adc + base, n, t);
+      if (mask == (inRun ? full : 0u)) continue;
+
+      size_t pos = 0;
+      while (pos < n) {
+        // next sample that ends the current state
+        const uint32_t rest = (inRun ? ~mask & full : mask) >> pos;
+        if (rest == 0) break;
+        pos += __builtin_ctz(rest);
+        if (inRun) f(runBegin, base + pos);
+        else runBegin = base + pos;
+        inRun = !inRun;
+      }
+    }
+    if (inRun) f(runBegin, stop);
+  }
+
+} // namespace sbn
+
+#endif // ThresholdScan_H
@@ -3,9 +3,13 @@
 // \author sowjanyag@phys.ksu.edu
 
 #include "TrackMomentumCalculator.h"
+#include "PrincipalAxis.h"
+#include "RangeTables.h"
 #include "cetlib/pow.h"
 #include "messagefacility/MessageLogger/MessageLogger.h"
 
+#include "Math/IFunction.h"
+
 #include <array>
 #include <cassert>
 
@@ -14,41 +18,65 @@ using std::endl;
 
 namespace {
 
-  constexpr auto range_gramper_cm()
+  constexpr float kcal{0.0024};
+
+  // c = a x b, in the order of TVector3::Cross
+  void
+  cross(double const* a, double const* b, double* c)
   {
-    std::array<float, 29> Range_grampercm{{
-      9.833E-1, 1.786E0, 3.321E0, 6.598E0, 1.058E1, 3.084E1, 4.250E1, 6.732E1,
-      1.063E2,  1.725E2, 2.385E2, 4.934E2, 6.163E2, 8.552E2, 1.202E3, 1.758E3,
-      2.297E3,  4.359E3, 5.354E3, 7.298E3, 1.013E4, 1.469E4, 1.910E4, 3.558E4,
-      4.326E4,  5.768E4, 7.734E4, 1.060E5, 1.307E5}};
-    for (float& value : Range_grampercm) {
-      value /= 1.396; // convert to cm
-    }
-    return Range_grampercm;
+    c[0] = a[1] * b[2] - b[1] * a[2];
+    c[1] = a[2] * b[0] - b[2] * a[0];
+    c[2] = a[0] * b[1] - b[0] * a[1];
   }
 
-  constexpr auto Range_grampercm = range_gramper_cm();
-  constexpr std::array<float, 29> KE_MeV{{
-    10,    14,    20,    30,    40,     80,     100,    140,    200,   300,
-    400,   800,   1000,  1400,  2000,   3000,   4000,   8000,   10000, 14000,
-    20000, 30000, 40000, 80000, 100000, 140000, 200000, 300000, 400000}};
-  TGraph const KEvsR{29, Range_grampercm.data(), KE_MeV.data()};
-  TSpline3 const KEvsR_spline3{"KEvsRS", &KEvsR};
+  double
+  dot(double const* a, double const* b)
+  {
+    return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+  }
 
+  /// Frame with its z axis along a segment, in which the direction of a
+  /// following segment gives the scattering angles. Same arithmetic as
+  /// the TVector3 version, without the temporaries.
+  struct SegmentFrame {
+    double x[3];
+    double y[3];
+    double z[3];
+
+    /// \param fromX build y from z x (1, 0, 0), else from (0, 0, 1) x z
+    SegmentFrame(double const dx, double const dy, double const dz, bool const fromX)
+      : z{dx, dy, dz}
+    {
+      constexpr double ex[3]{1, 0, 0};
+      constexpr double ez[3]{0, 0, 1};
+      if (fromX)
+        cross(z, ex, y);
+      else
+        cross(ez, z, y);
+      double const tot2 = dot(y, y);
+      double const tot = (tot2 > 0) ? 1.0 / std::sqrt(tot2) : 1.0;
+      for (double& c : y)
+        c *= tot;
+      cross(y, z, x);
+    }
 
-  TVector3 const basex{1, 0, 0};
-  TVector3 const basey{0, 1, 0};
-  TVector3 const basez{0, 0, 1};
-  constexpr float kcal{0.0024};
+    void
+    rotate(double const* v, double* out) const
+    {
+      out[0] = dot(x, v);
+      out[1] = dot(y, v);
+      out[2] = dot(z, v);
+    }
+  };
 
   class FcnWrapper {
   public:
     explicit FcnWrapper(std::vector<double>&& xmeas,
                         std::vector<double>&& ymeas,
                         std::vector<double>&& eymeas)
-      : xmeas_{xmeas}
-      , ymeas_{ymeas}
-      , eymeas_{eymeas}
+      : xmeas_{std::move(xmeas)}
+      , ymeas_{std::move(ymeas)}
+      , eymeas_{std::move(eymeas)}
     {}
 
     double
@@ -102,14 +130,44 @@ namespace {
     std::vector<double> const eymeas_;
   };
 
+  // The chi2 of a FcnWrapper as the function minimized by Minuit2,
+  // calling it directly rather than through a ROOT::Math::Functor.
+  class McsChi2Function : public ROOT::Math::IMultiGenFunction {
+  public:
+    explicit McsChi2Function(FcnWrapper const& wrapper) : wrapper_{wrapper} {}
+
+    unsigned int
+    NDim() const override
+    {
+      return 2;
+    }
+
+    ROOT::Math::IMultiGenFunction*
+    Clone() const override
+    {
+      return new McsChi2Function{wrapper_};
+    }
+
+  private:
+    double
+    DoEval(double const* x) const override
+    {
+      return wrapper_.my_mcs_chi2(x);
+    }
+
+    FcnWrapper const& wrapper_;
+  };
+
 }
 
 namespace trkf {
 
   TrackMomentumCalculator::TrackMomentumCalculator(double const min,
-                                                   double const max)
+                                                   double const max,
+                                                   bool const makeDiagnostics)
     : minLength{min}
     , maxLength{max}
+    , fMakeDiagnostics{makeDiagnostics}
   {
     for (int i = 1; i <= n_steps; i++) {
       steps.push_back(steps_size * i);
@@ -186,37 +244,11 @@ namespace trkf {
       return -1.;
     }
 
-    double KE, Momentum, M;
-    constexpr double Muon_M = 105.7, Proton_M = 938.272;
-
-    if (abs(pdg) == 13) {
-      M = Muon_M;
-      KE = KEvsR_spline3.Eval(trkrange);
-    } else if (abs(pdg) == 2212) {
-      M = Proton_M;
-      if (trkrange > 0 && trkrange <= 80)
-        KE = 29.9317 * std::pow(trkrange, 0.586304);
-      else if (trkrange > 80 && trkrange <= 3.022E3)
-        KE =
-          149.904 + (3.34146 * trkrange) + (-0.00318856 * trkrange * trkrange) +
-          (4.34587E-6 * trkrange * trkrange * trkrange) +
-          (-3.18146E-9 * trkrange * trkrange * trkrange * trkrange) +
-          (1.17854E-12 * trkrange * trkrange * trkrange * trkrange * trkrange) +
-          (-1.71763E-16 * trkrange * trkrange * trkrange * trkrange * trkrange *
-           trkrange);
-      else
-        KE = -999;
-    } else
-      KE = -999;
-
-    if (KE < 0)
-      Momentum = -999;
-    else
-      Momentum = std::sqrt((KE * KE) + (2 * M * KE));
-
-    Momentum = Momentum / 1000;
+    // The tables above and the fits to them are tabulated, along with the
+    // pion and kaon ones, in sbn::RangeTables
+    double const Momentum = sbn::RangeTables::Instance().MomentumFromRange(pdg, trkrange);
 
-    return Momentum;
+    return Momentum < 0 ? -0.999 : Momentum;
   }
 
   // Momentum measurement via Multiple Coulomb Scattering (MCS)
@@ -387,78 +419,55 @@ namespace trkf {
     int tot = a1 - 1;
     double thick1 = thick + 0.13;
 
+    // Segment j is paired with i if the track gets thick1 past the start
+    // of i within j. segL only grows, so the partner of i+1 is never
+    // before that of i and a single forward pass finds them all.
+    int j = 0;
     for (int i = 0; i < tot; i++) {
-      double const dx = segnx.at(i);
-      double const dy = segny.at(i);
-      double const dz = segnz.at(i);
-
-      TVector3 const vec_z{dx, dy, dz};
-      TVector3 vec_x;
-      TVector3 vec_y;
-
-      double const switcher = basex.Dot(vec_z);
-      if (std::abs(switcher) <= 0.995) {
-        vec_y = vec_z.Cross(basex).Unit();
-        vec_x = vec_y.Cross(vec_z);
-      }
-      else {
-        // cout << " It switched ! Isn't this lovely !!! " << endl; //
-        vec_y = basez.Cross(vec_z).Unit();
-        vec_x = vec_y.Cross(vec_z);
-      }
-
-      TVector3 const Rx{vec_x.Dot(basex), vec_x.Dot(basey), vec_x.Dot(basez)};
-      TVector3 const Ry{vec_y.Dot(basex), vec_y.Dot(basey), vec_y.Dot(basez)};
-      TVector3 const Rz{vec_z.Dot(basex), vec_z.Dot(basey), vec_z.Dot(basez)};
-
       double const refL = segL.at(i);
 
-      for (int j = i; j < tot; j++) {
-        double const L1 = segL.at(j);
-        double const L2 = segL.at(j + 1);
+      if (j < i) j = i;
+      while (j < tot && !(segL.at(j + 1) - refL > thick1))
+        j++;
+      if (j == tot) break; // nor will the following segments be paired
 
-        double const dz1 = L1 - refL;
-        double const dz2 = L2 - refL;
-
-        if (dz1 <= thick1 && dz2 > thick1) {
-          double const here_dx = segnx.at(j);
-          double const here_dy = segny.at(j);
-          double const here_dz = segnz.at(j);
+      double const dx = segnx.at(i);
+      double const dy = segny.at(i);
+      double const dz = segnz.at(i);
 
-          TVector3 const here_vec{here_dx, here_dy, here_dz};
-          TVector3 const rot_here{
-            Rx.Dot(here_vec), Ry.Dot(here_vec), Rz.Dot(here_vec)};
+      double const switcher = dx; // (1, 0, 0) . (dx, dy, dz)
+      SegmentFrame const frame{dx, dy, dz, std::abs(switcher) <= 0.995};
 
-          double const scx = rot_here.X();
-          double const scy = rot_here.Y();
-          double const scz = rot_here.Z();
+      double const here_vec[3]{segnx.at(j), segny.at(j), segnz.at(j)};
+      double rot_here[3];
+      frame.rotate(here_vec, rot_here);
 
-          double const azy = find_angle(scz, scy);
-          double const azx = find_angle(scz, scx);
+      double const scx = rot_here[0];
+      double const scy = rot_here[1];
+      double const scz = rot_here[2];
 
-          constexpr double ULim = 10000.0;
-          constexpr double LLim = -10000.0;
+      double const azy = find_angle(scz, scy);
+      double const azx = find_angle(scz, scx);
 
-          double const cL = kcal;
-          double const Li = segL.at(i);
-          double const Lj = segL.at(j);
+      constexpr double ULim = 10000.0;
+      constexpr double LLim = -10000.0;
 
-          if (azy <= ULim && azy >= LLim) {
-            ei.push_back(Li * cL);
-            ej.push_back(Lj * cL);
-            th.push_back(azy);
-            ind.push_back(2);
-          }
+      double const cL = kcal;
+      double const Li = segL.at(i);
+      double const Lj = segL.at(j);
 
-          if (azx <= ULim && azx >= LLim) {
-            ei.push_back(Li * cL);
-            ej.push_back(Lj * cL);
-            th.push_back(azx);
-            ind.push_back(1);
-          }
+      if (azy <= ULim && azy >= LLim) {
+        ei.push_back(Li * cL);
+        ej.push_back(Lj * cL);
+        th.push_back(azy);
+        ind.push_back(2);
+      }
 
-          break; // of course !
-        }
+      if (azx <= ULim && azx >= LLim) {
+        ei.push_back(Li * cL);
+        ej.push_back(Lj * cL);
+        th.push_back(azx);
+        ind.push_back(1);
       }
     }
 
@@ -543,24 +552,26 @@ namespace trkf {
       return -1.0;
     }
 
-    TGraphErrors gr_meas{n_steps, xmeas.data(), ymeas.data(), nullptr, eymeas.data()};
+    if (fMakeDiagnostics) {
+      gr_meas = TGraphErrors{static_cast<int>(xmeas.size()), xmeas.data(), ymeas.data(), nullptr, eymeas.data()};
 
-    gr_meas.SetTitle("(#Delta#theta)_{rms} versus material thickness; Material "
-                     "thickness in cm; (#Delta#theta)_{rms} in mrad");
+      gr_meas.SetTitle("(#Delta#theta)_{rms} versus material thickness; Material "
+                       "thickness in cm; (#Delta#theta)_{rms} in mrad");
 
-    gr_meas.SetLineColor(kBlack);
-    gr_meas.SetMarkerColor(kBlack);
-    gr_meas.SetMarkerStyle(20);
-    gr_meas.SetMarkerSize(1.2);
+      gr_meas.SetLineColor(kBlack);
+      gr_meas.SetMarkerColor(kBlack);
+      gr_meas.SetMarkerStyle(20);
+      gr_meas.SetMarkerSize(1.2);
 
-    gr_meas.GetXaxis()->SetLimits(steps.at(0) - steps.at(0),
-                                  steps.at(n_steps - 1) + steps.at(0));
-    gr_meas.SetMinimum(0.0);
-    gr_meas.SetMaximum(1.80 * ymax);
+      gr_meas.GetXaxis()->SetLimits(steps.at(0) - steps.at(0),
+                                    steps.at(n_steps - 1) + steps.at(0));
+      gr_meas.SetMinimum(0.0);
+      gr_meas.SetMaximum(1.80 * ymax);
+    }
 
     ROOT::Minuit2::Minuit2Minimizer mP{};
     FcnWrapper const wrapper{move(xmeas), move(ymeas), move(eymeas)};
-    ROOT::Math::Functor FCA([&wrapper](double const* xs) { return wrapper.my_mcs_chi2(xs); }, 2);
+    McsChi2Function const FCA{wrapper};
 
     mP.SetFunction(FCA);
     mP.SetLimitedVariable(0, "p_{MCS}", 1.0, 0.01, 0.001, 7.5);
@@ -599,6 +610,9 @@ namespace trkf {
       return false;
     }
 
+    if (!fMakeDiagnostics)
+      return true;
+
     // Here, we perform a const-cast to float* because, sadly,
     // TPolyLine3D requires a pointer to a non-const object.  We will
     // trust that ROOT does not mess around with the underlying data.
@@ -644,6 +658,9 @@ namespace trkf {
     int ntot = 0;
 
     n_seg = 0;
+    x_seg.clear();
+    y_seg.clear();
+    z_seg.clear();
 
     double x0{};
     double y0{};
@@ -674,9 +691,11 @@ namespace trkf {
 
         segL.push_back(stag);
 
-        x_seg[n_seg] = x0;
-        y_seg[n_seg] = y0;
-        z_seg[n_seg] = z0;
+        if (fMakeDiagnostics) {
+          x_seg.push_back(x0);
+          y_seg.push_back(y0);
+          z_seg.push_back(z0);
+        }
 
         n_seg++;
 
@@ -748,9 +767,11 @@ namespace trkf {
 
         segL.push_back(1.0 * n_seg * 1.0 * seg_size + stag);
 
-        x_seg[n_seg] = xp;
-        y_seg[n_seg] = yp;
-        z_seg[n_seg] = zp;
+        if (fMakeDiagnostics) {
+          x_seg.push_back(xp);
+          y_seg.push_back(yp);
+          z_seg.push_back(zp);
+        }
         n_seg++;
 
         x0 = xp;
@@ -778,59 +799,26 @@ namespace trkf {
         sumy /= na;
         sumz /= na;
 
-        std::vector<double> mx;
-        std::vector<double> my;
-        std::vector<double> mz;
-
-        TMatrixDSym m(3);
+        sbn::SymMatrix3 m;
 
         for (std::size_t i = 0; i < na; ++i) {
-          double const xxw1 = vx.at(i);
-          double const yyw1 = vy.at(i);
-          double const zzw1 = vz.at(i);
-
-          mx.push_back(xxw1 - sumx);
-          my.push_back(yyw1 - sumy);
-          mz.push_back(zzw1 - sumz);
-
-          double const xxw0 = mx.at(i);
-          double const yyw0 = my.at(i);
-          double const zzw0 = mz.at(i);
-
-          m(0, 0) += xxw0 * xxw0 / na;
-          m(0, 1) += xxw0 * yyw0 / na;
-          m(0, 2) += xxw0 * zzw0 / na;
-
-          m(1, 0) += yyw0 * xxw0 / na;
-          m(1, 1) += yyw0 * yyw0 / na;
-          m(1, 2) += yyw0 * zzw0 / na;
-
-          m(2, 0) += zzw0 * xxw0 / na;
-          m(2, 1) += zzw0 * yyw0 / na;
-          m(2, 2) += zzw0 * zzw0 / na;
+          double const xxw0 = vx.at(i) - sumx;
+          double const yyw0 = vy.at(i) - sumy;
+          double const zzw0 = vz.at(i) - sumz;
+
+          m.xx += xxw0 * xxw0 / na;
+          m.xy += xxw0 * yyw0 / na;
+          m.xz += xxw0 * zzw0 / na;
+          m.yy += yyw0 * yyw0 / na;
+          m.yz += yyw0 * zzw0 / na;
+          m.zz += zzw0 * zzw0 / na;
         }
 
-        TMatrixDSymEigen me(m);
-
-        TVectorD eigenval = me.GetEigenValues();
-        TMatrixD eigenvec = me.GetEigenVectors();
+        auto const axis = sbn::PrincipalAxis(m);
 
-        double max1 = -666.0;
-
-        double ind1 = 0;
-
-        for (int i = 0; i < 3; ++i) {
-          double const p1 = eigenval(i);
-
-          if (p1 > max1) {
-            max1 = p1;
-            ind1 = i;
-          }
-        }
-
-        double ax = eigenvec(0, ind1);
-        double ay = eigenvec(1, ind1);
-        double az = eigenvec(2, ind1);
+        double ax = axis[0];
+        double ay = axis[1];
+        double az = axis[2];
 
         if (n_seg > 1) {
           if (segx.at(n_seg - 1) - segx.at(n_seg - 2) > 0)
@@ -888,9 +876,11 @@ namespace trkf {
         segz.push_back(zp);
         segL.push_back(1.0 * n_seg * 1.0 * seg_size + stag);
 
-        x_seg[n_seg] = xp;
-        y_seg[n_seg] = yp;
-        z_seg[n_seg] = zp;
+        if (fMakeDiagnostics) {
+          x_seg.push_back(xp);
+          y_seg.push_back(yp);
+          z_seg.push_back(zp);
+        }
         n_seg++;
 
         x0 = xp;
@@ -921,58 +911,26 @@ namespace trkf {
         sumy /= na;
         sumz /= na;
 
-        std::vector<double> mx;
-        std::vector<double> my;
-        std::vector<double> mz;
-
-        TMatrixDSym m(3);
+        sbn::SymMatrix3 m;
 
         for (int i = 0; i < na; ++i) {
-          double const xxw1 = vx.at(i);
-          double const yyw1 = vy.at(i);
-          double const zzw1 = vz.at(i);
-
-          mx.push_back(xxw1 - sumx);
-          my.push_back(yyw1 - sumy);
-          mz.push_back(zzw1 - sumz);
-
-          double const xxw0 = mx.at(i);
-          double const yyw0 = my.at(i);
-          double const zzw0 = mz.at(i);
-
-          m(0, 0) += xxw0 * xxw0 / na;
-          m(0, 1) += xxw0 * yyw0 / na;
-          m(0, 2) += xxw0 * zzw0 / na;
-
-          m(1, 0) += yyw0 * xxw0 / na;
-          m(1, 1) += yyw0 * yyw0 / na;
-          m(1, 2) += yyw0 * zzw0 / na;
-
-          m(2, 0) += zzw0 * xxw0 / na;
-          m(2, 1) += zzw0 * yyw0 / na;
-          m(2, 2) += zzw0 * zzw0 / na;
+          double const xxw0 = vx.at(i) - sumx;
+          double const yyw0 = vy.at(i) - sumy;
+          double const zzw0 = vz.at(i) - sumz;
+
+          m.xx += xxw0 * xxw0 / na;
+          m.xy += xxw0 * yyw0 / na;
+          m.xz += xxw0 * zzw0 / na;
+          m.yy += yyw0 * yyw0 / na;
+          m.yz += yyw0 * zzw0 / na;
+          m.zz += zzw0 * zzw0 / na;
         }
 
-        TMatrixDSymEigen me(m);
-
-        TVectorD eigenval = me.GetEigenValues();
-        TMatrixD eigenvec = me.GetEigenVectors();
-
-        double max1 = -666.0;
-        double ind1 = 0;
-
-        for (int i = 0; i < 3; ++i) {
-          double const p1 = eigenval(i);
-
-          if (p1 > max1) {
-            max1 = p1;
-            ind1 = i;
-          }
-        }
+        auto const axis = sbn::PrincipalAxis(m);
 
-        double ax = eigenvec(0, ind1);
-        double ay = eigenvec(1, ind1);
-        double az = eigenvec(2, ind1);
+        double ax = axis[0];
+        double ay = axis[1];
+        double az = axis[2];
 
         if (n_seg > 1) {
           if (segx.at(n_seg - 1) - segx.at(n_seg - 2) > 0)
@@ -1015,11 +973,13 @@ namespace trkf {
         break;
     }
 
-    delete gr_seg_xyz;
-    gr_seg_xyz = new TPolyLine3D{n_seg, z_seg, x_seg, y_seg};
-    gr_seg_yz = TGraph{n_seg, z_seg, y_seg};
-    gr_seg_xz = TGraph{n_seg, z_seg, x_seg};
-    gr_seg_xy = TGraph{n_seg, x_seg, y_seg};
+    if (fMakeDiagnostics) {
+      delete gr_seg_xyz;
+      gr_seg_xyz = new TPolyLine3D{n_seg, z_seg.data(), x_seg.data(), y_seg.data()};
+      gr_seg_yz = TGraph{n_seg, z_seg.data(), y_seg.data()};
+      gr_seg_xz = TGraph{n_seg, z_seg.data(), x_seg.data()};
+      gr_seg_xy = TGraph{n_seg, x_seg.data(), y_seg.data()};
+    }
 
     return std::make_optional<Segments>(Segments{segx, segnx, segy, segny, segz, segnz, segL});
   }
@@ -1048,66 +1008,37 @@ namespace trkf {
 
     std::vector<float> buf0;
 
+    // Same pairing as in getDeltaThetaij_
+    int j = 0;
     for (int i = 0; i < tot; i++) {
-      double const dx = segnx.at(i);
-      double const dy = segny.at(i);
-      double const dz = segnz.at(i);
-
-      TVector3 const vec_z{dx, dy, dz};
-      TVector3 vec_x;
-      TVector3 vec_y;
-
-      double const switcher = basex.Dot(vec_z);
-
-      if (switcher <= 0.995) {
-        vec_y = vec_z.Cross(basex).Unit();
-        vec_x = vec_y.Cross(vec_z);
-      }
-      else {
-        // cout << " It switched ! Isn't this lovely !!! " << endl;
-        vec_y = basez.Cross(vec_z).Unit();
-        vec_x = vec_y.Cross(vec_z);
-      }
-
-      TVector3 const Rx{vec_x.Dot(basex), vec_x.Dot(basey), vec_x.Dot(basez)};
-      TVector3 const Ry{vec_y.Dot(basex), vec_y.Dot(basey), vec_y.Dot(basez)};
-      TVector3 const Rz{vec_z.Dot(basex), vec_z.Dot(basey), vec_z.Dot(basez)};
-
       double const refL = segL.at(i);
 
-      for (int j = i; j < tot; j++) {
-        double const L1 = segL.at(j);
-        double const L2 = segL.at(j + 1);
-
-        double const dz1 = L1 - refL;
-        double const dz2 = L2 - refL;
+      if (j < i) j = i;
+      while (j < tot && !(segL.at(j + 1) - refL > thick1))
+        j++;
+      if (j == tot) break;
 
-        if (dz1 <= thick1 && dz2 > thick1) {
-          double const here_dx = segnx.at(j);
-          double const here_dy = segny.at(j);
-          double const here_dz = segnz.at(j);
-
-          TVector3 const here_vec{here_dx, here_dy, here_dz};
-          TVector3 const rot_here{Rx.Dot(here_vec), Ry.Dot(here_vec), Rz.Dot(here_vec)};
+      double const dx = segnx.at(i);
+      double const dy = segny.at(i);
+      double const dz = segnz.at(i);
 
-          double const scx = rot_here.X();
-          double const scy = rot_here.Y();
-          double const scz = rot_here.Z();
+      double const switcher = dx; // (1, 0, 0) . (dx, dy, dz)
+      SegmentFrame const frame{dx, dy, dz, switcher <= 0.995};
 
-          double azy = find_angle(scz, scy);
-          azy *= 1.0;
+      double const here_vec[3]{segnx.at(j), segny.at(j), segnz.at(j)};
+      double rot_here[3];
+      frame.rotate(here_vec, rot_here);
 
-          double const azx = find_angle(scz, scx);
+      double const scx = rot_here[0];
+      double const scz = rot_here[2];
 
-          double const ULim = 10000.0;
-          double const LLim = -10000.0;
+      double const azx = find_angle(scz, scx);
 
-          if (azx <= ULim && azx >= LLim) {
-            buf0.push_back(azx);
-          }
+      double const ULim = 10000.0;
+      double const LLim = -10000.0;
 
-          break; // of course !
-        }
+      if (azx <= ULim && azx >= LLim) {
+        buf0.push_back(azx);
       }
     }
 
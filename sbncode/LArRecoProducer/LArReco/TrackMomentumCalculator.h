@@ -12,9 +12,6 @@
 #include "TGraph.h"
 #include "TGraphErrors.h"
 #include "TMath.h"
-#include "TMatrixD.h"
-#include "TMatrixDSym.h"
-#include "TMatrixDSymEigen.h"
 #include "TPolyLine3D.h"
 #include "TSpline.h"
 #include "TVector3.h"
@@ -39,8 +36,12 @@ namespace trkf {
 
   class TrackMomentumCalculator {
   public:
+    /// \param makeDiagnostics also build the graphs of the tracks, of
+    ///        their segments and of the MCS chi2 measurements; off for
+    ///        production, where nothing reads them
     TrackMomentumCalculator(double minLength = 100.0,
-                            double maxLength = 1350.0);
+                            double maxLength = 1350.0,
+                            bool makeDiagnostics = false);
 
     double GetTrackMomentum(double trkrange, int pdg) const;
     double GetMomentumMultiScatterChi2(art::Ptr<recob::Track> const& trk);
@@ -86,9 +87,10 @@ namespace trkf {
     float seg_stop{-1.};
     int n_seg{};
 
-    float x_seg[50000];
-    float y_seg[50000];
-    float z_seg[50000];
+    // segment end points, only kept for the diagnostic graphs
+    std::vector<float> x_seg;
+    std::vector<float> y_seg;
+    std::vector<float> z_seg;
 
     double find_angle(double vz, double vy) const;
 
@@ -99,11 +101,10 @@ namespace trkf {
     double minLength;
     double maxLength;
 
+    bool fMakeDiagnostics;
+
     // The following are objects that are created but not drawn or
-    // saved.  This class should consider accepting a "debug"
-    // parameter where if it is specified, then the graphs will be
-    // created; otherwise, their creation is unnecessary and impedes
-    // efficiency.
+    // saved, only when fMakeDiagnostics is set.
     //
     // N.B. TPolyLine3D objects are owned by ROOT, and we thus refer
     // to them by pointer.  It is important that 'delete' is not
@@ -119,6 +120,8 @@ namespace trkf {
     TGraph gr_seg_yz{};
     TGraph gr_seg_xz{};
 
+    TGraphErrors gr_meas{};
+
   };
 
 } // namespace trkf
@@ -1,59 +1,92 @@
 #include "TrajectoryMCSFitter.h"
+#include "PrincipalAxis.h"
+#include "RangeTables.h"
 #include "lardataobj/RecoBase/Track.h"
-#include "larcorealg/Geometry/geo_vectors_utils.h"
-#include "TMatrixDSym.h"
-#include "TMatrixDSymEigen.h"
+
+#include "tbb/enumerable_thread_specific.h"
+#include "tbb/parallel_for.h"
 
 using namespace std;
 using namespace trkf;
 using namespace recob::tracking;
 
 recob::MCSFitResult TrajectoryMCSFitter::fitMcs(const recob::TrackTrajectory& traj, int pid, bool momDepConst) const {
+  Workspace ws;
+  measureSegments(traj, ws);
+  return fitSegments(ws, pid, momDepConst);
+}
+
+std::vector<std::vector<recob::MCSFitResult>> TrajectoryMCSFitter::fitMcsBatch(const std::vector<const recob::TrackTrajectory*>& trajs, const std::vector<int>& pids, bool momDepConst, bool parallel) const {
+  std::vector<std::vector<recob::MCSFitResult>> results(pids.size(), std::vector<recob::MCSFitResult>(trajs.size()));
+  //
+  // The segments and their angles do not depend on the pid: measure them
+  // once per trajectory, then scan for each pid
+  auto fitOne = [&](size_t itraj, Workspace& ws) {
+    measureSegments(*trajs[itraj], ws);
+    for (size_t ipid = 0; ipid < pids.size(); ipid++) results[ipid][itraj] = fitSegments(ws, pids[ipid], momDepConst);
+  };
+  //
+  if (parallel) {
+    tbb::enumerable_thread_specific<Workspace> workspaces;
+    tbb::parallel_for(size_t(0), trajs.size(), [&](size_t itraj) { fitOne(itraj, workspaces.local()); });
+  } else {
+    Workspace ws;
+    for (size_t itraj = 0; itraj < trajs.size(); itraj++) fitOne(itraj, ws);
+  }
+  return results;
+}
+
+void TrajectoryMCSFitter::measureSegments(const recob::TrackTrajectory& traj, Workspace& ws) const {
+  ws.breakpoints.clear();
+  ws.segradlengths.clear();
+  ws.cumseglens.clear();
+  ws.dtheta.clear();
+  ws.cumLenFwd.clear();
+  ws.cumLenBwd.clear();
   //
   // Break the trajectory in segments of length approximately equal to segLen_
   //
-  vector<size_t> breakpoints;
-  vector<float> segradlengths;
-  vector<float> cumseglens;
-  breakTrajInSegments(traj, breakpoints, segradlengths, cumseglens);
+  breakTrajInSegments(traj, ws.breakpoints, ws.segradlengths, ws.cumseglens);
   //
   // Fit segment directions, and get 3D angles between them
   //
-  if (segradlengths.size()<2) return recob::MCSFitResult();
-  vector<float> dtheta;
+  if (ws.segradlengths.size()<2) return;
   Vector_t pcdir0;
   Vector_t pcdir1;
-  for (unsigned int p = 0; p<segradlengths.size(); p++) {
-    linearRegression(traj, breakpoints[p], breakpoints[p+1], pcdir1);
+  for (unsigned int p = 0; p<ws.segradlengths.size(); p++) {
+    linearRegression(traj, ws.breakpoints[p], ws.breakpoints[p+1], pcdir1, ws);
     if (p>0) {
-      if (segradlengths[p]<-100. || segradlengths[p-1]<-100.) {
-	dtheta.push_back(-999.);
+      if (ws.segradlengths[p]<-100. || ws.segradlengths[p-1]<-100.) {
+	ws.dtheta.push_back(-999.);
       } else { 
 	const double cosval = pcdir0.X()*pcdir1.X()+pcdir0.Y()*pcdir1.Y()+pcdir0.Z()*pcdir1.Z();
 	//assert(std::abs(cosval)<=1);
 	//units are mrad
 	double dt = 1000.*acos(cosval);//should we try to use expansion for small angles?
-	dtheta.push_back(dt);
+	ws.dtheta.push_back(dt);
       }
     }
     pcdir0 = pcdir1;
   }
   //
+  for (unsigned int i = 0; i<ws.cumseglens.size()-2; i++) {
+    ws.cumLenFwd.push_back(ws.cumseglens[i]);
+    ws.cumLenBwd.push_back(ws.cumseglens.back()-ws.cumseglens[i+2]);
+  }
+}
+
+recob::MCSFitResult TrajectoryMCSFitter::fitSegments(Workspace& ws, int pid, bool momDepConst) const {
+  if (ws.segradlengths.size()<2) return recob::MCSFitResult();
+  //
   // Perform likelihood scan in forward and backward directions
   //
-  vector<float> cumLenFwd;
-  vector<float> cumLenBwd;
-  for (unsigned int i = 0; i<cumseglens.size()-2; i++) {
-    cumLenFwd.push_back(cumseglens[i]);
-    cumLenBwd.push_back(cumseglens.back()-cumseglens[i+2]);
-  }
-  const ScanResult fwdResult = doLikelihoodScan(dtheta, segradlengths, cumLenFwd, true,  momDepConst, pid);
-  const ScanResult bwdResult = doLikelihoodScan(dtheta, segradlengths, cumLenBwd, false, momDepConst, pid);
+  const ScanResult fwdResult = doLikelihoodScan(ws.dtheta, ws.segradlengths, ws.cumLenFwd, true,  momDepConst, pid, ws.vlogL);
+  const ScanResult bwdResult = doLikelihoodScan(ws.dtheta, ws.segradlengths, ws.cumLenBwd, false, momDepConst, pid, ws.vlogL);
   //
   return recob::MCSFitResult(pid,
 			     fwdResult.p,fwdResult.pUnc,fwdResult.logL,
 			     bwdResult.p,bwdResult.pUnc,bwdResult.logL,
-			     segradlengths,dtheta);
+			     ws.segradlengths,ws.dtheta);
 }
 
 void TrajectoryMCSFitter::breakTrajInSegments(const recob::TrackTrajectory& traj, vector<size_t>& breakpoints, vector<float>& segradlengths, vector<float>& cumseglens) const {
@@ -96,10 +129,15 @@ void TrajectoryMCSFitter::breakTrajInSegments(const recob::TrackTrajectory& traj
 }
 
 const TrajectoryMCSFitter::ScanResult TrajectoryMCSFitter::doLikelihoodScan(std::vector<float>& dtheta, std::vector<float>& seg_nradlengths, std::vector<float>& cumLen, bool fwdFit, bool momDepConst, int pid) const {
+  std::vector<float> vlogL;
+  return doLikelihoodScan(dtheta, seg_nradlengths, cumLen, fwdFit, momDepConst, pid, vlogL);
+}
+
+const TrajectoryMCSFitter::ScanResult TrajectoryMCSFitter::doLikelihoodScan(std::vector<float>& dtheta, std::vector<float>& seg_nradlengths, std::vector<float>& cumLen, bool fwdFit, bool momDepConst, int pid, std::vector<float>& vlogL) const {
   int    best_idx  = -1;
   double best_logL = std::numeric_limits<double>::max();
   double best_p    = -1.0;
-  std::vector<float> vlogL;
+  vlogL.clear();
   for (double p_test = pMin_; p_test <= pMax_; p_test+=pStep_) {
     double logL = mcsLikelihood(p_test, angResol_, dtheta, seg_nradlengths, cumLen, fwdFit, momDepConst, pid);
     if (logL < best_logL) {
@@ -134,53 +172,30 @@ const TrajectoryMCSFitter::ScanResult TrajectoryMCSFitter::doLikelihoodScan(std:
 }
 
 void TrajectoryMCSFitter::linearRegression(const recob::TrackTrajectory& traj, const size_t firstPoint, const size_t lastPoint, Vector_t& pcdir) const {
+  Workspace ws;
+  linearRegression(traj, firstPoint, lastPoint, pcdir, ws);
+}
+
+void TrajectoryMCSFitter::linearRegression(const recob::TrackTrajectory& traj, const size_t firstPoint, const size_t lastPoint, Vector_t& pcdir, Workspace& ws) const {
   //
-  int npoints = 0;
-  geo::vect::MiddlePointAccumulator middlePointCalc;
+  // copy the points to contiguous arrays for the principal axis kernel
+  ws.px.clear();
+  ws.py.clear();
+  ws.pz.clear();
   size_t nextValid = firstPoint;
-  while (nextValid<lastPoint) {
-    middlePointCalc.add(traj.LocationAtPoint(nextValid));
-    nextValid = traj.NextValidPoint(nextValid+1);
-    npoints++;
-  }
-  const auto avgpos = middlePointCalc.middlePoint();
-  const double norm = 1./double(npoints);
-  //
-  //assert(npoints>0);
-  //
-  TMatrixDSym m(3);
-  nextValid = firstPoint;
   while (nextValid<lastPoint) {
     const auto p = traj.LocationAtPoint(nextValid);
-    const double xxw0 = p.X()-avgpos.X();
-    const double yyw0 = p.Y()-avgpos.Y();
-    const double zzw0 = p.Z()-avgpos.Z();
-    m(0, 0) += xxw0*xxw0*norm;
-    m(0, 1) += xxw0*yyw0*norm;
-    m(0, 2) += xxw0*zzw0*norm;
-    m(1, 0) += yyw0*xxw0*norm;
-    m(1, 1) += yyw0*yyw0*norm;
-    m(1, 2) += yyw0*zzw0*norm;
-    m(2, 0) += zzw0*xxw0*norm;
-    m(2, 1) += zzw0*yyw0*norm;
-    m(2, 2) += zzw0*zzw0*norm;
+    ws.px.push_back(p.X());
+    ws.py.push_back(p.Y());
+    ws.pz.push_back(p.Z());
     nextValid = traj.NextValidPoint(nextValid+1);
   }
   //
-  const TMatrixDSymEigen me(m);
-  const auto& eigenval = me.GetEigenValues();
-  const auto& eigenvec = me.GetEigenVectors();
+  //assert(!ws.px.empty());
   //
-  int maxevalidx = 0;
-  double maxeval = eigenval(0);
-  for (int i=1; i<3; ++i) {
-    if (eigenval(i)>maxeval) {
-      maxevalidx = i;
-      maxeval = eigenval(i);
-    }
-  } 
+  const std::array<double, 3> axis = sbn::PrincipalAxis(ws.px.data(), ws.py.data(), ws.pz.data(), ws.px.size());
   //
-  pcdir = Vector_t(eigenvec(0, maxevalidx),eigenvec(1, maxevalidx),eigenvec(2, maxevalidx));
+  pcdir = Vector_t(axis[0], axis[1], axis[2]);
   if (traj.DirectionAtPoint(firstPoint).Dot(pcdir)<0.) pcdir*=-1.;
   //
 }
@@ -198,6 +213,12 @@ double TrajectoryMCSFitter::mcsLikelihood(double p, double theta0x, std::vector<
   const double Etot = sqrt(p*p + m2);//Initial energy
   double Eij2 = 0.;
   //
+  // ELoss mode 3: range of the particle, from which each segment takes cumLen;
+  // negative if the tables do not cover it, then Bethe-Bloch steps are used.
+  // The tables are read at their own argon density.
+  const sbn::RangeTables& rangeTables = sbn::RangeTables::Instance();
+  const double range = (eLossMode_==3 ? rangeTables.RangeFromKE(pid, 1000.*(Etot-m)) : -1.);
+  //
   double const fixedterm = 0.5 * std::log( 2.0 * M_PI );
   double result = 0;
   for (int i = beg; i != end; i+=incr ) {
@@ -211,6 +232,11 @@ double TrajectoryMCSFitter::mcsLikelihood(double p, double theta0x, std::vector<
       constexpr double kcal = 0.002105;
       const double Eij = Etot - kcal*cumLen[i];//energy at this segment
       Eij2 = Eij*Eij;
+    } else if (range>=0.) {
+      // ELoss mode: CSDA range tables, energy of the particle with the range left
+      const double rangeLeft = range - cumLen[i];
+      const double Eij = (rangeLeft > 0. ? m + 0.001*rangeTables.KEFromRange(pid, rangeLeft) : 0.);
+      Eij2 = Eij*Eij;
     } else {
       // Non constant energy loss distribution
       const double Eij = GetE(Etot,cumLen[i],m);
@@ -288,7 +314,7 @@ double TrajectoryMCSFitter::GetE(const double initial_E, const double length_tra
   const double m2 = m*m;
   //
   for (auto i = 0; i < nElossSteps_; ++i) {
-    if (eLossMode_==2) {
+    if (eLossMode_==2 || eLossMode_==3) {
       double dedx = energyLossBetheBloch(m,current_E);
       current_E -= (dedx * step_size);
     } else {
@@ -64,7 +64,7 @@ namespace trkf {
       };
       fhicl::Atom<int> eLossMode {
         Name("eLossMode"),
-	Comment("Default is MPV Landau. Choose 1 for MIP (constant); 2 for Bethe-Bloch."),
+	Comment("Default is MPV Landau. Choose 1 for MIP (constant); 2 for Bethe-Bloch; 3 for the CSDA range tables."),
 	0
       };
       fhicl::Atom<double> pMin {
@@ -117,6 +117,13 @@ namespace trkf {
       return fitMcs(tt,pid,momDepConst);
     }
     //
+    /// Fits every trajectory in \a trajs with every pid in \a pids: results[i][j] is
+    /// for pids[i] and trajs[j], the same as fitMcs(*trajs[j], pids[i], momDepConst).
+    /// The segments and their angles are measured once per trajectory for all the pids,
+    /// in buffers reused from one trajectory to the next. With \a parallel set the
+    /// trajectories are fitted concurrently, in TBB tasks.
+    std::vector<std::vector<recob::MCSFitResult>> fitMcsBatch(const std::vector<const recob::TrackTrajectory*>& trajs, const std::vector<int>& pids, bool momDepConst = true, bool parallel = false) const;
+    //
     void breakTrajInSegments(const recob::TrackTrajectory& traj, std::vector<size_t>& breakpoints, std::vector<float>& segradlengths, std::vector<float>& cumseglens) const;
     void linearRegression(const recob::TrackTrajectory& traj, const size_t firstPoint, const size_t lastPoint, recob::tracking::Vector_t& pcdir) const;
     double mcsLikelihood(double p, double theta0x, std::vector<float>& dthetaij, std::vector<float>& seg_nradl, std::vector<float>& cumLen, bool fwd, bool momDepConst, int pid) const;
@@ -148,6 +155,24 @@ namespace trkf {
     double GetE(const double initial_E, const double length_travelled, const double mass) const;
     //
   private:
+    //
+    // The segments of a trajectory and the scan buffers; kept across fits so
+    // that the vectors keep their capacity
+    struct Workspace {
+      std::vector<size_t> breakpoints;
+      std::vector<float> segradlengths;
+      std::vector<float> cumseglens;
+      std::vector<float> dtheta;
+      std::vector<float> cumLenFwd;
+      std::vector<float> cumLenBwd;
+      std::vector<float> vlogL;
+      std::vector<double> px, py, pz; ///< points of the segment in linearRegression
+    };
+    void measureSegments(const recob::TrackTrajectory& traj, Workspace& ws) const;
+    recob::MCSFitResult fitSegments(Workspace& ws, int pid, bool momDepConst) const;
+    void linearRegression(const recob::TrackTrajectory& traj, const size_t firstPoint, const size_t lastPoint, recob::tracking::Vector_t& pcdir, Workspace& ws) const;
+    const ScanResult doLikelihoodScan(std::vector<float>& dtheta, std::vector<float>& seg_nradlengths, std::vector<float>& cumLen, bool fwdFit, bool momDepConst, int pid, std::vector<float>& vlogL) const;
+    //
     int    pIdHyp_;
     int    minNSegs_;
     double segLen_;
@@ -47,6 +47,7 @@ private:
   trkf::TrajectoryMCSFitter fMCSCalculator;
   art::InputTag fTrackLabel;
   float fMinTrackLength;
+  bool fParallelFits;
 };
 
 const static std::vector<int> PIDs {13, 211, 321, 2212};
@@ -57,7 +58,8 @@ sbn::MCSFitAllPID::MCSFitAllPID(fhicl::ParameterSet const& p)
     // fMCSCalculator(p.get<fhicl::Table<trkf::TrajectoryMCSFitter::Config>>("MCS")),
     fMCSCalculator(p.get<fhicl::ParameterSet>("MCS")),
     fTrackLabel(p.get<art::InputTag>("TrackLabel", "pandoraTrack")),
-    fMinTrackLength(p.get<float>("MinTrackLength", 10.))
+    fMinTrackLength(p.get<float>("MinTrackLength", 10.)),
+    fParallelFits(p.get<bool>("ParallelFits", false))
 {
   for (unsigned i = 0; i < names.size(); i++) {
     produces<std::vector<recob::MCSFitResult>>(names[i]);
@@ -75,15 +77,24 @@ void sbn::MCSFitAllPID::produce(art::Event& e)
   std::vector<art::Ptr<recob::Track>> tracks;
   art::fill_ptr_vector(tracks, track_handle);
 
+  std::vector<art::Ptr<recob::Track>> fitTracks;
+  std::vector<const recob::TrackTrajectory*> trajs;
+  for (const art::Ptr<recob::Track> track: tracks) {
+    if (fMinTrackLength > 0. && track->Length() < fMinTrackLength) continue;
+    fitTracks.push_back(track);
+    trajs.push_back(&track->Trajectory());
+  }
+
+  // all the tracks with all the hypotheses at once
+  std::vector<std::vector<recob::MCSFitResult>> results = fMCSCalculator.fitMcsBatch(trajs, PIDs, true, fParallelFits);
+
   for (unsigned i = 0; i < PIDs.size(); i++) {
     std::unique_ptr<std::vector<recob::MCSFitResult>> mcscol(new std::vector<recob::MCSFitResult>);
     std::unique_ptr<art::Assns<recob::Track, recob::MCSFitResult>> assn(new art::Assns<recob::Track, recob::MCSFitResult>);
 
-    for (const art::Ptr<recob::Track> track: tracks) {
-      if (fMinTrackLength > 0. && track->Length() < fMinTrackLength) continue;
-
-      mcscol->push_back(fMCSCalculator.fitMcs(*track, PIDs[i]));        
-      util::CreateAssn(*this, e, *mcscol, track, *assn, names[i]);
+    for (unsigned j = 0; j < fitTracks.size(); j++) {
+      mcscol->push_back(std::move(results[i][j]));
+      util::CreateAssn(*this, e, *mcscol, fitTracks[j], *assn, names[i]);
     }
 
     e.put(std::move(mcscol), names[i]);
@@ -14,6 +14,7 @@
 #include "art/Framework/Principal/Run.h"
 #include "art/Framework/Principal/SubRun.h"
 #include "canvas/Utilities/InputTag.h"
+#include "cetlib_except/exception.h"
 #include "fhiclcpp/ParameterSet.h"
 #include "messagefacility/MessageLogger/MessageLogger.h"
 
@@ -50,6 +51,7 @@ private:
   unsigned fNPMTAboveThreshold;
   int fPMTTriggerThreshold;
   bool fStoreDataProduct;
+  bool fRunLengthEncoded;
 
   bool HasTrigger(const std::vector<FlashTriggerPrimitive> &primitives, int threshold, unsigned n_above_threshold);
 };
@@ -60,7 +62,8 @@ sbn::PMTFlashTriggerFilter::PMTFlashTriggerFilter(fhicl::ParameterSet const& p)
     fFlashTriggerPrimitiveLabel(p.get<std::string>("FlashTriggerPrimitiveLabel")),
     fNPMTAboveThreshold(p.get<unsigned>("NPMTAboveThreshold")),
     fPMTTriggerThreshold(p.get<int>("PMTTriggerThreshold")),
-    fStoreDataProduct(p.get<bool>("StoreDataProduct", false))
+    fStoreDataProduct(p.get<bool>("StoreDataProduct", false)),
+    fRunLengthEncoded(p.get<bool>("RunLengthEncoded", false))
   // More initializers here.
 {
 
@@ -70,7 +73,25 @@ sbn::PMTFlashTriggerFilter::PMTFlashTriggerFilter(fhicl::ParameterSet const& p)
 bool sbn::PMTFlashTriggerFilter::filter(art::Event& e)
 {
   art::Handle<std::vector<sbn::FlashTriggerPrimitive>> flashtrig_handle;
-  e.getByLabel(fFlashTriggerPrimitiveLabel, flashtrig_handle);
+  if (fRunLengthEncoded) {
+    const art::InputTag runs_tag(fFlashTriggerPrimitiveLabel.label(), "runs", fFlashTriggerPrimitiveLabel.process());
+    e.getByLabel(runs_tag, flashtrig_handle);
+
+    // every sample of a run is counted, which gives the samples at or below
+    // the threshold of the runs: a stricter threshold cannot be applied, and
+    // a looser one would also need the samples above it, which the runs do
+    // not hold
+    art::Handle<int> runs_threshold_handle;
+    e.getByLabel(runs_tag, runs_threshold_handle);
+    if (runs_threshold_handle.isValid() && *runs_threshold_handle != fPMTTriggerThreshold) {
+      throw cet::exception("PMTFlashTriggerFilter") << "PMTTriggerThreshold " << fPMTTriggerThreshold
+        << " differs from the RunLengthThreshold " << *runs_threshold_handle
+        << " of the run-length encoded primitives" << std::endl;
+    }
+  }
+  else {
+    e.getByLabel(fFlashTriggerPrimitiveLabel, flashtrig_handle);
+  }
 
   bool ret = false;
   if (flashtrig_handle.isValid()) {
@@ -92,6 +113,17 @@ bool sbn::PMTFlashTriggerFilter::HasTrigger(const std::vector<sbn::FlashTriggerP
   std::map<int, std::vector<unsigned>> above_threshold;
 
   for (const sbn::FlashTriggerPrimitive &primitive: primitives) {
+    if (fRunLengthEncoded) {
+      // (first, last) sample pairs of the runs at or below the threshold
+      for (unsigned i = 0; i + 1 < primitive.triggers.size(); i += 2) {
+        const sbn::FlashTriggerPrimitive::Trig &first = primitive.triggers[i];
+        const sbn::FlashTriggerPrimitive::Trig &last = primitive.triggers[i+1];
+        for (int tdc = first.tdc; tdc <= last.tdc; tdc++) {
+          above_threshold[tdc].push_back(primitive.channel);
+        }
+      }
+      continue;
+    }
     for (const sbn::FlashTriggerPrimitive::Trig &trig: primitive.triggers) {
       if (trig.adc <= threshold) {
         above_threshold[trig.tdc].push_back(primitive.channel);
@@ -5,10 +5,16 @@
 //
 // Generated at Wed Feb 19 17:38:21 2020 by Gray Putnam using cetskelgen
 // from cetlib version v3_07_02.
+//
+// With RunLengthEncode, the primitives go to the "runs" instance instead,
+// where the triggers of a channel are (first, last) pairs of the samples
+// of each run at or below RunLengthThreshold, both with the lowest ADC of
+// the run; the "runs" instance of int holds RunLengthThreshold.
 ////////////////////////////////////////////////////////////////////////
 
 
 #include "sbncode/OpDet/PDMapAlg.h"
+#include "LArReco/ThresholdScan.h"
 #include "sbnobj/Common/Reco/FlashTriggerPrimitive.hh"
 
 #include "lardataalg/DetectorInfo/DetectorClocksStandard.h"
@@ -26,9 +32,11 @@
 #include "art/Utilities/make_tool.h"
 
 #include "canvas/Utilities/InputTag.h"
+#include "cetlib_except/exception.h"
 #include "fhiclcpp/ParameterSet.h"
 #include "messagefacility/MessageLogger/MessageLogger.h"
 
+#include <algorithm>
 #include <memory>
 #include <iostream>
 #include <vector>
@@ -59,6 +67,8 @@ private:
   std::pair<double, double> fTriggerWindow;
   int fTriggerThreshold;
   bool fOffsetTriggerTime;
+  bool fRunLengthEncode;
+  int fRunLengthThreshold;
 
   std::unique_ptr<opdet::PDMapAlg> fPDMapAlgPtr;
 
@@ -76,9 +86,22 @@ sbn::PMTFlashTriggerMaker::PMTFlashTriggerMaker(fhicl::ParameterSet const& p)
     fExperiment(p.get<std::string>("Experiment")),
     fTriggerWindow({p.get<float>("TriggerStart"), p.get<float>("TriggerEnd")}),
     fTriggerThreshold(p.get<int>("TriggerThreshold")),
-    fOffsetTriggerTime(p.get<bool>("OffsetTriggerTime"))
+    fOffsetTriggerTime(p.get<bool>("OffsetTriggerTime")),
+    fRunLengthEncode(p.get<bool>("RunLengthEncode", false)),
+    fRunLengthThreshold(p.get<int>("RunLengthThreshold", fTriggerThreshold))
 {
-  produces< std::vector<sbn::FlashTriggerPrimitive> >();
+  if (fRunLengthEncode) {
+    // the runs are of samples the primitives would hold
+    if (fRunLengthThreshold > fTriggerThreshold) {
+      throw cet::exception("PMTFlashTriggerMaker") << "RunLengthThreshold " << fRunLengthThreshold
+        << " is above TriggerThreshold " << fTriggerThreshold << std::endl;
+    }
+    produces< std::vector<sbn::FlashTriggerPrimitive> >("runs");
+    produces< int >("runs");
+  }
+  else {
+    produces< std::vector<sbn::FlashTriggerPrimitive> >();
+  }
 
   fPDMapAlgPtr = art::make_tool<opdet::PDMapAlg>(p.get<fhicl::ParameterSet>("PDMapAlg"));
 
@@ -106,10 +129,16 @@ void sbn::PMTFlashTriggerMaker::produce(art::Event& e)
     double tick_period = clock_data.OpticalClock().TickPeriod();
     //bool is_sbnd = fExperiment == "SBND"; //replace with PDMapAlgPtr
 
-   *trigs = TriggerPrimitives(waveforms, tick_period, window, fTriggerThreshold);
+   *trigs = TriggerPrimitives(waveforms, tick_period, window, fRunLengthEncode ? fRunLengthThreshold : fTriggerThreshold);
   }
 
-  e.put(std::move(trigs));
+  if (fRunLengthEncode) {
+    e.put(std::move(trigs), "runs");
+    e.put(std::make_unique<int>(fRunLengthThreshold), "runs");
+  }
+  else {
+    e.put(std::move(trigs));
+  }
 }
 
 std::vector<sbn::FlashTriggerPrimitive> sbn::PMTFlashTriggerMaker::TriggerPrimitives(const std::vector<raw::OpDetWaveform> &waveforms, 
@@ -132,12 +161,22 @@ std::vector<sbn::FlashTriggerPrimitive> sbn::PMTFlashTriggerMaker::TriggerPrimit
     if (waveform_index_start < waveform_index_end) {
       sbn::FlashTriggerPrimitive prim;
       prim.channel = wvf.ChannelNumber();
-      for (int i = waveform_index_start; i < waveform_index_end; i++) {
-        if (wvf[i] <= thresh) { // PMT waveforms go down
-          FlashTriggerPrimitive::Trig this_trig {wvf[i], i + (int)((waveform_start - window.first) / tick_period)};
-          prim.triggers.push_back(this_trig);
+      int tdc_offset = (int)((waveform_start - window.first) / tick_period);
+      // PMT waveforms go down
+      sbn::ForEachRunAtOrBelow(wvf.data(), waveform_index_start, waveform_index_end, thresh, [&](size_t begin, size_t end) {
+        if (fRunLengthEncode) {
+          // the run as its first and last samples, both with its lowest ADC
+          raw::ADC_Count_t min_adc = *std::min_element(wvf.begin() + begin, wvf.begin() + end);
+          prim.triggers.push_back(FlashTriggerPrimitive::Trig {min_adc, (int)begin + tdc_offset});
+          prim.triggers.push_back(FlashTriggerPrimitive::Trig {min_adc, (int)end - 1 + tdc_offset});
+        }
+        else {
+          for (size_t i = begin; i < end; i++) {
+            FlashTriggerPrimitive::Trig this_trig {wvf[i], (int)i + tdc_offset};
+            prim.triggers.push_back(this_trig);
+          }
         }
-      }
+      });
       ret.push_back(prim);
     }
   }
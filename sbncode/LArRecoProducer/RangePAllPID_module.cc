@@ -18,9 +18,7 @@
 #include "messagefacility/MessageLogger/MessageLogger.h"
 #include "lardata/Utilities/AssociationUtil.h"
 
-#include "TDatabasePDG.h"
-
-#include "LArReco/TrackMomentumCalculator.h"
+#include "LArReco/RangeTables.h"
 #include "sbnobj/Common/Reco/RangeP.h"
 
 #include <memory>
@@ -47,10 +45,9 @@ public:
 
 private:
 
-  trkf::TrackMomentumCalculator fRangeCalculator;
+  const sbn::RangeTables& fRangeTables;
   art::InputTag fTrackLabel;
-  double fMuonMass;
-  double fPionMass;
+  double fLArDensity;
 
 };
 
@@ -59,17 +56,14 @@ const static std::vector<std::string> names {"muon", "pion", "proton"};
 
 sbn::RangePAllPID::RangePAllPID(fhicl::ParameterSet const& p)
   : EDProducer{p},
-    fRangeCalculator(p.get<float>("MinTrackLength", 10.)),
-    fTrackLabel(p.get<art::InputTag>("TrackLabel", "pandoraTrack"))
+    fRangeTables(sbn::RangeTables::Instance()),
+    fTrackLabel(p.get<art::InputTag>("TrackLabel", "pandoraTrack")),
+    fLArDensity(p.get<double>("LArDensity", sbn::RangeTables::kReferenceDensity))
 {
   for (unsigned i = 0; i < names.size(); i++) {
     produces<std::vector<sbn::RangeP>>(names[i]);
     produces<art::Assns<recob::Track, sbn::RangeP>>(names[i]); 
   }
-
-  const TDatabasePDG *PDGTable = TDatabasePDG::Instance();
-  fMuonMass = PDGTable->GetParticle(13)->Mass();
-  fPionMass = PDGTable->GetParticle(211)->Mass();
 }
 
 void sbn::RangePAllPID::produce(art::Event& e)
@@ -86,13 +80,10 @@ void sbn::RangePAllPID::produce(art::Event& e)
 
     for (const art::Ptr<recob::Track> track: tracks) {
       sbn::RangeP rangep;
-      // Rescale the input and output as described by https://inspirehep.net/literature/1766384 (eq. 6.2)
-      if (PIDs[i] == 211) {
-        rangep.range_p = fRangeCalculator.GetTrackMomentum(track->Length() * (fMuonMass / fPionMass), 13) * (fPionMass / fMuonMass); 
-      }
-      else {
-        rangep.range_p = fRangeCalculator.GetTrackMomentum(track->Length(), PIDs[i]);
-      }
+      // The pion table is the muon one rescaled as described by https://inspirehep.net/literature/1766384 (eq. 6.2)
+      const double p = fRangeTables.MomentumFromRange(PIDs[i], track->Length(), fLArDensity);
+      // -0.999 beyond the tables, as the fits this replaced returned
+      rangep.range_p = (p < 0.) ? -0.999 : p;
       rangep.trackID = track->ID();
       rangecol->push_back(rangep);
       util::CreateAssn(*this, e, *rangecol, track, *assn, names[i]);
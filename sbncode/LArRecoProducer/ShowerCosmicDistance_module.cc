@@ -28,10 +28,11 @@
 #include "lardataobj/RecoBase/SpacePoint.h"
 #include "lardataobj/RecoBase/Track.h"
 
-#include <memory>
+#include "sbncode/LArRecoProducer/LArReco/PointKDTree.h"
 
-#include "TF1.h"
-#include "TGraph.h"
+#include <cmath>
+#include <limits>
+#include <memory>
 
 namespace sbn {
 class ShowerCosmicDistance : public art::EDProducer {
@@ -59,9 +60,11 @@ class ShowerCosmicDistance : public art::EDProducer {
   const std::vector<art::Ptr<recob::PFParticle>> GetCosmicPFPs(const std::vector<art::Ptr<recob::PFParticle>>& pfps,
       const art::FindManyP<larpandoraobj::PFParticleMetadata> fmPFPMeta) const;
 
-  const float FindShowerResidual(const recob::Shower& shower,
-      const std::vector<art::Ptr<recob::PFParticle>>& cosmicPFPs,
+  // Index of the space points of all the cosmic PFPs, built once per event
+  const PointKDTree BuildCosmicSPTree(const std::vector<art::Ptr<recob::PFParticle>>& cosmicPFPs,
       const art::FindManyP<recob::SpacePoint>& fmPFPSP) const;
+
+  const float FindShowerResidual(const recob::Shower& shower, const PointKDTree& cosmicSPTree) const;
 };
 
 ShowerCosmicDistance::ShowerCosmicDistance(fhicl::ParameterSet const& p)
@@ -98,6 +101,7 @@ void ShowerCosmicDistance::produce(art::Event& e)
   }
 
   const std::vector<art::Ptr<recob::PFParticle>> cosmicPFPs(GetCosmicPFPs(pfps, fmPFPMeta));
+  const PointKDTree cosmicSPTree(BuildCosmicSPTree(cosmicPFPs, fmPFPSP));
 
   std::unique_ptr<std::vector<float>> residualCol(std::make_unique<std::vector<float>>());
   std::unique_ptr<art::Assns<recob::Shower, float>> residualAssns(std::make_unique<art::Assns<recob::Shower, float>>());
@@ -108,7 +112,7 @@ void ShowerCosmicDistance::produce(art::Event& e)
     if (shower->best_plane() < 0 || shower->Energy().at(shower->best_plane()) < fMinShowerEnergy)
       continue;
 
-    const float res(FindShowerResidual(*shower, cosmicPFPs, fmPFPSP));
+    const float res(FindShowerResidual(*shower, cosmicSPTree));
 
     residualCol->push_back(res);
     util::CreateAssn(*this, e, *residualCol, shower, *residualAssns);
@@ -143,24 +147,30 @@ const std::vector<art::Ptr<recob::PFParticle>> ShowerCosmicDistance::GetCosmicPF
   return cosmicPFPs;
 }
 
-const float ShowerCosmicDistance::FindShowerResidual(const recob::Shower& shower,
+const PointKDTree ShowerCosmicDistance::BuildCosmicSPTree(
     const std::vector<art::Ptr<recob::PFParticle>>& cosmicPFPs,
     const art::FindManyP<recob::SpacePoint>& fmPFPSP) const
 {
-  float res(std::numeric_limits<float>::max());
-  const TVector3 showerStart3(shower.ShowerStart());
-  const geo::Point_t showerStart(showerStart3.X(), showerStart3.Y(), showerStart3.Z());
-
-  // Loop over the cosmic PFPs and find the closest
+  std::vector<PointKDTree::Point> points;
   for (auto const& cosmicPFP : cosmicPFPs) {
     auto const& pfpSPs(fmPFPSP.at(cosmicPFP.key()));
-    // Loop over all of the spacepoints in the PFP and find the closest
     for (auto const& sp : pfpSPs) {
-      const float dist((showerStart - sp->position()).r());
-      res = std::min(res, dist);
+      const Double32_t* xyz(sp->XYZ());
+      points.push_back({ xyz[0], xyz[1], xyz[2] });
     }
   }
-  return res;
+  return PointKDTree(std::move(points));
+}
+
+const float ShowerCosmicDistance::FindShowerResidual(const recob::Shower& shower, const PointKDTree& cosmicSPTree) const
+{
+  if (cosmicSPTree.empty())
+    return std::numeric_limits<float>::max();
+
+  // Find the closest of the space points of all the cosmic PFPs
+  const TVector3 showerStart(shower.ShowerStart());
+  const double dist2(cosmicSPTree.NearestDist2({ showerStart.X(), showerStart.Y(), showerStart.Z() }));
+  return std::sqrt(dist2);
 }
 }
 
@@ -28,10 +28,11 @@
 #include "lardataobj/RecoBase/SpacePoint.h"
 #include "canvas/Persistency/Common/FindManyP.h"
 
+#include "sbncode/LArRecoProducer/LArReco/ShowerDensityProfile.h"
+
 #include <memory>
 
-#include "TGraph.h"
-#include "TF1.h"
+#include "TVector3.h"
 
 namespace sbn{
   class ShowerSelectionVars;
@@ -234,78 +235,33 @@ void sbn::ShowerSelectionVars::produce(art::Event& e)
 sbn::ShowerDensityFit sbn::ShowerSelectionVars::DensityFitter(const recob::Shower& shower,
     const std::vector<art::Ptr<recob::SpacePoint> >& sps) const {
 
-  const TVector3 showerVtx(shower.ShowerStart());
-  const TVector3 showerDir(shower.Direction());
-  const double OpenAngle(shower.OpenAngle());
-  unsigned int totalHits(0);
-
   if (!shower.has_length() || !shower.has_open_angle() || sps.empty())
     return sbn::ShowerDensityFit();
 
-  std::map<int, std::vector<art::Ptr<recob::SpacePoint> > > segmentSPMap;
-  double segmentSize = shower.Length()/fNSegments;
+  const TVector3& showerVtx(shower.ShowerStart());
+  const TVector3& showerDir(shower.Direction());
+  const double start[3] = {showerVtx.X(), showerVtx.Y(), showerVtx.Z()};
+  const double dir[3] = {showerDir.X(), showerDir.Y(), showerDir.Z()};
 
-  //Split the the spacepoints into segments.
+  std::vector<double> x, y, z;
+  x.reserve(sps.size());
+  y.reserve(sps.size());
+  z.reserve(sps.size());
   for(auto const& sp: sps){
-
-    //Get the position of the spacepoint
-    const double projLen(SpacePointProjection(*sp, showerVtx, showerDir));
-    const double perpLen(SpacePointPerpendicular(*sp, showerVtx, showerDir, projLen));
-
-    if(perpLen > TMath::Abs(TMath::Tan(OpenAngle)*projLen))
-      continue;
-
-    //Get where the sp should be place.
-    const int sg_len(round(projLen/segmentSize));
-    segmentSPMap[sg_len].push_back(sp);
-    ++totalHits;
+    const Double32_t* sp_xyz = sp->XYZ();
+    x.push_back(sp_xyz[0]);
+    y.push_back(sp_xyz[1]);
+    z.push_back(sp_xyz[2]);
   }
 
-  TGraph* graph = new TGraph();
-
-  //Calculate the density gradent.
-  for(auto& segment: segmentSPMap){
-    double sg_len = segment.first;
-
-    if(segment.second.size() < 10){continue;}
-
-    //Calculate the charge in the segement
-    double segmentHits = segment.second.size();
-
-    //Calculate the voume
-    double lower_dist = sg_len*segmentSize - segmentSize/2;
-    double upper_dist = sg_len*segmentSize + segmentSize/2;
-
-    if(fRemoveStartFin){if(sg_len==0 || sg_len==fNSegments){continue;}}
-
-    if(sg_len==0)         {lower_dist = 0;}
-    if(sg_len==fNSegments){upper_dist = sg_len*segmentSize;}
-
-    double littlevolume = lower_dist*TMath::Power((TMath::Tan(0.5*OpenAngle)*lower_dist),2)*TMath::Pi()/3;
-    double bigvolume    = upper_dist*TMath::Power((TMath::Tan(0.5*OpenAngle)*upper_dist),2)*TMath::Pi()/3;
-    double volume       = bigvolume - littlevolume;
-
-    double SegmentDensity = segmentHits/volume;
-
-    double LengthToSegment = (lower_dist+upper_dist)/2;
-
-    graph->SetPoint(graph->GetN(),LengthToSegment,SegmentDensity/totalHits);
-  }
-
-  if(graph->GetN() < 3 )
+  // density = grad / length^pow, 0 <= grad <= 1, 1 <= pow <= 2
+  const sbn::PowerLawFitResult fit(sbn::FitShowerDensityProfile(x.data(), y.data(), z.data(), sps.size(),
+        start, dir, shower.Length(), shower.OpenAngle(), fNSegments, fRemoveStartFin));
+  if(!fit.valid)
     return sbn::ShowerDensityFit();
 
-  TF1 *fit = new TF1("fit", "[0]/x^[1]");
-  fit->SetParLimits(1,1,2);
-  fit->SetParLimits(0,0,1);
-
-  graph->Fit(fit,"Q");
-
-  const double grad(fit->GetParameter(0));
-  const double pow(fit->GetParameter(1));
-
-  delete fit;
-  delete graph;
+  const double grad(fit.norm);
+  const double pow(fit.power);
 
   return sbn::ShowerDensityFit(grad, pow);
 }
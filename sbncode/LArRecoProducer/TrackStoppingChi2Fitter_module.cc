@@ -10,7 +10,7 @@
 // Based on the StoppingParticleCosmicIDAlg by Tom Brooks in sbndcode
 ////////////////////////////////////////////////////////////////////////
 
-#include "art/Framework/Core/EDProducer.h"
+#include "art/Framework/Core/SharedProducer.h"
 #include "art/Framework/Core/ModuleMacros.h"
 #include "art/Framework/Principal/Event.h"
 #include "art/Framework/Principal/Handle.h"
@@ -25,15 +25,14 @@
 #include "lardataobj/RecoBase/Track.h"
 #include "sbnobj/Common/Reco/StoppingChi2Fit.h"
 
-#include "TF1.h"
-#include "TGraph.h"
+#include "sbncode/LArRecoProducer/LArReco/StoppingChi2Fits.h"
 
 #include <memory>
 
 namespace sbn {
-class TrackStoppingChi2Fitter : public art::EDProducer {
+class TrackStoppingChi2Fitter : public art::SharedProducer {
   public:
-  explicit TrackStoppingChi2Fitter(fhicl::ParameterSet const& p);
+  explicit TrackStoppingChi2Fitter(fhicl::ParameterSet const& p, art::ProcessingFrame const&);
   // The compiler-generated destructor is fine for non-base
   // classes without bare pointers or other resource use.
 
@@ -44,7 +43,7 @@ class TrackStoppingChi2Fitter : public art::EDProducer {
   TrackStoppingChi2Fitter& operator=(TrackStoppingChi2Fitter&&) = delete;
 
   // Required functions.
-  void produce(art::Event& e) override;
+  void produce(art::Event& e, art::ProcessingFrame const&) override;
 
   private:
   // Declare member data here.
@@ -55,8 +54,8 @@ class TrackStoppingChi2Fitter : public art::EDProducer {
   StoppingChi2Fit RunFit(const anab::Calorimetry& calo) const;
 };
 
-TrackStoppingChi2Fitter::TrackStoppingChi2Fitter(fhicl::ParameterSet const& p)
-    : EDProducer { p }
+TrackStoppingChi2Fitter::TrackStoppingChi2Fitter(fhicl::ParameterSet const& p, art::ProcessingFrame const&)
+    : SharedProducer { p }
     , fTrackLabel(p.get<std::string>("TrackLabel"))
     , fCaloLabel(p.get<std::string>("CaloLabel"))
     , fMinTrackLength(p.get<float>("MinTrackLength"))
@@ -67,9 +66,12 @@ TrackStoppingChi2Fitter::TrackStoppingChi2Fitter(fhicl::ParameterSet const& p)
   produces<std::vector<StoppingChi2Fit>>();
   produces<art::Assns<recob::Track, StoppingChi2Fit>>();
   produces<art::Assns<anab::Calorimetry, StoppingChi2Fit>>();
+
+  // The fits keep no state, and don't use ROOT's fitter
+  async<art::InEvent>();
 }
 
-void TrackStoppingChi2Fitter::produce(art::Event& e)
+void TrackStoppingChi2Fitter::produce(art::Event& e, art::ProcessingFrame const&)
 {
   // Implementation of required member function here.
   auto const trackHandle(e.getValidHandle<std::vector<recob::Track>>(fTrackLabel));
@@ -117,37 +119,26 @@ void TrackStoppingChi2Fitter::produce(art::Event& e)
 
 StoppingChi2Fit TrackStoppingChi2Fitter::RunFit(const anab::Calorimetry& calo) const
 {
+  const std::vector<float>& dEdx(calo.dEdx());
+  const std::vector<float>& resRange(calo.ResidualRange());
 
-  std::vector<float> dEdxVec, resRangeVec;
-  // Fill the dEdx vs res range vectors, ignoring the first/last points
-  for (size_t i = 1; i < calo.dEdx().size() - 1; i++) {
-    const float thisdEdx(calo.dEdx()[i]);
-    const float thisResRange(calo.ResidualRange()[i]);
-    if (thisResRange > fFitRange || thisdEdx > fMaxdEdx)
-      continue;
+  if (dEdx.size() != resRange.size())
+    throw cet::exception("TrackStoppingChi2Fitter") << "dEdx and Res Range do not have same length: " << dEdx.size() << " and " << resRange.size() << std::endl;
 
-    dEdxVec.push_back(thisdEdx);
-    resRangeVec.push_back(thisResRange);
-  }
+  // Fit dEdx vs res range, ignoring the first/last points
+  const StoppingFitPoints points { resRange.data(), dEdx.data(), 1, (dEdx.size() < 2) ? size_t(1) : dEdx.size() - 1, fFitRange, fMaxdEdx };
 
-  if (dEdxVec.size() != resRangeVec.size())
-    throw cet::exception("TrachStoppingChi2Fitter") << "dEdx and Res Range do not have same length: " << dEdxVec.size() << " and " << resRangeVec.size() << std::endl;
-
-  if (dEdxVec.size() < fMinHits)
+  if (points.Count() < fMinHits)
     return StoppingChi2Fit();
 
-  const auto graph(std::make_unique<TGraph>(dEdxVec.size(), &resRangeVec[0], &dEdxVec[0]));
-
   // Try and fit a flat polynomial
-  graph->Fit("pol0", "Q");
-  const TF1* polFit = graph->GetFunction("pol0");
-  const float pol0Chi2(polFit ? polFit->GetChisquare() : -5.f);
-  const float pol0Fit(polFit ? polFit->GetParameter(0) : -5.f);
+  const Pol0FitResult polFit(FitPol0(points));
+  const float pol0Chi2(polFit.valid ? polFit.chi2 : -5.f);
+  const float pol0Fit(polFit.valid ? polFit.p0 : -5.f);
 
   // Try to fit an exponential
-  graph->Fit("expo", "Q");
-  const TF1* expFit = graph->GetFunction("expo");
-  const float expChi2(expFit ? expFit->GetChisquare() : -5.f);
+  const ExpoFitResult expFit(FitExpo(points));
+  const float expChi2(expFit.valid ? expFit.chi2 : -5.f);
 
   return StoppingChi2Fit(pol0Chi2, expChi2, pol0Fit);
 }
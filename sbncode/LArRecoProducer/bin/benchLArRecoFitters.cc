@@ -0,0 +1,509 @@
+// Runs the LArRecoProducer fitters outside of art on a sample written by
+// the FitterSampleDumper module, reports the time per call of each, and
+// compares their results with reference values written by an earlier run,
+// so that a change to a fitter can be checked for speed and for results
+// without a full art job.
+//
+// The first pass over the sample warms up the fitters and records their
+// results, and the timed passes follow. The fitters are configured as in
+// the fcl files of their modules.
+//
+// Usage: benchLArRecoFitters sample.root [options]
+//   -n N        number of timed passes over the sample (default 5)
+//   -m N        number of tracks and of showers to use (default all)
+//   -f LIST     fitters to run (default mcs,mcsbatch,mcsparallel,range,tmcchi2,tmcllhd,stopping,density)
+//   -w FILE     write the results to FILE as reference values
+//   -r FILE     compare the results with the reference values in FILE
+//   -t REL      relative tolerance of the comparison (default 1e-6)
+//   -a ABS      absolute tolerance of the comparison (default 1e-9)
+//
+// Returns 1 if a result differs from its reference value.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "TError.h"
+#include "TFile.h"
+#include "TKey.h"
+#include "TTree.h"
+
+#include "canvas/Persistency/Common/Ptr.h"
+#include "canvas/Persistency/Provenance/ProductID.h"
+#include "fhiclcpp/ParameterSet.h"
+#include "lardataobj/RecoBase/Track.h"
+
+#include "sbncode/LArRecoProducer/LArReco/ShowerDensityProfile.h"
+#include "sbncode/LArRecoProducer/LArReco/StoppingChi2Fits.h"
+#include "sbncode/LArRecoProducer/LArReco/TrackMomentumCalculator.h"
+#include "sbncode/LArRecoProducer/LArReco/TrajectoryMCSFitter.h"
+
+namespace
+{
+  using Clock = std::chrono::steady_clock;
+
+  double Seconds(const Clock::time_point& start)
+  {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+  }
+
+  std::vector<std::string> Split(const std::string& s)
+  {
+    std::vector<std::string> ret;
+    std::stringstream ss(s);
+    std::string tok;
+    while(std::getline(ss, tok, ',')) if(!tok.empty()) ret.push_back(tok);
+    return ret;
+  }
+
+  // The hypotheses of MCSFitAllPID and RangePAllPID
+  const std::vector<int> kPids = {13, 211, 321, 2212};
+
+  // As MCSFitAllPID with mcsproducer.fcl, whose empty MCS table leaves
+  // every parameter at its default in TrajectoryMCSFitter::Config
+  trkf::TrajectoryMCSFitter MakeMCSFitter()
+  {
+    return trkf::TrajectoryMCSFitter(trkf::TrajectoryMCSFitter::Parameters(fhicl::ParameterSet()));
+  }
+
+  // trackstoppingchi2fitter.fcl
+  constexpr float kStoppingMinTrackLength = 10.f;
+  constexpr float kStoppingFitRange = 30.f;
+  constexpr float kStoppingMaxdEdx = 30.f;
+  constexpr size_t kStoppingMinHits = 30;
+
+  // showerselectionvarsproducer.fcl
+  constexpr unsigned int kDensityNSegments = 10;
+  constexpr bool kDensityRemoveStartFin = true;
+
+  struct TrackSample
+  {
+    std::unique_ptr<recob::Track> track;
+    std::vector<float> resRange;
+    std::vector<float> dEdx;
+  };
+
+  struct ShowerSample
+  {
+    double start[3];
+    double dir[3];
+    double length;
+    double openAngle;
+    std::vector<double> x, y, z;
+  };
+
+  // Results by "fitter/entry/quantity"
+  using Results = std::map<std::string, double>;
+
+  // Builds the key only when recording, to keep it out of the timing
+  void Put(Results* res, const char* fitter, size_t entry, const char* quantity, double value)
+  {
+    if(res) (*res)[std::string(fitter) + "/" + std::to_string(entry) + "/" + quantity] = value;
+  }
+
+  std::string FitterOf(const std::string& key)
+  {
+    return key.substr(0, key.find('/'));
+  }
+
+  struct Bench
+  {
+    std::string name;
+    size_t calls; ///< fits per pass
+    // Runs one pass, and records the results if given somewhere to
+    std::function<void(Results*)> pass;
+  };
+
+  // The directory of the trees: the top of the file, or the directory of
+  // the dumper module in a TFileService file
+  TDirectory* FindSample(TFile& f)
+  {
+    if(f.Get("tracks")) return &f;
+    for(TObject* obj: *f.GetListOfKeys()){
+      TDirectory* dir = dynamic_cast<TDirectory*>(((TKey*)obj)->ReadObj());
+      if(dir && dir->Get("tracks")) return dir;
+    }
+    return nullptr;
+  }
+
+  std::vector<TrackSample> LoadTracks(TTree* tr, long nmax)
+  {
+    int id = 0;
+    bool hasMomenta = true;
+    std::vector<double> *x = nullptr, *y = nullptr, *z = nullptr;
+    std::vector<double> *px = nullptr, *py = nullptr, *pz = nullptr;
+    std::vector<float> *resRange = nullptr, *dEdx = nullptr;
+    tr->SetBranchAddress("id", &id);
+    tr->SetBranchAddress("hasMomenta", &hasMomenta);
+    tr->SetBranchAddress("x", &x);
+    tr->SetBranchAddress("y", &y);
+    tr->SetBranchAddress("z", &z);
+    tr->SetBranchAddress("px", &px);
+    tr->SetBranchAddress("py", &py);
+    tr->SetBranchAddress("pz", &pz);
+    tr->SetBranchAddress("resRange", &resRange);
+    tr->SetBranchAddress("dEdx", &dEdx);
+
+    std::vector<TrackSample> ret;
+    const long n = (nmax < 0) ? tr->GetEntries() : std::min(nmax, (long)tr->GetEntries());
+    ret.reserve(n);
+    for(long i = 0; i < n; ++i){
+      tr->GetEntry(i);
+
+      recob::TrackTrajectory::Positions_t positions;
+      recob::TrackTrajectory::Momenta_t momenta;
+      for(size_t k = 0; k < x->size(); ++k){
+        positions.emplace_back((*x)[k], (*y)[k], (*z)[k]);
+        momenta.emplace_back((*px)[k], (*py)[k], (*pz)[k]);
+      }
+      recob::TrackTrajectory::Flags_t flags(positions.size());
+      recob::TrackTrajectory traj(std::move(positions), std::move(momenta), std::move(flags), hasMomenta);
+
+      TrackSample s;
+      s.track = std::make_unique<recob::Track>(std::move(traj), 13, -1.f, -1,
+                                               recob::tracking::SMatrixSym55(),
+                                               recob::tracking::SMatrixSym55(), id);
+      // TrackStoppingChi2Fitter gives up on these
+      if(resRange->size() == dEdx->size()){
+        s.resRange = *resRange;
+        s.dEdx = *dEdx;
+      }
+      ret.push_back(std::move(s));
+    }
+    tr->ResetBranchAddresses();
+    delete x; delete y; delete z;
+    delete px; delete py; delete pz;
+    delete resRange; delete dEdx;
+    return ret;
+  }
+
+  std::vector<ShowerSample> LoadShowers(TTree* tr, long nmax)
+  {
+    ShowerSample s;
+    std::vector<double> *x = nullptr, *y = nullptr, *z = nullptr;
+    tr->SetBranchAddress("start", s.start);
+    tr->SetBranchAddress("dir", s.dir);
+    tr->SetBranchAddress("length", &s.length);
+    tr->SetBranchAddress("openAngle", &s.openAngle);
+    tr->SetBranchAddress("spX", &x);
+    tr->SetBranchAddress("spY", &y);
+    tr->SetBranchAddress("spZ", &z);
+
+    std::vector<ShowerSample> ret;
+    const long n = (nmax < 0) ? tr->GetEntries() : std::min(nmax, (long)tr->GetEntries());
+    ret.reserve(n);
+    for(long i = 0; i < n; ++i){
+      tr->GetEntry(i);
+      s.x = *x;
+      s.y = *y;
+      s.z = *z;
+      ret.push_back(s);
+    }
+    tr->ResetBranchAddresses();
+    delete x; delete y; delete z;
+    return ret;
+  }
+
+  void PutMCS(Results* res, const char* fitter, size_t entry, int pid,
+              const recob::MCSFitResult& fit)
+  {
+    if(!res) return;
+    const std::string p = std::to_string(pid) + ".";
+    Put(res, fitter, entry, (p + "fwdMomentum").c_str(), fit.fwdMomentum());
+    Put(res, fitter, entry, (p + "fwdLogLikelihood").c_str(), fit.fwdLogLikelihood());
+    Put(res, fitter, entry, (p + "bwdMomentum").c_str(), fit.bwdMomentum());
+    Put(res, fitter, entry, (p + "bwdLogLikelihood").c_str(), fit.bwdLogLikelihood());
+  }
+
+  std::vector<Bench> MakeBenches(const std::vector<TrackSample>& tracks,
+                                 const std::vector<ShowerSample>& showers,
+                                 const std::vector<art::Ptr<recob::Track>>& trackPtrs)
+  {
+    std::vector<const recob::TrackTrajectory*> trajs;
+    for(const TrackSample& t: tracks) trajs.push_back(&t.track->Trajectory());
+
+    size_t nStopping = 0;
+    for(const TrackSample& t: tracks){
+      if(t.track->Length() >= kStoppingMinTrackLength && !t.dEdx.empty()) ++nStopping;
+    }
+
+    // shared by the benches, as by RangePAllPID
+    auto tmc = std::make_shared<trkf::TrackMomentumCalculator>();
+
+    std::vector<Bench> ret;
+
+    ret.push_back({"mcs", trajs.size() * kPids.size(), [trajs](Results* res){
+      const trkf::TrajectoryMCSFitter fitter = MakeMCSFitter();
+      for(int pid: kPids){
+        for(size_t j = 0; j < trajs.size(); ++j){
+          PutMCS(res, "mcs", j, pid, fitter.fitMcs(*trajs[j], pid));
+        }
+      }
+    }});
+
+    for(bool parallel: {false, true}){
+      const char* name = parallel ? "mcsparallel" : "mcsbatch";
+      ret.push_back({name, trajs.size() * kPids.size(), [trajs, name, parallel](Results* res){
+        const trkf::TrajectoryMCSFitter fitter = MakeMCSFitter();
+        const auto fits = fitter.fitMcsBatch(trajs, kPids, true, parallel);
+        for(size_t i = 0; i < kPids.size(); ++i){
+          for(size_t j = 0; j < trajs.size(); ++j) PutMCS(res, name, j, kPids[i], fits[i][j]);
+        }
+      }});
+    }
+
+    ret.push_back({"range", tracks.size() * kPids.size(), [&tracks, tmc](Results* res){
+      for(int pid: kPids){
+        for(size_t j = 0; j < tracks.size(); ++j){
+          const double p = tmc->GetTrackMomentum(tracks[j].track->Length(), pid);
+          if(res) Put(res, "range", j, (std::to_string(pid) + ".momentum").c_str(), p);
+        }
+      }
+    }});
+
+    ret.push_back({"tmcchi2", trackPtrs.size(), [&trackPtrs, tmc](Results* res){
+      for(size_t j = 0; j < trackPtrs.size(); ++j){
+        Put(res, "tmcchi2", j, "momentum", tmc->GetMomentumMultiScatterChi2(trackPtrs[j]));
+      }
+    }});
+
+    ret.push_back({"tmcllhd", trackPtrs.size(), [&trackPtrs, tmc](Results* res){
+      for(size_t j = 0; j < trackPtrs.size(); ++j){
+        Put(res, "tmcllhd", j, "momentum", tmc->GetMomentumMultiScatterLLHD(trackPtrs[j]));
+      }
+    }});
+
+    // As TrackStoppingChi2Fitter::RunFit
+    ret.push_back({"stopping", nStopping, [&tracks](Results* res){
+      for(size_t j = 0; j < tracks.size(); ++j){
+        const TrackSample& t = tracks[j];
+        if(t.track->Length() < kStoppingMinTrackLength || t.dEdx.empty()) continue;
+
+        const sbn::StoppingFitPoints points{t.resRange.data(), t.dEdx.data(), 1,
+                                            (t.dEdx.size() < 2) ? size_t(1) : t.dEdx.size() - 1,
+                                            kStoppingFitRange, kStoppingMaxdEdx};
+        if(points.Count() < kStoppingMinHits){
+          Put(res, "stopping", j, "valid", 0);
+          continue;
+        }
+        const sbn::Pol0FitResult polFit = sbn::FitPol0(points);
+        const sbn::ExpoFitResult expFit = sbn::FitExpo(points);
+        Put(res, "stopping", j, "valid", 1);
+        Put(res, "stopping", j, "pol0Chi2", polFit.valid ? polFit.chi2 : -5.);
+        Put(res, "stopping", j, "pol0Fit", polFit.valid ? polFit.p0 : -5.);
+        Put(res, "stopping", j, "expChi2", expFit.valid ? expFit.chi2 : -5.);
+      }
+    }});
+
+    // As ShowerSelectionVars::DensityFitter
+    ret.push_back({"density", showers.size(), [&showers](Results* res){
+      for(size_t j = 0; j < showers.size(); ++j){
+        const ShowerSample& s = showers[j];
+        const sbn::PowerLawFitResult fit =
+          sbn::FitShowerDensityProfile(s.x.data(), s.y.data(), s.z.data(), s.x.size(),
+                                       s.start, s.dir, s.length, s.openAngle,
+                                       kDensityNSegments, kDensityRemoveStartFin);
+        Put(res, "density", j, "valid", fit.valid);
+        if(fit.valid){
+          Put(res, "density", j, "norm", fit.norm);
+          Put(res, "density", j, "power", fit.power);
+        }
+      }
+    }});
+
+    return ret;
+  }
+
+  Results ReadReferences(const std::string& fname)
+  {
+    std::ifstream fin(fname);
+    if(!fin){
+      std::cerr << "ERROR: Unable to read references from " << fname << std::endl;
+      exit(1);
+    }
+    Results ret;
+    std::string line;
+    while(std::getline(fin, line)){
+      if(line.empty() || line[0] == '#') continue;
+      std::stringstream ss(line);
+      std::string key, val;
+      ss >> key >> val;
+      // strtod, unlike operator>>, reads back the nan of an invalid fit
+      ret[key] = std::strtod(val.c_str(), nullptr);
+    }
+    return ret;
+  }
+
+  void WriteReferences(const std::string& fname, const std::string& sample, const Results& res)
+  {
+    std::ofstream fout(fname);
+    if(!fout){
+      std::cerr << "ERROR: Unable to write references to " << fname << std::endl;
+      exit(1);
+    }
+    fout << "# benchLArRecoFitters results for " << sample << std::endl;
+    fout << std::setprecision(17);
+    for(const auto& kv: res) fout << kv.first << " " << kv.second << std::endl;
+  }
+
+  // Number of results differing from, or missing from, the references of
+  // the fitters that were run
+  size_t Compare(const Results& res, const Results& refs, const std::vector<std::string>& fitters,
+                 double relTol, double absTol)
+  {
+    auto const ran = [&fitters](const std::string& key){
+      return std::find(fitters.begin(), fitters.end(), FitterOf(key)) != fitters.end();
+    };
+    constexpr size_t kMaxPrinted = 20;
+    size_t nbad = 0;
+    auto const report = [&nbad](const std::string& msg){
+      if(++nbad <= kMaxPrinted) std::cout << "  " << msg << std::endl;
+    };
+
+    for(const auto& kv: refs){
+      if(!ran(kv.first)) continue;
+      auto it = res.find(kv.first);
+      if(it == res.end()){
+        report(kv.first + ": missing");
+        continue;
+      }
+      const double a = it->second, b = kv.second;
+      if(std::isnan(a) && std::isnan(b)) continue;
+      if(!(std::abs(a - b) <= absTol + relTol * std::abs(b))){
+        std::ostringstream msg;
+        msg << std::setprecision(10) << kv.first << ": " << a << " (reference " << b << ")";
+        report(msg.str());
+      }
+    }
+    for(const auto& kv: res){
+      if(!refs.count(kv.first)) report(kv.first + ": not in the references");
+    }
+    if(nbad > kMaxPrinted) std::cout << "  ..." << std::endl;
+    return nbad;
+  }
+}
+
+int main(int argc, char** argv)
+{
+  gErrorIgnoreLevel = kWarning;
+
+  if(argc < 2 || argv[1][0] == '-'){
+    std::cerr << "Usage: benchLArRecoFitters sample.root [-n N] [-m N] [-f LIST] "
+              << "[-w FILE] [-r FILE] [-t REL] [-a ABS]" << std::endl;
+    exit(1);
+  }
+
+  const std::string filePath = argv[1];
+  int npasses = 5;
+  long nmax = -1;
+  std::vector<std::string> fitters = {"mcs", "mcsbatch", "mcsparallel", "range",
+                                      "tmcchi2", "tmcllhd", "stopping", "density"};
+  std::string writeName, refName;
+  double relTol = 1e-6, absTol = 1e-9;
+
+  for(int i = 2; i < argc; i += 2){
+    const std::string opt = argv[i];
+    if(i+1 >= argc){
+      std::cerr << "ERROR: Option " << opt << " needs a value" << std::endl;
+      exit(1);
+    }
+    const std::string val = argv[i+1];
+    if(opt == "-n") npasses = std::stoi(val);
+    else if(opt == "-m") nmax = std::stol(val);
+    else if(opt == "-f") fitters = Split(val);
+    else if(opt == "-w") writeName = val;
+    else if(opt == "-r") refName = val;
+    else if(opt == "-t") relTol = std::stod(val);
+    else if(opt == "-a") absTol = std::stod(val);
+    else{
+      std::cerr << "ERROR: Unknown option " << opt << std::endl;
+      exit(1);
+    }
+  }
+
+  std::unique_ptr<TFile> f(TFile::Open(filePath.c_str(), "READ"));
+  if(!f || !f->IsOpen()){
+    std::cerr << "ERROR: Unable to open " << filePath
+              << " as a TFile, is this a proper ROOT file?" << std::endl;
+    exit(1);
+  }
+
+  TDirectory* dir = FindSample(*f);
+  TTree* trackTree = dir ? (TTree*)dir->Get("tracks") : nullptr;
+  TTree* showerTree = dir ? (TTree*)dir->Get("showers") : nullptr;
+  if(!trackTree || !showerTree){
+    std::cerr << "ERROR: Unable to access the tracks and showers trees in " << filePath
+              << " is this the output of FitterSampleDumper?" << std::endl;
+    exit(1);
+  }
+
+  // Hold the sample in memory, so that the timing does not include
+  // reading the input
+  const std::vector<TrackSample> tracks = LoadTracks(trackTree, nmax);
+  const std::vector<ShowerSample> showers = LoadShowers(showerTree, nmax);
+  f.reset();
+
+  // TrackMomentumCalculator takes art::Ptr, which can also point to
+  // objects outside of an event
+  std::vector<art::Ptr<recob::Track>> trackPtrs;
+  for(size_t i = 0; i < tracks.size(); ++i){
+    trackPtrs.emplace_back(art::ProductID(), tracks[i].track.get(), i);
+  }
+
+  std::cout << "Read " << tracks.size() << " tracks and " << showers.size()
+            << " showers from " << filePath << std::endl;
+  std::cout << std::setw(12) << "fitter" << std::setw(10) << "calls"
+            << std::setw(14) << "best[us/call]" << std::setw(14) << "mean[us/call]"
+            << std::setw(14) << "best[calls/s]" << std::endl;
+
+  Results results;
+  for(const Bench& b: MakeBenches(tracks, showers, trackPtrs)){
+    if(std::find(fitters.begin(), fitters.end(), b.name) == fitters.end()) continue;
+
+    b.pass(&results);
+
+    double best = -1., total = 0.;
+    for(int i = 0; i < npasses; ++i){
+      const auto start = Clock::now();
+      b.pass(nullptr);
+      const double t = Seconds(start);
+      if(best < 0. || t < best) best = t;
+      total += t;
+    }
+
+    const double calls = std::max<size_t>(b.calls, 1);
+    std::cout << std::setw(12) << b.name << std::setw(10) << b.calls
+              << std::fixed << std::setprecision(3)
+              << std::setw(14) << 1e6 * best / calls
+              << std::setw(14) << 1e6 * total / std::max(npasses, 1) / calls
+              << std::setprecision(0)
+              << std::setw(14) << (best > 0. ? calls / best : 0.)
+              << std::defaultfloat << std::endl;
+  }
+
+  if(!writeName.empty()){
+    WriteReferences(writeName, filePath, results);
+    std::cout << "Wrote " << results.size() << " reference values to " << writeName << std::endl;
+  }
+
+  if(!refName.empty()){
+    const Results refs = ReadReferences(refName);
+    std::cout << "Comparing with " << refName << std::endl;
+    const size_t nbad = Compare(results, refs, fitters, relTol, absTol);
+    std::cout << (nbad ? std::to_string(nbad) + " results differ" : std::string("All results agree"))
+              << " with the references" << std::endl;
+    if(nbad) return 1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,166 @@
+// Checks PointKDTree against a scan over all the points: builds trees over
+// random point sets and requires the nearest squared distance of random
+// queries to be identical to the minimum of the scan. The residual of
+// ShowerCosmicDistance::FindShowerResidual, the float square root of it,
+// must also be identical to the minimum of the distances as the scan of
+// the module computed them before the tree.
+//
+// The point sets are uniform in a box, along straight tracks as the space
+// points of cosmics, and on an integer grid, where the splitting planes go
+// through many points at once and distances tie. The queries are uniform
+// in and around the box, and some are points of the set.
+//
+// Usage: checkPointKDTree [options]
+//   -n N        number of point sets (default 200)
+//   -q N        number of queries per set (default 1000)
+//   -s SEED     seed of the random numbers (default 1)
+//
+// Returns 1 if a distance differs from the scan's.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "sbncode/LArRecoProducer/LArReco/PointKDTree.h"
+
+namespace
+{
+  using Point = sbn::PointKDTree::Point;
+
+  // A box of the size of a TPC [cm]
+  constexpr double kHalfSize = 200.;
+
+  std::vector<Point> MakePoints(std::mt19937_64& rng, unsigned kind)
+  {
+    std::uniform_real_distribution<double> box(-kHalfSize, kHalfSize);
+    std::uniform_int_distribution<int> npoints(1, 3000);
+    std::vector<Point> points(npoints(rng));
+
+    if(kind == 0){
+      for(Point& p: points) p = {box(rng), box(rng), box(rng)};
+    }
+    else if(kind == 1){
+      // tracks of points about 0.3 cm apart
+      std::uniform_int_distribution<int> ntracks(1, 10);
+      std::normal_distribution<double> gaus(0., 1.);
+      std::vector<Point> starts(ntracks(rng)), dirs(starts.size());
+      for(size_t t = 0; t < starts.size(); t++){
+        starts[t] = {box(rng), box(rng), box(rng)};
+        dirs[t] = {gaus(rng), gaus(rng), gaus(rng)};
+        const double norm = std::sqrt(dirs[t][0] * dirs[t][0] + dirs[t][1] * dirs[t][1] + dirs[t][2] * dirs[t][2]);
+        for(double& d: dirs[t]) d /= norm;
+      }
+      for(size_t i = 0; i < points.size(); i++){
+        const size_t t = i % starts.size();
+        const double s = 0.3 * (i / starts.size());
+        for(unsigned d = 0; d < 3; d++) points[i][d] = starts[t][d] + s * dirs[t][d] + 0.05 * gaus(rng);
+      }
+    }
+    else{
+      std::uniform_int_distribution<int> grid(-5, 5);
+      for(Point& p: points) p = {double(grid(rng)), double(grid(rng)), double(grid(rng))};
+    }
+    return points;
+  }
+
+  // Queries in steps of 0.1 around the integer grid, from -7.2 to 7.2,
+  // many of them at the same distance of several points
+  double OnGrid(double v)
+  {
+    return 0.1 * std::round(v / kHalfSize * 60.);
+  }
+
+  double ScanDist2(const std::vector<Point>& points, const Point& q)
+  {
+    double best = std::numeric_limits<double>::max();
+    for(const Point& p: points){
+      const double dx = q[0] - p[0], dy = q[1] - p[1], dz = q[2] - p[2];
+      best = std::min(best, dx * dx + dy * dy + dz * dz);
+    }
+    return best;
+  }
+
+  // As ShowerCosmicDistance: the minimum of the float distances
+  float ScanResidual(const std::vector<Point>& points, const Point& q)
+  {
+    float res = std::numeric_limits<float>::max();
+    for(const Point& p: points){
+      const double dx = q[0] - p[0], dy = q[1] - p[1], dz = q[2] - p[2];
+      const float dist = std::sqrt(dx * dx + dy * dy + dz * dz);
+      res = std::min(res, dist);
+    }
+    return res;
+  }
+}
+
+int main(int argc, char** argv)
+{
+  int nsets = 200, nqueries = 1000;
+  unsigned long seed = 1;
+
+  for(int i = 1; i < argc; i += 2){
+    const std::string opt = argv[i];
+    if(i+1 >= argc){
+      std::cerr << "ERROR: Option " << opt << " needs a value" << std::endl;
+      exit(1);
+    }
+    const std::string val = argv[i+1];
+    if(opt == "-n") nsets = std::stoi(val);
+    else if(opt == "-q") nqueries = std::stoi(val);
+    else if(opt == "-s") seed = std::stoul(val);
+    else{
+      std::cerr << "ERROR: Unknown option " << opt << std::endl;
+      exit(1);
+    }
+  }
+
+  std::mt19937_64 rng(seed);
+  std::uniform_real_distribution<double> around(-1.2 * kHalfSize, 1.2 * kHalfSize);
+  std::uniform_real_distribution<double> unit(0., 1.);
+
+  // An empty tree answers the largest double, as the scan of no points
+  if(sbn::PointKDTree().NearestDist2({0., 0., 0.}) != ScanDist2({}, {0., 0., 0.})){
+    std::cout << "Empty tree: distance differs from the scan's" << std::endl;
+    std::cout << "FAILED" << std::endl;
+    return 1;
+  }
+
+  unsigned long nchecked = 0, nbad = 0;
+  for(int iset = 0; iset < nsets; iset++){
+    const unsigned kind = iset % 3;
+    const std::vector<Point> points = MakePoints(rng, kind);
+    const sbn::PointKDTree tree(points);
+
+    for(int iq = 0; iq < nqueries; iq++){
+      Point q = {around(rng), around(rng), around(rng)};
+      if(unit(rng) < 0.1) q = points[rng() % points.size()];
+      else if(kind == 2) q = {OnGrid(q[0]), OnGrid(q[1]), OnGrid(q[2])};
+
+      const double treeDist2 = tree.NearestDist2(q);
+      const double scanDist2 = ScanDist2(points, q);
+      const float treeRes = std::sqrt(treeDist2);
+      ++nchecked;
+      if(treeDist2 != scanDist2 || treeRes != ScanResidual(points, q)){
+        if(++nbad <= 10){
+          std::cout << "Set " << iset << " (kind " << kind << ", " << points.size()
+                    << " points), query (" << q[0] << ", " << q[1] << ", " << q[2]
+                    << "): tree " << treeDist2 << ", scan " << scanDist2 << std::endl;
+        }
+      }
+    }
+  }
+
+  std::cout << "Checked " << nchecked << " queries, " << nbad
+            << " differ from the scan" << std::endl;
+  if(nbad > 0){
+    std::cout << "FAILED" << std::endl;
+    return 1;
+  }
+  std::cout << "OK" << std::endl;
+  return 0;
+}
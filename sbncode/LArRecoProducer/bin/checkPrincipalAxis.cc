@@ -0,0 +1,219 @@
+// Checks PrincipalAxis and Eigenvalues against TMatrixDSymEigen, which
+// they replace, on random symmetric 3x3 matrices: the eigenvalues, and
+// the principal axis up to its sign.
+//
+// The matrices are the covariances of the points of straight segments, as
+// TrajectoryMCSFitter and TrackMomentumCalculator fit, R diag(l) R^T of a
+// random rotation R with the two largest eigenvalues l nearly or exactly
+// degenerate, and with the two smallest, at scales from 1e-30 to 1e30.
+//
+// The eigenvalues compare in units of the norm of the matrix, the largest
+// absolute eigenvalue. The axis is only defined to the precision of the
+// matrix divided by the gap between the two largest eigenvalues, so the
+// sine of its angle to the eigenvector of TMatrixDSymEigen compares in
+// units of norm / gap, and the axis is also required to be an eigenvector,
+// |m a - l a| in units of the norm.
+//
+// Usage: checkPrincipalAxis [options]
+//   -n N        number of matrices of each kind (default 100000)
+//   -s SEED     seed of the random numbers (default 1)
+//   -v TOL      tolerance of the eigenvalues, and of |m a - l a| (default 1e-12)
+//   -a TOL      tolerance of the sine of the angle of the axis (default 1e-12)
+//
+// Returns 1 if a result differs from TMatrixDSymEigen's.
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "TMatrixD.h"
+#include "TMatrixDSym.h"
+#include "TMatrixDSymEigen.h"
+#include "TVectorD.h"
+
+#include "sbncode/LArRecoProducer/LArReco/PrincipalAxis.h"
+
+namespace
+{
+  using Vector = std::array<double, 3>;
+
+  Vector Cross(const Vector& a, const Vector& b)
+  {
+    return {a[1] * b[2] - a[2] * b[1], a[2] * b[0] - a[0] * b[2], a[0] * b[1] - a[1] * b[0]};
+  }
+
+  double Norm(const Vector& a)
+  {
+    return std::sqrt(a[0] * a[0] + a[1] * a[1] + a[2] * a[2]);
+  }
+
+  Vector RandomDirection(std::mt19937_64& rng)
+  {
+    std::normal_distribution<double> gaus(0., 1.);
+    Vector d = {gaus(rng), gaus(rng), gaus(rng)};
+    const double n = Norm(d);
+    for(double& c: d) c /= n;
+    return d;
+  }
+
+  // Covariance of the points of a straight segment of 5 to 30 cm, with
+  // the scatter of the space points, in float as the trajectory points
+  sbn::SymMatrix3 SegmentMatrix(std::mt19937_64& rng)
+  {
+    std::uniform_real_distribution<double> unit(0., 1.);
+    std::normal_distribution<double> gaus(0., 1.);
+    const Vector dir = RandomDirection(rng);
+    const double length = 5. + 25. * unit(rng);
+    const double scatter = 0.01 + 0.3 * unit(rng);
+    const size_t n = 10 + rng() % 90;
+
+    std::vector<float> x(n), y(n), z(n);
+    const Vector start = {400. * unit(rng), 400. * unit(rng), 1000. * unit(rng)};
+    for(size_t i = 0; i < n; i++){
+      const double s = length * unit(rng);
+      x[i] = start[0] + s * dir[0] + scatter * gaus(rng);
+      y[i] = start[1] + s * dir[1] + scatter * gaus(rng);
+      z[i] = start[2] + s * dir[2] + scatter * gaus(rng);
+    }
+
+    // as the points version of PrincipalAxis
+    double mx = 0., my = 0., mz = 0.;
+    for(size_t i = 0; i < n; i++){ mx += x[i]; my += y[i]; mz += z[i]; }
+    mx /= n; my /= n; mz /= n;
+    sbn::SymMatrix3 m;
+    for(size_t i = 0; i < n; i++){
+      const double dx = x[i] - mx, dy = y[i] - my, dz = z[i] - mz;
+      m.xx += dx * dx / n; m.xy += dx * dy / n; m.xz += dx * dz / n;
+      m.yy += dy * dy / n; m.yz += dy * dz / n; m.zz += dz * dz / n;
+    }
+    return m;
+  }
+
+  // R diag(l) R^T, with the orthonormal axes of R from random directions
+  sbn::SymMatrix3 RotatedMatrix(std::mt19937_64& rng, const Vector& l)
+  {
+    const Vector u = RandomDirection(rng);
+    Vector v = Cross(u, RandomDirection(rng));
+    const double nv = Norm(v);
+    for(double& c: v) c /= nv;
+    const Vector w = Cross(u, v);
+
+    const std::array<Vector, 3> axes = {u, v, w};
+    double a[3][3] = {};
+    for(unsigned k = 0; k < 3; k++)
+      for(unsigned i = 0; i < 3; i++)
+        for(unsigned j = 0; j < 3; j++)
+          a[i][j] += l[k] * axes[k][i] * axes[k][j];
+    return {a[0][0], a[0][1], a[0][2], a[1][1], a[1][2], a[2][2]};
+  }
+
+  sbn::SymMatrix3 MakeMatrix(std::mt19937_64& rng, unsigned kind)
+  {
+    std::uniform_real_distribution<double> unit(0., 1.);
+    // log-uniform relative gap, from 1e-1 to 1e-12, or none
+    const double eps = (unit(rng) < 0.1) ? 0. : std::pow(10., -1. - 11. * unit(rng));
+
+    if(kind == 0) return SegmentMatrix(rng);
+    if(kind == 1) return RotatedMatrix(rng, {1., 1. - eps, 0.5 * unit(rng)});
+    if(kind == 2){
+      const double small = 0.5 * unit(rng);
+      return RotatedMatrix(rng, {1., small, small * (1. - eps)});
+    }
+
+    // any of the above, scaled
+    const double scale = std::pow(10., -30. + 60. * unit(rng));
+    sbn::SymMatrix3 m = MakeMatrix(rng, rng() % 3);
+    for(double* c: {&m.xx, &m.xy, &m.xz, &m.yy, &m.yz, &m.zz}) *c *= scale;
+    return m;
+  }
+
+  struct MaxDiff
+  {
+    const char* name;
+    double max = 0.;
+    unsigned long nbad = 0;
+
+    void Add(double diff, double tol)
+    {
+      max = std::max(max, diff);
+      if(!(diff <= tol)) ++nbad;
+    }
+  };
+}
+
+int main(int argc, char** argv)
+{
+  int nmatrices = 100000;
+  unsigned long seed = 1;
+  double valTol = 1e-12, axisTol = 1e-12;
+
+  for(int i = 1; i < argc; i += 2){
+    const std::string opt = argv[i];
+    if(i+1 >= argc){
+      std::cerr << "ERROR: Option " << opt << " needs a value" << std::endl;
+      exit(1);
+    }
+    const std::string val = argv[i+1];
+    if(opt == "-n") nmatrices = std::stoi(val);
+    else if(opt == "-s") seed = std::stoul(val);
+    else if(opt == "-v") valTol = std::stod(val);
+    else if(opt == "-a") axisTol = std::stod(val);
+    else{
+      std::cerr << "ERROR: Unknown option " << opt << std::endl;
+      exit(1);
+    }
+  }
+
+  std::mt19937_64 rng(seed);
+  const char* kinds[] = {"segment covariances", "nearly degenerate largest", "nearly degenerate smallest", "scaled"};
+
+  unsigned long nbad = 0;
+  for(unsigned kind = 0; kind < 4; kind++){
+    MaxDiff values{"eigenvalues [norm]"}, residual{"|m a - l a| [norm]"}, angle{"axis sin(angle) [norm/gap]"};
+
+    for(int im = 0; im < nmatrices; im++){
+      const sbn::SymMatrix3 m = MakeMatrix(rng, kind);
+
+      TMatrixDSym rm(3);
+      rm(0, 0) = m.xx; rm(0, 1) = m.xy; rm(0, 2) = m.xz;
+      rm(1, 0) = m.xy; rm(1, 1) = m.yy; rm(1, 2) = m.yz;
+      rm(2, 0) = m.xz; rm(2, 1) = m.yz; rm(2, 2) = m.zz;
+      const TMatrixDSymEigen eigen(rm);
+      const TVectorD& rootValues = eigen.GetEigenValues();
+      const TMatrixD& rootVectors = eigen.GetEigenVectors();
+
+      const double norm = std::max(std::abs(rootValues(0)), std::abs(rootValues(2)));
+      const std::array<double, 3> l = sbn::Eigenvalues(m);
+      for(unsigned k = 0; k < 3; k++) values.Add(std::abs(l[k] - rootValues(k)) / norm, valTol);
+
+      const Vector a = sbn::PrincipalAxis(m);
+      const Vector ma = {m.xx * a[0] + m.xy * a[1] + m.xz * a[2],
+                         m.xy * a[0] + m.yy * a[1] + m.yz * a[2],
+                         m.xz * a[0] + m.yz * a[1] + m.zz * a[2]};
+      residual.Add(Norm({ma[0] - l[0] * a[0], ma[1] - l[0] * a[1], ma[2] - l[0] * a[2]}) / norm, valTol);
+
+      const double gap = rootValues(0) - rootValues(1);
+      const Vector rootAxis = {rootVectors(0, 0), rootVectors(1, 0), rootVectors(2, 0)};
+      if(gap > 0.) angle.Add(Norm(Cross(a, rootAxis)) / Norm(a) * gap / norm, axisTol);
+    }
+
+    std::cout << kinds[kind] << ":" << std::endl;
+    for(const MaxDiff* d: {&values, &residual, &angle}){
+      std::cout << "  " << d->name << ": max difference " << d->max
+                << ", " << d->nbad << " beyond tolerance" << std::endl;
+      nbad += d->nbad;
+    }
+  }
+
+  if(nbad > 0){
+    std::cout << "FAILED" << std::endl;
+    return 1;
+  }
+  std::cout << "OK" << std::endl;
+  return 0;
+}
@@ -0,0 +1,169 @@
+// Checks the fits of StoppingChi2Fits against the ROOT fits they replace:
+// fits FitPol0 and FitExpo, and TGraph::Fit("pol0") and TGraph::Fit("expo"),
+// to the same random dE/dx vs residual range profiles, selected as in
+// TrackStoppingChi2Fitter, and compares the chi2 and the parameters.
+//
+// The profiles are a mix of stopping tracks, with a Bragg peak and some
+// points above the maximum dE/dx, and of flat, through-going ones. The
+// pol0 fits are both exact, so they compare at the precision of the
+// doubles. Minuit stops the expo fit within its tolerance of the minimum,
+// so the chi2 compare with a relative tolerance, and the parameters in
+// units of their error from ROOT's fit.
+//
+// Usage: checkStoppingChi2Fits [options]
+//   -n N        number of profiles (default 1000)
+//   -s SEED     seed of the random numbers (default 1)
+//   -t REL      relative tolerance of the chi2 and of the pol0 p0 (default 1e-6)
+//   -e FRAC     tolerance of the expo parameters, in units of their error (default 0.05)
+//
+// Returns 1 if a fit differs from ROOT's.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "TError.h"
+#include "TF1.h"
+#include "TGraph.h"
+#include "TRandom3.h"
+
+#include "sbncode/LArRecoProducer/LArReco/StoppingChi2Fits.h"
+
+namespace
+{
+  // trackstoppingchi2fitter.fcl
+  constexpr float kStoppingFitRange = 30.f;
+  constexpr float kStoppingMaxdEdx = 30.f;
+  constexpr size_t kStoppingMinHits = 30;
+
+  // A profile as TrackStoppingChi2Fitter gets it from the calorimetry:
+  // the residual range decreasing to the end of the track
+  void MakeProfile(TRandom3& rnd, std::vector<float>& resRange, std::vector<float>& dEdx)
+  {
+    resRange.clear();
+    dEdx.clear();
+
+    const bool stopping = rnd.Uniform() < 0.7;
+    const double length = rnd.Uniform(20., 80.);
+    const double pitch = rnd.Uniform(0.3, 0.6);
+    for(double rr = length; rr > 0.; rr -= pitch){
+      double mean = 2.1;
+      // Bragg peak, with a proton-like and a muon-like scale
+      if(stopping) mean = rnd.Uniform() < 0.5 ? 17. * std::pow(rr, -0.42) : 8. * std::pow(rr, -0.37);
+      resRange.push_back(rr);
+      dEdx.push_back(std::max(0.1, rnd.Landau(mean, 0.1 * mean)));
+    }
+  }
+
+  struct MaxDiff
+  {
+    const char* name;
+    double max = 0.;
+    unsigned nbad = 0;
+
+    void Add(double diff, double tol)
+    {
+      max = std::max(max, diff);
+      if(!(diff <= tol)) ++nbad;
+    }
+  };
+
+  double RelDiff(double a, double b)
+  {
+    return std::abs(a - b) / std::max({std::abs(a), std::abs(b), 1e-12});
+  }
+}
+
+int main(int argc, char** argv)
+{
+  gErrorIgnoreLevel = kWarning;
+
+  int nprofiles = 1000;
+  unsigned seed = 1;
+  double relTol = 1e-6, errTol = 0.05;
+
+  for(int i = 1; i < argc; i += 2){
+    const std::string opt = argv[i];
+    if(i+1 >= argc){
+      std::cerr << "ERROR: Option " << opt << " needs a value" << std::endl;
+      exit(1);
+    }
+    const std::string val = argv[i+1];
+    if(opt == "-n") nprofiles = std::stoi(val);
+    else if(opt == "-s") seed = std::stoul(val);
+    else if(opt == "-t") relTol = std::stod(val);
+    else if(opt == "-e") errTol = std::stod(val);
+    else{
+      std::cerr << "ERROR: Unknown option " << opt << std::endl;
+      exit(1);
+    }
+  }
+
+  TRandom3 rnd(seed);
+  std::vector<float> resRange, dEdx;
+
+  MaxDiff pol0Chi2{"pol0 chi2 [rel]"}, pol0P0{"pol0 p0 [rel]"};
+  MaxDiff expChi2{"expo chi2 [rel]"}, expConstant{"expo constant [err]"}, expSlope{"expo slope [err]"};
+  unsigned nfits = 0, nvalid = 0;
+
+  for(int iprof = 0; iprof < nprofiles; ++iprof){
+    MakeProfile(rnd, resRange, dEdx);
+
+    // As TrackStoppingChi2Fitter, ignoring the first/last points
+    const sbn::StoppingFitPoints points{resRange.data(), dEdx.data(), 1, dEdx.size() - 1,
+                                        kStoppingFitRange, kStoppingMaxdEdx};
+    if(points.Count() < kStoppingMinHits) continue;
+    ++nfits;
+
+    std::vector<double> x, y;
+    points.ForEach([&](double px, double py){ x.push_back(px); y.push_back(py); });
+    TGraph graph(x.size(), x.data(), y.data());
+
+    // The fit to expo replaces the pol0 function of the graph, so the
+    // results of the pol0 fit are compared first
+    const sbn::Pol0FitResult pol0(sbn::FitPol0(points));
+    graph.Fit("pol0", "Q");
+    const TF1* rootPol0 = graph.GetFunction("pol0");
+    if(!pol0.valid || !rootPol0){
+      std::cerr << "Profile " << iprof << ": valid pol0 fit " << pol0.valid
+                << ", ROOT pol0 fit " << bool(rootPol0) << std::endl;
+      continue;
+    }
+    const double pol0ChiDiff = RelDiff(pol0.chi2, rootPol0->GetChisquare());
+    const double pol0P0Diff = RelDiff(pol0.p0, rootPol0->GetParameter(0));
+
+    const sbn::ExpoFitResult expo(sbn::FitExpo(points));
+    graph.Fit("expo", "Q");
+    const TF1* rootExpo = graph.GetFunction("expo");
+    if(!expo.valid || !rootExpo){
+      std::cerr << "Profile " << iprof << ": valid expo fit " << expo.valid
+                << ", ROOT expo fit " << bool(rootExpo) << std::endl;
+      continue;
+    }
+    ++nvalid;
+
+    pol0Chi2.Add(pol0ChiDiff, relTol);
+    pol0P0.Add(pol0P0Diff, relTol);
+    expChi2.Add(RelDiff(expo.chi2, rootExpo->GetChisquare()), relTol);
+    expConstant.Add(std::abs(expo.constant - rootExpo->GetParameter(0)) / rootExpo->GetParError(0), errTol);
+    expSlope.Add(std::abs(expo.slope - rootExpo->GetParameter(1)) / rootExpo->GetParError(1), errTol);
+  }
+
+  std::cout << "Compared " << nvalid << " of " << nfits << " fitted profiles" << std::endl;
+  unsigned nbad = nfits - nvalid;
+  for(const MaxDiff* d: {&pol0Chi2, &pol0P0, &expChi2, &expConstant, &expSlope}){
+    std::cout << "  " << d->name << ": max difference " << d->max
+              << ", " << d->nbad << " beyond tolerance" << std::endl;
+    nbad += d->nbad;
+  }
+
+  if(nbad > 0){
+    std::cout << "FAILED" << std::endl;
+    return 1;
+  }
+  std::cout << "OK" << std::endl;
+  return 0;
+}
@@ -2,6 +2,8 @@
 #define LightPath_CXX
 
 #include "LightPath.h"
+#include <cmath>
+#include <limits>
 
 namespace flashmatch {
 
@@ -10,6 +12,8 @@ namespace flashmatch {
   LightPath::LightPath(const std::string name)
     : BaseAlgorithm(kCustomAlgo, name)
     , _gap         ( 0.5    )
+    , _voxel_step  ( false  )
+    , _merge_voxels( false  )
     , _light_yield ( 40000. )
     , _dEdxMIP     ( 2.07   ) //1.42[Mev*cm^2*g]*1.4[g/cm^3]=2.004MeV/cm
   {}
@@ -19,21 +23,43 @@ namespace flashmatch {
     _gap          = pset.get< double > ( "SegmentSize" );
     _light_yield  = DetectorSpecs::GetME().LightYield();
     _dEdxMIP      = DetectorSpecs::GetME().MIPdEdx();
+    _voxel_step   = pset.get< bool > ( "VoxelStep", false );
+    _merge_voxels = pset.get< bool > ( "MergeVoxels", false );
+
+    if(_voxel_step) {
+      auto const& vox_def = DetectorSpecs::GetME().GetVoxelDef();
+      auto const lower = vox_def.GetRegionLowerCorner();
+      auto const size  = vox_def.GetVoxelSize();
+      auto const steps = vox_def.GetSteps();
+      _vox_lo[0]   = lower.X(); _vox_lo[1]   = lower.Y(); _vox_lo[2]   = lower.Z();
+      _vox_size[0] = size.X();  _vox_size[1] = size.Y();  _vox_size[2] = size.Z();
+      for(size_t i=0; i<3; ++i) _vox_n[i] = steps[i];
+    }
   }
 
-  void LightPath::MakeQCluster(const ::geoalgo::Vector& pt_1,
-			       const ::geoalgo::Vector& pt_2,
+  void LightPath::MakeQCluster(const ::geoalgo::Vector& vec_1,
+			       const ::geoalgo::Vector& vec_2,
 			       QCluster_t& Q_cluster,
 			       double dedx) const {
 
     if(dedx < 0) dedx = _dEdxMIP;
 
+    // Fixed-size copies: the arithmetic below then does not allocate
+    const ::geoalgo::Vector3 pt_1(vec_1);
+    const ::geoalgo::Vector3 pt_2(vec_2);
+
     double dist = pt_1.Dist(pt_2);
     QPoint_t q_pt;
     FLASH_INFO() << "Filling points between (" << pt_1[0] << "," << pt_1[1] << "," << pt_1[2] << ")"
 		 << " => (" << pt_2[0] << "," << pt_2[1] << "," << pt_2[2] << ") ... dist="<<dist<<std::endl;
+
+    if (_voxel_step) {
+      MakeVoxelQCluster(pt_2, pt_1, Q_cluster, dedx);
+      return;
+    }
+
     if (dist <= _gap) {
-      ::geoalgo::Vector mid_pt((pt_1 + pt_2) / 2.);
+      const ::geoalgo::Vector3 mid_pt((pt_1 + pt_2) / 2.);
       q_pt.x = mid_pt[0];
       q_pt.y = mid_pt[1];
       q_pt.z = mid_pt[2];
@@ -46,7 +72,7 @@ namespace flashmatch {
 
     int num_div = int(dist / _gap);
 
-    ::geoalgo::Vector direct = (pt_1 - pt_2).Dir();
+    const ::geoalgo::Vector3 direct = (pt_1 - pt_2).Dir();
     Q_cluster.reserve(Q_cluster.size() + num_div);
 
     for (int div_index = 0; div_index < num_div + 1; div_index++) {
@@ -72,6 +98,136 @@ namespace flashmatch {
     }
   }
 
+  void LightPath::MakeStepQCluster(const ::geoalgo::Vector3& start,
+				   const ::geoalgo::Vector3& dir,
+				   double length,
+				   QCluster_t& Q_cluster,
+				   double dedx) const {
+
+    if (length <= 0.) return;
+
+    int num_div = int(length / _gap);
+    for (int div_index = 0; div_index < num_div; div_index++) {
+      auto const mid_pt = start + dir * (_gap * div_index + _gap / 2.);
+      Q_cluster.emplace_back(mid_pt[0], mid_pt[1], mid_pt[2], _light_yield * dedx * _gap);
+    }
+    double weight = length - num_div * _gap;
+    if (weight > 0.) {
+      auto const mid_pt = start + dir * (_gap * num_div + weight / 2.);
+      Q_cluster.emplace_back(mid_pt[0], mid_pt[1], mid_pt[2], _light_yield * dedx * weight);
+    }
+  }
+
+  void LightPath::MakeVoxelQCluster(const ::geoalgo::Vector3& start,
+				    const ::geoalgo::Vector3& end,
+				    QCluster_t& Q_cluster,
+				    double dedx) const {
+
+    double length = start.Dist(end);
+    if (length <= 0.) return;
+    const ::geoalgo::Vector3 dir = (end - start) / length;
+
+    // Clip the segment to the photon library volume
+    double t_in = 0., t_out = length;
+    for (size_t i = 0; i < 3; ++i) {
+      double lo = _vox_lo[i];
+      double hi = _vox_lo[i] + _vox_n[i] * _vox_size[i];
+      if (dir[i] == 0.) {
+	if (start[i] < lo || start[i] > hi) t_out = -1.;
+	continue;
+      }
+      double t0 = (lo - start[i]) / dir[i];
+      double t1 = (hi - start[i]) / dir[i];
+      if (t0 > t1) std::swap(t0, t1);
+      t_in  = std::max(t_in, t0);
+      t_out = std::min(t_out, t1);
+    }
+    if (t_in >= t_out) {
+      MakeStepQCluster(start, dir, length, Q_cluster, dedx);
+      return;
+    }
+
+    MakeStepQCluster(start, dir, t_in, Q_cluster, dedx);
+
+    // Walk the voxels crossed by the segment, one point per chord
+    const double inf = std::numeric_limits<double>::max();
+    int    idx[3], step[3];
+    double t_next[3], t_delta[3];
+    for (size_t i = 0; i < 3; ++i) {
+      double u = (start[i] + dir[i] * t_in - _vox_lo[i]) / _vox_size[i];
+      idx[i] = std::min(std::max(int(std::floor(u)), 0), _vox_n[i] - 1);
+      if (dir[i] > 0.) {
+	step[i]    = 1;
+	t_next[i]  = (_vox_lo[i] + (idx[i] + 1) * _vox_size[i] - start[i]) / dir[i];
+	t_delta[i] = _vox_size[i] / dir[i];
+      }
+      else if (dir[i] < 0.) {
+	step[i]    = -1;
+	t_next[i]  = (_vox_lo[i] + idx[i] * _vox_size[i] - start[i]) / dir[i];
+	t_delta[i] = - _vox_size[i] / dir[i];
+      }
+      else {
+	step[i]    = 0;
+	t_next[i]  = inf;
+	t_delta[i] = inf;
+      }
+    }
+
+    double t = t_in;
+    while (t < t_out) {
+      size_t axis = 0;
+      if (t_next[1] < t_next[axis]) axis = 1;
+      if (t_next[2] < t_next[axis]) axis = 2;
+      double t_exit = std::min(t_next[axis], t_out);
+      if (t_exit > t) {
+	auto const mid_pt = start + dir * ((t + t_exit) / 2.);
+	Q_cluster.emplace_back(mid_pt[0], mid_pt[1], mid_pt[2], _light_yield * dedx * (t_exit - t));
+	FLASH_DEBUG() << "Voxel pt (" << mid_pt[0] << "," << mid_pt[1] << "," << mid_pt[2] << ") q="
+		      << Q_cluster.back().q << std::endl;
+      }
+      t = t_exit;
+      idx[axis] += step[axis];
+      t_next[axis] += t_delta[axis];
+      if (idx[axis] < 0 || idx[axis] >= _vox_n[axis]) break;
+    }
+
+    MakeStepQCluster(start + dir * t, dir, length - t, Q_cluster, dedx);
+  }
+
+  void LightPath::MergeVoxels(QCluster_t& Q_cluster) const {
+
+    if (Q_cluster.size() < 2) return;
+
+    auto const& vox_def = DetectorSpecs::GetME().GetVoxelDef();
+    double pos[3];
+    int last_id = -1;
+    size_t n_merged = 0;
+    for (size_t i = 0; i < Q_cluster.size(); ++i) {
+      auto const& pt = Q_cluster[i];
+      int vox_id = -1;
+      if (pt.q > 0.) {
+	pos[0] = pt.x;
+	pos[1] = pt.y;
+	pos[2] = pt.z;
+	vox_id = vox_def.GetVoxelID(pos);
+      }
+      if (vox_id >= 0 && vox_id == last_id) {
+	auto& merged = Q_cluster[n_merged - 1];
+	double q = merged.q + pt.q;
+	merged.x = (merged.x * merged.q + pt.x * pt.q) / q;
+	merged.y = (merged.y * merged.q + pt.y * pt.q) / q;
+	merged.z = (merged.z * merged.q + pt.z * pt.q) / q;
+	merged.q = q;
+	continue;
+      }
+      if (n_merged != i) Q_cluster[n_merged] = pt;
+      ++n_merged;
+      last_id = vox_id;
+    }
+    FLASH_INFO() << "Merged " << Q_cluster.size() << " points into " << n_merged << std::endl;
+    Q_cluster.resize(n_merged);
+  }
+
   QCluster_t LightPath::MakeQCluster(const ::geoalgo::Trajectory& trj) const {
 
     QCluster_t result;
@@ -92,6 +248,8 @@ namespace flashmatch {
     QPoint_t q_pt2(trj[last][0], trj[last][1], trj[last][2], 0.);
     result.emplace_back(q_pt2);
 
+    if (_merge_voxels) MergeVoxels(result);
+
     FLASH_INFO() << result << std::endl;
     return result;
     /*
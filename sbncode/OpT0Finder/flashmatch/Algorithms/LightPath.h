@@ -20,12 +20,14 @@
 
 #if USING_LARSOFT == 0
 #include "flashmatch/GeoAlgo/GeoTrajectory.h"
+#include "flashmatch/GeoAlgo/GeoVector3.h"
 #include "flashmatch/Base/BaseAlgorithm.h"
 #include "flashmatch/Base/CustomAlgoFactory.h"
 #include "flashmatch/Base/FMWKInterface.h"
 #include "flashmatch/Base/OpT0FinderException.h"
 #else
 #include "sbncode/OpT0Finder/flashmatch/GeoAlgo/GeoTrajectory.h"
+#include "sbncode/OpT0Finder/flashmatch/GeoAlgo/GeoVector3.h"
 #include "sbncode/OpT0Finder/flashmatch/Base/BaseAlgorithm.h"
 #include "sbncode/OpT0Finder/flashmatch/Base/CustomAlgoFactory.h"
 #include "sbncode/OpT0Finder/flashmatch/Base/FMWKInterface.h"
@@ -66,6 +68,11 @@ namespace flashmatch{
 		      flashmatch::QCluster_t& Q_cluster,
 		      double dedx=-1) const;
 
+    /// Merges consecutive points that fall in the same photon library voxel,
+    /// summing their charge at the charge-weighted position. Points with no
+    /// charge (the trajectory end markers) are kept as they are.
+    void MergeVoxels(flashmatch::QCluster_t& Q_cluster) const;
+
     // Getter for light yield configured paramater
     double GetLightYield() const { return _light_yield; }
 
@@ -73,7 +80,27 @@ namespace flashmatch{
 
     void _Configure_(const Config_t &pset);
 
+    /// One point per photon library voxel crossed by the segment, at the
+    /// middle of the chord and with the charge of the chord length.
+    /// Parts of the segment outside the library use fixed _gap steps.
+    void MakeVoxelQCluster(const ::geoalgo::Vector3& start,
+			   const ::geoalgo::Vector3& end,
+			   flashmatch::QCluster_t& Q_cluster,
+			   double dedx) const;
+
+    /// Fixed _gap steps from start along the unit vector dir, over length
+    void MakeStepQCluster(const ::geoalgo::Vector3& start,
+			  const ::geoalgo::Vector3& dir,
+			  double length,
+			  flashmatch::QCluster_t& Q_cluster,
+			  double dedx) const;
+
     double _gap;
+    bool   _voxel_step;    ///< Size the steps from the photon library voxels
+    bool   _merge_voxels;  ///< Merge consecutive points in the same voxel
+    double _vox_lo[3];     ///< Photon library lower corner
+    double _vox_size[3];   ///< Photon library voxel size
+    int    _vox_n[3];      ///< Photon library number of voxels per axis
     double _light_yield;
     double _dEdxMIP;
   };
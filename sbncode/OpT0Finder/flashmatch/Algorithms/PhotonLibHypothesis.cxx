@@ -116,13 +116,13 @@ namespace flashmatch {
 
     }
 
-    QCluster_t PhotonLibHypothesis::ComputeExtension(const geoalgo::Vector& A, const geoalgo::Vector& B) const 
+    QCluster_t PhotonLibHypothesis::ComputeExtension(const geoalgo::Vector3& A, const geoalgo::Vector3& B) const 
     {
         QCluster_t extension;
 
         // direction to extend should be A=>B ... so B should be closer to the edge
-        geoalgo::Vector pt = B;
-        geoalgo::Vector AB = B - A;
+        geoalgo::Vector3 pt = B;
+        geoalgo::Vector3 AB = B - A;
         auto length = AB.Length();
         if(length < 1.e-9) {
             FLASH_WARNING() << "Extension calculation halted as the direction estimate is unreliable for a short segment (" 
@@ -161,8 +161,8 @@ namespace flashmatch {
 
         QCluster_t trk;
         if(start_touch) {
-            geoalgo::Vector B(in_trk[0].x, in_trk[0].y, in_trk[0].z);
-            geoalgo::Vector A(3);
+            geoalgo::Vector3 B(in_trk[0].x, in_trk[0].y, in_trk[0].z);
+            geoalgo::Vector3 A;
             // search for a canddiate point to define a direction (and avoid using the same point)
             for(size_t i=1; i<in_trk.size(); ++i) {
                 A[0] = in_trk[i].x;
@@ -175,8 +175,8 @@ namespace flashmatch {
         trk.reserve(trk.size() + in_trk.size());
         for(auto const& pt : in_trk) trk.push_back(pt);
         if(end_touch) {
-            geoalgo::Vector B(in_trk[in_trk.size()-1].x, in_trk[in_trk.size()-1].y, in_trk[in_trk.size()-1].z);
-            geoalgo::Vector A = B;
+            geoalgo::Vector3 B(in_trk[in_trk.size()-1].x, in_trk[in_trk.size()-1].y, in_trk[in_trk.size()-1].z);
+            geoalgo::Vector3 A = B;
             // search for a canddiate point to define a direction (and avoid using the same point)
             for(int i=in_trk.size()-2; i>=0; --i) {
                 A[0] = in_trk[i].x;
@@ -22,11 +22,13 @@
 #endif
 
 #if USING_LARSOFT == 0
+#include "flashmatch/GeoAlgo/GeoVector3.h"
 #include "flashmatch/Base/BaseFlashHypothesis.h"
 #include "flashmatch/Base/FlashHypothesisFactory.h"
 #include "flashmatch/Base/FMWKInterface.h"
 #include "flashmatch/Base/OpT0FinderException.h"
 #else
+#include "sbncode/OpT0Finder/flashmatch/GeoAlgo/GeoVector3.h"
 #include "sbncode/OpT0Finder/flashmatch/Base/BaseFlashHypothesis.h"
 #include "sbncode/OpT0Finder/flashmatch/Base/FlashHypothesisFactory.h"
 #include "sbncode/OpT0Finder/flashmatch/Base/FMWKInterface.h"
@@ -56,7 +58,7 @@ namespace flashmatch {
 
     QCluster_t TrackExtension(const QCluster_t&, const int touch) const;
 
-    QCluster_t ComputeExtension(const geoalgo::Vector& A, const geoalgo::Vector& B) const;
+    QCluster_t ComputeExtension(const geoalgo::Vector3& A, const geoalgo::Vector3& B) const;
 
     void TrackExtension(const QCluster_t&, Flash_t&) const;
 
@@ -39,6 +39,13 @@ namespace geoalgo {
 	      );
   }
 
+  bool AABox::Contain(const Point3_t &pt) const {
+    return !( (pt[0] < _min[0] || _max[0] < pt[0]) ||
+	      (pt[1] < _min[1] || _max[1] < pt[1]) ||
+	      (pt[2] < _min[2] || _max[2] < pt[2])
+	      );
+  }
+
 }
 #endif
 
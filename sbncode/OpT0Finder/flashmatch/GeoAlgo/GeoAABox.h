@@ -15,6 +15,7 @@
 #define BASICTOOL_GEOAABOX_H
 
 #include "GeoHalfLine.h"
+#include "GeoVector3.h"
 
 namespace geoalgo {
   /**
@@ -56,6 +57,7 @@ namespace geoalgo {
     void Min(const double x, const double y, const double z); ///< Minimum point setter
     void Max(const double x, const double y, const double z); ///< Maximum point setter
     bool Contain(const Point_t &pt) const; ///< Test if a point is contained within the box
+    bool Contain(const Point3_t &pt) const; ///< Same for a fixed-size point, without a conversion to Point_t
     
   protected:
     
@@ -15,6 +15,8 @@
 #include "GeoLineSegment.h"
 #include "GeoAABox.h"
 #include "GeoAlgo.h"
+#include "GeoVector3.h"
+#include "GeoBatch.h"
 
 //ADD_NEW_HEADER ... do not change this comment line
 
@@ -22,6 +24,9 @@
 namespace geoalgo {
   class GeoAlgoException;
   class Vector;
+  class Vector3;
+  class LineSegmentSoA;
+  class AABoxSoA;
   class Trajectory;
   class HalfLine;
   class Line;
@@ -2,7 +2,9 @@
 #define BASICTOOL_GEOALGO_CXX
 
 #include "GeoAlgo.h"
+#include "GeoVector3.h"
 #include <cassert>
+#include <cmath>
 
 namespace geoalgo {
 
@@ -131,6 +133,99 @@ namespace geoalgo {
     return result;
   }
 
+  // Slab method, Ref. RTCD 5.3.3 p. 179, written as plain loops over arrays
+  // so that the compiler can vectorize them. A segment parallel to a slab
+  // (d_inv = +/-inf) is inside it if it lies between the planes, including
+  // on either of them, and rejected otherwise; the division alone would
+  // give 0*inf = NaN on a plane.
+  namespace {
+    inline void _Slab_(const double s, const double d_inv,
+		       const double bmin, const double bmax,
+		       double& tmin, double& tmax)
+    {
+      if(std::isinf(d_inv)) {
+	if(s < bmin || s > bmax) { tmin = 1.; tmax = 0.; }
+	return;
+      }
+      const double ta = (bmin - s) * d_inv;
+      const double tb = (bmax - s) * d_inv;
+      tmin = std::max(tmin, std::min(ta, tb));
+      tmax = std::min(tmax, std::max(ta, tb));
+    }
+  }
+
+  void GeoAlgo::BoxClip(const AABox_t& box, const LineSegmentSoA& segs,
+			std::vector<double>& t_in, std::vector<double>& t_out) const
+  {
+    const size_t n = segs.size();
+    t_in.resize(n);
+    t_out.resize(n);
+    const double bx0 = box.Min()[0], by0 = box.Min()[1], bz0 = box.Min()[2];
+    const double bx1 = box.Max()[0], by1 = box.Max()[1], bz1 = box.Max()[2];
+    const double* x0 = segs.x0.data(); const double* x1 = segs.x1.data();
+    const double* y0 = segs.y0.data(); const double* y1 = segs.y1.data();
+    const double* z0 = segs.z0.data(); const double* z1 = segs.z1.data();
+    double* tin  = t_in.data();
+    double* tout = t_out.data();
+    for(size_t i=0; i<n; ++i) {
+      double tmin = 0., tmax = 1.;
+      _Slab_(x0[i], 1./(x1[i]-x0[i]), bx0, bx1, tmin, tmax);
+      _Slab_(y0[i], 1./(y1[i]-y0[i]), by0, by1, tmin, tmax);
+      _Slab_(z0[i], 1./(z1[i]-z0[i]), bz0, bz1, tmin, tmax);
+      tin[i]  = tmin;
+      tout[i] = tmax;
+    }
+  }
+
+  void GeoAlgo::BoxClip(const AABoxSoA& boxes, const LineSegment_t& seg,
+			std::vector<double>& t_in, std::vector<double>& t_out) const
+  {
+    const size_t n = boxes.size();
+    t_in.resize(n);
+    t_out.resize(n);
+    const Vector3 st(seg.Start());
+    const Vector3 ed(seg.End());
+    const double ix = 1./(ed[0]-st[0]), iy = 1./(ed[1]-st[1]), iz = 1./(ed[2]-st[2]);
+    const double* bx0 = boxes.xmin.data(); const double* bx1 = boxes.xmax.data();
+    const double* by0 = boxes.ymin.data(); const double* by1 = boxes.ymax.data();
+    const double* bz0 = boxes.zmin.data(); const double* bz1 = boxes.zmax.data();
+    double* tin  = t_in.data();
+    double* tout = t_out.data();
+    for(size_t i=0; i<n; ++i) {
+      double tmin = 0., tmax = 1.;
+      _Slab_(st[0], ix, bx0[i], bx1[i], tmin, tmax);
+      _Slab_(st[1], iy, by0[i], by1[i], tmin, tmax);
+      _Slab_(st[2], iz, bz0[i], bz1[i], tmin, tmax);
+      tin[i]  = tmin;
+      tout[i] = tmax;
+    }
+  }
+
+  void GeoAlgo::ContainedLength(const AABox_t& box, const LineSegmentSoA& segs,
+				std::vector<double>& length) const
+  {
+    std::vector<double> t_in, t_out;
+    BoxClip(box, segs, t_in, t_out);
+    length.resize(segs.size());
+    for(size_t i=0; i<segs.size(); ++i) {
+      const double dx = segs.x1[i] - segs.x0[i];
+      const double dy = segs.y1[i] - segs.y0[i];
+      const double dz = segs.z1[i] - segs.z0[i];
+      length[i] = std::max(0., t_out[i] - t_in[i]) * std::sqrt(dx*dx + dy*dy + dz*dz);
+    }
+  }
+
+  void GeoAlgo::ContainedLength(const AABoxSoA& boxes, const LineSegment_t& seg,
+				std::vector<double>& length) const
+  {
+    std::vector<double> t_in, t_out;
+    BoxClip(boxes, seg, t_in, t_out);
+    const double seg_len = std::sqrt(Vector3(seg.Start()).SqDist(Vector3(seg.End())));
+    length.resize(boxes.size());
+    for(size_t i=0; i<boxes.size(); ++i)
+      length[i] = std::max(0., t_out[i] - t_in[i]) * seg_len;
+  }
+
   // AABox_t & Trajectory_t intersection search. Make a use of AABox_t & HalfLine_t function
   std::vector<Point_t> GeoAlgo::Intersection(const AABox_t& box,
 					     const Trajectory_t& trj) const
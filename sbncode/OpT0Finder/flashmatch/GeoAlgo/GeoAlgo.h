@@ -22,6 +22,7 @@
 #include "GeoCone.h"
 #include "GeoAABox.h"
 #include "GeoSphere.h"
+#include "GeoBatch.h"
 
 namespace geoalgo {
 
@@ -83,6 +84,25 @@ namespace geoalgo {
     /// Get Trajectory inside box given some input trajectory -> now assumes trajectory cannot exit and re-enter box
     Trajectory_t BoxOverlap(const Trajectory_t& trj, const AABox_t& box) const
     { return BoxOverlap(box, trj); }
+
+    //
+    // Batch intersections (slab method over structure-of-arrays)
+    //
+
+    /// Clip many LineSegments against one AABox. Fills, per segment, the entry and
+    /// exit fractions of its length in [0,1]; t_in > t_out means no overlap.
+    void BoxClip(const AABox_t& box, const LineSegmentSoA& segs,
+		 std::vector<double>& t_in, std::vector<double>& t_out) const;
+    /// Clip one LineSegment against many AABoxes, same convention as above
+    void BoxClip(const AABoxSoA& boxes, const LineSegment_t& seg,
+		 std::vector<double>& t_in, std::vector<double>& t_out) const;
+
+    /// Length of each LineSegment contained in one AABox
+    void ContainedLength(const AABox_t& box, const LineSegmentSoA& segs,
+			 std::vector<double>& length) const;
+    /// Length of one LineSegment contained in each of many AABoxes
+    void ContainedLength(const AABoxSoA& boxes, const LineSegment_t& seg,
+			 std::vector<double>& length) const;
         
 
     //************************************************
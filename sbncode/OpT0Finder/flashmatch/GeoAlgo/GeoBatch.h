@@ -0,0 +1,100 @@
+/**
+ * \file GeoBatch.h
+ *
+ * \ingroup GeoAlgo
+ *
+ * \brief Structure-of-arrays containers for batch GeoAlgo operations
+ *
+ * @author kazuhiro
+ */
+
+/** \addtogroup GeoAlgo
+
+    @{*/
+#ifndef BASICTOOL_GEOBATCH_H
+#define BASICTOOL_GEOBATCH_H
+
+#include "GeoLineSegment.h"
+#include "GeoAABox.h"
+#include <vector>
+
+namespace geoalgo {
+
+  /**
+     \class LineSegmentSoA
+     Many LineSegments stored as one array per coordinate, so that the
+     batch functions in GeoAlgo run over contiguous memory
+  */
+  class LineSegmentSoA {
+  public:
+    LineSegmentSoA() {}
+
+    LineSegmentSoA(const std::vector<LineSegment_t>& segs)
+    { reserve(segs.size()); for(auto const& s : segs) push_back(s); }
+
+    inline size_t size() const { return x0.size(); }
+
+    void reserve(const size_t n) {
+      x0.reserve(n); y0.reserve(n); z0.reserve(n);
+      x1.reserve(n); y1.reserve(n); z1.reserve(n);
+    }
+
+    void clear() {
+      x0.clear(); y0.clear(); z0.clear();
+      x1.clear(); y1.clear(); z1.clear();
+    }
+
+    void push_back(const double sx, const double sy, const double sz,
+		   const double ex, const double ey, const double ez) {
+      x0.push_back(sx); y0.push_back(sy); z0.push_back(sz);
+      x1.push_back(ex); y1.push_back(ey); z1.push_back(ez);
+    }
+
+    void push_back(const LineSegment_t& seg) {
+      auto const& s = seg.Start();
+      auto const& e = seg.End();
+      push_back(s[0], s[1], s[2], e[0], e[1], e[2]);
+    }
+
+    std::vector<double> x0, y0, z0; ///< Start points
+    std::vector<double> x1, y1, z1; ///< End points
+  };
+
+  /**
+     \class AABoxSoA
+     Many AABoxes stored as one array per coordinate
+  */
+  class AABoxSoA {
+  public:
+    AABoxSoA() {}
+
+    AABoxSoA(const std::vector<AABox_t>& boxes)
+    { reserve(boxes.size()); for(auto const& b : boxes) push_back(b); }
+
+    inline size_t size() const { return xmin.size(); }
+
+    void reserve(const size_t n) {
+      xmin.reserve(n); ymin.reserve(n); zmin.reserve(n);
+      xmax.reserve(n); ymax.reserve(n); zmax.reserve(n);
+    }
+
+    void clear() {
+      xmin.clear(); ymin.clear(); zmin.clear();
+      xmax.clear(); ymax.clear(); zmax.clear();
+    }
+
+    void push_back(const AABox_t& box) {
+      auto const& mn = box.Min();
+      auto const& mx = box.Max();
+      xmin.push_back(mn[0]); ymin.push_back(mn[1]); zmin.push_back(mn[2]);
+      xmax.push_back(mx[0]); ymax.push_back(mx[1]); zmax.push_back(mx[2]);
+    }
+
+    std::vector<double> xmin, ymin, zmin; ///< Minimum points
+    std::vector<double> xmax, ymax, zmax; ///< Maximum points
+  };
+
+}
+
+#endif
+/** @} */ // end of doxygen group
@@ -0,0 +1,202 @@
+/**
+ * \file GeoVector3.h
+ *
+ * \ingroup GeoAlgo
+ *
+ * \brief Class def header for a fixed-size 3D vector
+ *
+ * @author kazuhiro
+ */
+
+/** \addtogroup GeoAlgo
+
+    @{*/
+#ifndef BASICTOOL_GEOVECTOR3_H
+#define BASICTOOL_GEOVECTOR3_H
+
+#include "GeoVector.h"
+#include <array>
+#include <cmath>
+#include <string>
+
+namespace geoalgo {
+
+  /**
+     \class Vector3
+     A 3D vector held on the stack, the fixed-size counterpart of Vector.
+     It never allocates and has no dimension check, which makes it the type
+     of choice for points, directions and temporaries in tight loops. It
+     provides the same interface as Vector and converts to and from it
+     implicitly, so it can be passed wherever a Vector is expected.
+  */
+  class Vector3 {
+  public:
+    /// Default ctor, all components set to kINVALID_DOUBLE as Vector(3)
+    Vector3() : _v{{kINVALID_DOUBLE, kINVALID_DOUBLE, kINVALID_DOUBLE}}
+    {}
+
+    /// ctor w/ x, y & z
+    Vector3(const double x, const double y, const double z) : _v{{x, y, z}}
+    {}
+
+    /// ctor w/ a 3D Vector
+    Vector3(const Vector& obj) : _v{{Checked3D(obj)[0], obj[1], obj[2]}}
+    {}
+
+    /// ctor w/ TVector3
+    Vector3(const TVector3& pt) : _v{{pt[0], pt[1], pt[2]}}
+    {}
+
+    //
+    // std::vector like access
+    //
+    inline double& operator[](const size_t i) { return _v[i]; }
+    inline const double& operator[](const size_t i) const { return _v[i]; }
+    inline size_t size() const { return 3; }
+    inline double* begin() { return _v.data(); }
+    inline double* end() { return _v.data() + 3; }
+    inline const double* begin() const { return _v.data(); }
+    inline const double* end() const { return _v.data() + 3; }
+
+    /// Check if point is valid
+    inline bool IsValid() const
+    { return _v[0] != kINVALID_DOUBLE || _v[1] != kINVALID_DOUBLE || _v[2] != kINVALID_DOUBLE; }
+
+    inline double SqLength() const { return Dot(*this); }     ///< Compute the squared length of the vector
+    inline double Length() const { return std::sqrt(SqLength()); } ///< Compute the length of the vector
+    inline void   Normalize() { (*this) /= Length(); }         ///< Normalize itself
+    inline Vector3 Dir() const { return (*this) / Length(); }  ///< Return a direction unit vector
+    /// Compute the angle Phi
+    inline double Phi() const
+    { return _v[0] == 0.0 && _v[1] == 0.0 ? 0.0 : std::atan2(_v[1], _v[0]); }
+    /// Compute the angle theta
+    inline double Theta() const
+    { const double l = Length(); return l == 0.0 ? 0.0 : std::acos(_v[2] / l); }
+
+    /// Compute the squared distance to another vector
+    inline double SqDist(const Vector3& obj) const
+    {
+      const double dx = _v[0] - obj[0];
+      const double dy = _v[1] - obj[1];
+      const double dz = _v[2] - obj[2];
+      return dx*dx + dy*dy + dz*dz;
+    }
+    /// Compute the distance to another vector
+    inline double Dist(const Vector3& obj) const { return std::sqrt(SqDist(obj)); }
+    /// Compute a dot product of two vectors
+    inline double Dot(const Vector3& obj) const
+    { return _v[0]*obj[0] + _v[1]*obj[1] + _v[2]*obj[2]; }
+    /// Compute a cross product of two vectors
+    inline Vector3 Cross(const Vector3& obj) const
+    {
+      return Vector3(_v[1] * obj[2] - obj[1] * _v[2],
+		     _v[2] * obj[0] - obj[2] * _v[0],
+		     _v[0] * obj[1] - obj[0] * _v[1]);
+    }
+    /// Compute an opening angle w.r.t. the given vector
+    inline double Angle(const Vector3& obj) const
+    { return std::acos(Dot(obj) / Length() / obj.Length()); }
+
+    /// Convert to TLorentzVector (with 4th element set equal to 0)
+    inline TLorentzVector ToTLorentzVector() const
+    { return TLorentzVector(_v[0], _v[1], _v[2], 0.); }
+
+    /// Convert back to a (heap allocated) Vector
+    inline Vector ToVector() const { return Vector(_v[0], _v[1], _v[2]); }
+    inline operator Vector() const { return ToVector(); }
+
+    /// rotation operations
+    inline void RotateX(const double& theta)
+    {
+      const double c = std::cos(theta), s = std::sin(theta);
+      const double ynew = _v[1] * c - _v[2] * s;
+      _v[2] = _v[1] * s + _v[2] * c;
+      _v[1] = ynew;
+    }
+    inline void RotateY(const double& theta)
+    {
+      const double c = std::cos(theta), s = std::sin(theta);
+      const double xnew = _v[0] * c + _v[2] * s;
+      _v[2] = - _v[0] * s + _v[2] * c;
+      _v[0] = xnew;
+    }
+    inline void RotateZ(const double& theta)
+    {
+      const double c = std::cos(theta), s = std::sin(theta);
+      const double xnew = _v[0] * c - _v[1] * s;
+      _v[1] = _v[0] * s + _v[1] * c;
+      _v[0] = xnew;
+    }
+
+    std::string dump() const
+    {
+      return "Pt (" + std::to_string(_v[0]) + "," + std::to_string(_v[1]) + ","
+	+ std::to_string(_v[2]) + ")";
+    }
+
+    //
+    // binary/uniry operators
+    //
+    inline Vector3& operator+=(const Vector3& rhs)
+    { _v[0] += rhs[0]; _v[1] += rhs[1]; _v[2] += rhs[2]; return *this; }
+
+    inline Vector3& operator-=(const Vector3& rhs)
+    { _v[0] -= rhs[0]; _v[1] -= rhs[1]; _v[2] -= rhs[2]; return *this; }
+
+    inline Vector3& operator*=(const double rhs)
+    { _v[0] *= rhs; _v[1] *= rhs; _v[2] *= rhs; return *this; }
+
+    inline Vector3& operator/=(const double rhs)
+    { _v[0] /= rhs; _v[1] /= rhs; _v[2] /= rhs; return *this; }
+
+    inline Vector3 operator+(const Vector3& rhs) const
+    { return Vector3(_v[0]+rhs[0], _v[1]+rhs[1], _v[2]+rhs[2]); }
+
+    inline Vector3 operator-(const Vector3& rhs) const
+    { return Vector3(_v[0]-rhs[0], _v[1]-rhs[1], _v[2]-rhs[2]); }
+
+    inline double operator*(const Vector3& rhs) const
+    { return Dot(rhs); }
+
+    inline Vector3 operator*(const double rhs) const
+    { return Vector3(_v[0]*rhs, _v[1]*rhs, _v[2]*rhs); }
+
+    inline Vector3 operator/(const double rhs) const
+    { return Vector3(_v[0]/rhs, _v[1]/rhs, _v[2]/rhs); }
+
+    inline bool operator< ( const Vector3& rhs ) const
+    { return _v[0] < rhs[0] || _v[1] < rhs[1] || _v[2] < rhs[2]; }
+
+    inline bool operator< ( const double& rhs) const
+    { return Length() < rhs; }
+
+    inline bool operator== ( const Vector3& rhs) const
+    { return _v[0] == rhs[0] && _v[1] == rhs[1] && _v[2] == rhs[2]; }
+
+    inline bool operator!= ( const Vector3& rhs) const
+    { return !(*this == rhs); }
+
+    /// Streamer
+    #ifndef __CINT__
+    friend std::ostream& operator << (std::ostream &o, ::geoalgo::Vector3 const& a)
+    { o << a.dump(); return o; }
+    #endif
+
+  protected:
+    /// Returns obj, after checking that it is 3D and before any element is read
+    static const Vector& Checked3D(const Vector& obj)
+    {
+      if(obj.size() != 3) throw GeoAlgoException("<<Vector3>> requires a 3-dimensional Vector!");
+      return obj;
+    }
+
+    std::array<double,3> _v;
+  };
+
+  /// Fixed-size 3D point has same feature as Vector3
+  typedef Vector3 Vector3_t;
+  typedef Vector3 Point3_t;
+}
+
+#endif
+/** @} */ // end of doxygen group
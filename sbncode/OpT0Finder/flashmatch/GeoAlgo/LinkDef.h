@@ -35,6 +35,10 @@
 #pragma link C++ class std::pair<geoalgo::Vector,string>+;
 #pragma link C++ class std::map<geoalgo::Vector,string>+;
 
+#pragma link C++ class geoalgo::Vector3+;
+#pragma link C++ class geoalgo::LineSegmentSoA+;
+#pragma link C++ class geoalgo::AABoxSoA+;
+
 #pragma link C++ class geoalgo::GeoAlgo+;
 #pragma link C++ class geoalgo::GeoObjCollection+;
 //ADD_NEW_CLASS ... do not change this line
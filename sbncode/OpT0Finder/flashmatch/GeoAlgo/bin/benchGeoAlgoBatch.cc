@@ -0,0 +1,108 @@
+//
+// Benchmark of the batch (structure-of-arrays) slab functions in GeoAlgo
+// against the per-object Intersection calls they are meant to replace.
+//
+// Usage: benchGeoAlgoBatch [n_segments] [n_boxes]
+//
+
+#include "sbncode/OpT0Finder/flashmatch/GeoAlgo/GeoAlgo.h"
+#include "sbncode/OpT0Finder/flashmatch/GeoAlgo/GeoBatch.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+
+namespace {
+
+  using Clock = std::chrono::steady_clock;
+
+  double elapsed_ns(const Clock::time_point& start)
+  { return std::chrono::duration<double, std::nano>(Clock::now() - start).count(); }
+
+  // per-object reference: the segment overlaps the box if it crosses its
+  // surface or if it is fully contained
+  bool overlaps(const geoalgo::GeoAlgo& algo, const geoalgo::AABox& box,
+                const geoalgo::LineSegment& seg)
+  {
+    if(!algo.Intersection(box, seg).empty()) return true;
+    return box.Contain(seg.Start()) && box.Contain(seg.End());
+  }
+
+}
+
+int main(int argc, char** argv)
+{
+  const size_t n_segs  = (argc > 1) ? std::atol(argv[1]) : 100000;
+  const size_t n_boxes = (argc > 2) ? std::atol(argv[2]) : 1000;
+
+  std::mt19937 gen(20210101);
+  std::uniform_real_distribution<double> pos(-500., 500.);
+  std::uniform_real_distribution<double> half(1., 200.);
+
+  geoalgo::GeoAlgo algo;
+  const geoalgo::AABox box(-200., -200., -500., 200., 200., 500.);
+
+  std::vector<geoalgo::LineSegment> segs;
+  segs.reserve(n_segs);
+  for(size_t i=0; i<n_segs; ++i)
+    segs.emplace_back(pos(gen), pos(gen), pos(gen), pos(gen), pos(gen), pos(gen));
+
+  std::vector<geoalgo::AABox> boxes;
+  boxes.reserve(n_boxes);
+  for(size_t i=0; i<n_boxes; ++i) {
+    double cx = pos(gen), cy = pos(gen), cz = pos(gen);
+    double hx = half(gen), hy = half(gen), hz = half(gen);
+    boxes.emplace_back(cx-hx, cy-hy, cz-hz, cx+hx, cy+hy, cz+hz);
+  }
+
+  //
+  // many segments vs one box
+  //
+  auto start = Clock::now();
+  size_t n_ref = 0;
+  for(auto const& seg : segs) n_ref += overlaps(algo, box, seg);
+  double t_ref = elapsed_ns(start);
+
+  const geoalgo::LineSegmentSoA seg_soa(segs);
+  std::vector<double> t_in, t_out;
+  start = Clock::now();
+  algo.BoxClip(box, seg_soa, t_in, t_out);
+  double t_batch = elapsed_ns(start);
+  size_t n_batch = 0;
+  for(size_t i=0; i<n_segs; ++i) n_batch += (t_in[i] <= t_out[i]);
+
+  std::cout << "segments vs box:   " << n_segs << " segments\n"
+            << "  per-object Intersection: " << t_ref / n_segs << " ns/segment, "
+            << n_ref << " overlapping\n"
+            << "  batch BoxClip:           " << t_batch / n_segs << " ns/segment, "
+            << n_batch << " overlapping\n"
+            << "  speed-up:                " << t_ref / t_batch << std::endl;
+
+  //
+  // one segment vs many boxes
+  //
+  const geoalgo::AABoxSoA box_soa(boxes);
+  const size_t n_probe = std::min<size_t>(n_segs, 100);
+  n_ref = n_batch = 0;
+  t_ref = t_batch = 0.;
+  for(size_t s=0; s<n_probe; ++s) {
+    start = Clock::now();
+    for(auto const& b : boxes) n_ref += overlaps(algo, b, segs[s]);
+    t_ref += elapsed_ns(start);
+
+    start = Clock::now();
+    algo.BoxClip(box_soa, segs[s], t_in, t_out);
+    t_batch += elapsed_ns(start);
+    for(size_t i=0; i<n_boxes; ++i) n_batch += (t_in[i] <= t_out[i]);
+  }
+
+  std::cout << "segment vs boxes:  " << n_probe << " x " << n_boxes << " pairs\n"
+            << "  per-object Intersection: " << t_ref / (n_probe*n_boxes) << " ns/pair, "
+            << n_ref << " overlapping\n"
+            << "  batch BoxClip:           " << t_batch / (n_probe*n_boxes) << " ns/pair, "
+            << n_batch << " overlapping\n"
+            << "  speed-up:                " << t_ref / t_batch << std::endl;
+
+  return 0;
+}
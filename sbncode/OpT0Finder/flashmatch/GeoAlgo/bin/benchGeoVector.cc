@@ -0,0 +1,98 @@
+//
+// Micro-benchmark of the fixed-size Vector3 against the heap allocated
+// Vector for the operations that dominate the trajectory code: Dist, Dot,
+// Cross and SqDist, plus the point stepping done in LightPath.
+//
+// Usage: benchGeoVector [n_points] [n_repeat]
+//
+
+#include "sbncode/OpT0Finder/flashmatch/GeoAlgo/GeoVector.h"
+#include "sbncode/OpT0Finder/flashmatch/GeoAlgo/GeoVector3.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+  using Clock = std::chrono::steady_clock;
+
+  double elapsed_ns(const Clock::time_point& start)
+  { return std::chrono::duration<double, std::nano>(Clock::now() - start).count(); }
+
+  // runs op over all the consecutive pairs n_repeat times, returns ns/call
+  template <class V, class Op>
+  double bench(const std::vector<V>& pts, size_t n_repeat, Op op, double& sum)
+  {
+    auto start = Clock::now();
+    for(size_t r=0; r<n_repeat; ++r)
+      for(size_t i=0; i+1<pts.size(); ++i) sum += op(pts[i], pts[i+1]);
+    return elapsed_ns(start) / (n_repeat * (pts.size() - 1));
+  }
+
+  void report(const std::string& name, double t_vec, double t_vec3, double s_vec, double s_vec3)
+  {
+    std::cout << "  " << name << ": Vector " << t_vec << " ns, Vector3 " << t_vec3
+	      << " ns, speed-up " << t_vec / t_vec3
+	      << (s_vec == s_vec3 ? "" : "  (results differ!)") << std::endl;
+  }
+
+}
+
+int main(int argc, char** argv)
+{
+  const size_t n_pts    = (argc > 1) ? std::atol(argv[1]) : 10000;
+  const size_t n_repeat = (argc > 2) ? std::atol(argv[2]) : 100;
+
+  std::mt19937 gen(20210101);
+  std::uniform_real_distribution<double> pos(-500., 500.);
+
+  std::vector<geoalgo::Vector>  vecs;
+  std::vector<geoalgo::Vector3> vec3s;
+  vecs.reserve(n_pts);
+  vec3s.reserve(n_pts);
+  for(size_t i=0; i<n_pts; ++i) {
+    double x = pos(gen), y = pos(gen), z = pos(gen);
+    vecs.emplace_back(x, y, z);
+    vec3s.emplace_back(x, y, z);
+  }
+
+  std::cout << n_pts << " points x " << n_repeat << " repetitions, time per call" << std::endl;
+
+  double s_vec = 0., s_vec3 = 0.;
+  double t_vec, t_vec3;
+
+  t_vec  = bench(vecs,  n_repeat, [](auto const& a, auto const& b) { return a.Dist(b); }, s_vec);
+  t_vec3 = bench(vec3s, n_repeat, [](auto const& a, auto const& b) { return a.Dist(b); }, s_vec3);
+  report("Dist  ", t_vec, t_vec3, s_vec, s_vec3);
+
+  s_vec = s_vec3 = 0.;
+  t_vec  = bench(vecs,  n_repeat, [](auto const& a, auto const& b) { return a.SqDist(b); }, s_vec);
+  t_vec3 = bench(vec3s, n_repeat, [](auto const& a, auto const& b) { return a.SqDist(b); }, s_vec3);
+  report("SqDist", t_vec, t_vec3, s_vec, s_vec3);
+
+  s_vec = s_vec3 = 0.;
+  t_vec  = bench(vecs,  n_repeat, [](auto const& a, auto const& b) { return a.Dot(b); }, s_vec);
+  t_vec3 = bench(vec3s, n_repeat, [](auto const& a, auto const& b) { return a.Dot(b); }, s_vec3);
+  report("Dot   ", t_vec, t_vec3, s_vec, s_vec3);
+
+  s_vec = s_vec3 = 0.;
+  t_vec  = bench(vecs,  n_repeat, [](auto const& a, auto const& b) { return a.Cross(b)[2]; }, s_vec);
+  t_vec3 = bench(vec3s, n_repeat, [](auto const& a, auto const& b) { return a.Cross(b)[2]; }, s_vec3);
+  report("Cross ", t_vec, t_vec3, s_vec, s_vec3);
+
+  // LightPath::MakeQCluster style stepping along a segment
+  s_vec = s_vec3 = 0.;
+  auto step = [](auto const& a, auto const& b) {
+    auto const dir = (a - b).Dir();
+    return (b + dir * 0.25)[0];
+  };
+  t_vec  = bench(vecs,  n_repeat, step, s_vec);
+  t_vec3 = bench(vec3s, n_repeat, step, s_vec3);
+  report("Step  ", t_vec, t_vec3, s_vec, s_vec3);
+
+  return 0;
+}